@@ -0,0 +1,133 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "mesh.h"
+#include <atomic>
+
+// Componentes conexas de la malla soldada con union-find concurrente
+// (enlace por CAS del representante mayor al menor, compresión por halving)
+// y eliminación de islas chicas: fragmentos que deja el descarte por muestreo
+// o campos como el Mandelbulb.
+
+class ComponentOptions {
+public:
+    size_t min_triangles = 0;  // se eliminan componentes con menos triángulos
+    double min_area = 0;       // o con menos área
+};
+
+class ComponentStats {
+public:
+    size_t components = 0;
+    size_t removed_components = 0;
+    size_t removed_triangles = 0;
+    vector<size_t> triangle_counts;  // por componente, de mayor a menor
+    vector<double> areas;            // en el mismo orden
+};
+
+inline int union_find_root(vector<atomic<int>>& parent, int x) {
+    while (true) {
+        int p = parent[x].load(memory_order_relaxed);
+        if (p == x) return x;
+        int gp = parent[p].load(memory_order_relaxed);
+        if (gp != p) parent[x].compare_exchange_weak(p, gp, memory_order_relaxed);
+        x = gp;
+    }
+}
+
+inline void union_find_link(vector<atomic<int>>& parent, int a, int b) {
+    while (true) {
+        a = union_find_root(parent, a);
+        b = union_find_root(parent, b);
+        if (a == b) return;
+        if (a < b) swap(a, b);
+        int expected = a;
+        if (parent[a].compare_exchange_strong(expected, b, memory_order_relaxed)) return;
+    }
+}
+
+// Etiqueta de componente por triángulo (0..componentes-1, por vértice mínimo)
+inline vector<int> label_components(const IndexedMesh& mesh, size_t& component_count) {
+    size_t nv = mesh.vertices.size(), nf = mesh.triangle_count();
+    vector<atomic<int>> parent(nv);
+    #pragma omp parallel for schedule(static)
+    for (long v = 0; v < (long)nv; v++) parent[v].store((int)v, memory_order_relaxed);
+
+    #pragma omp parallel for schedule(static)
+    for (long f = 0; f < (long)nf; f++) {
+        union_find_link(parent, mesh.indices[3 * f], mesh.indices[3 * f + 1]);
+        union_find_link(parent, mesh.indices[3 * f], mesh.indices[3 * f + 2]);
+    }
+
+    vector<int> root(nv);
+    #pragma omp parallel for schedule(static)
+    for (long v = 0; v < (long)nv; v++) root[v] = union_find_root(parent, (int)v);
+
+    // Los representantes son los índices mínimos: numerarlos en orden es determinista
+    vector<int> component_of_root(nv, -1);
+    int count = 0;
+    for (size_t v = 0; v < nv; v++) {
+        if (root[v] == (int)v) component_of_root[v] = count++;
+    }
+    component_count = count;
+
+    vector<int> labels(nf);
+    #pragma omp parallel for schedule(static)
+    for (long f = 0; f < (long)nf; f++) labels[f] = component_of_root[root[mesh.indices[3 * f]]];
+    return labels;
+}
+
+// Cuenta triángulos y área por componente y, si hay umbrales, elimina las
+// componentes que no los alcanzan.
+inline ComponentStats filter_components(IndexedMesh& mesh, const ComponentOptions& options) {
+    ComponentStats stats;
+    size_t count = 0;
+    vector<int> labels = label_components(mesh, count);
+    stats.components = count;
+
+    vector<size_t> triangles(count, 0);
+    vector<double> area(count, 0);
+    #pragma omp parallel
+    {
+        vector<size_t> local_triangles(count, 0);
+        vector<double> local_area(count, 0);
+        #pragma omp for schedule(static) nowait
+        for (long f = 0; f < (long)labels.size(); f++) {
+            Point3D n = face_normal(mesh.vertices[mesh.indices[3 * f]], mesh.vertices[mesh.indices[3 * f + 1]], mesh.vertices[mesh.indices[3 * f + 2]]);
+            local_triangles[labels[f]]++;
+            local_area[labels[f]] += 0.5 * sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+        }
+        #pragma omp critical
+        for (size_t c = 0; c < count; c++) {
+            triangles[c] += local_triangles[c];
+            area[c] += local_area[c];
+        }
+    }
+
+    vector<char> keep(count, 1);
+    for (size_t c = 0; c < count; c++) {
+        if (triangles[c] < options.min_triangles || area[c] < options.min_area) {
+            keep[c] = 0;
+            stats.removed_components++;
+            stats.removed_triangles += triangles[c];
+        }
+    }
+
+    vector<size_t> order(count);
+    for (size_t c = 0; c < count; c++) order[c] = c;
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) { return triangles[a] > triangles[b]; });
+    for (size_t c : order) {
+        stats.triangle_counts.push_back(triangles[c]);
+        stats.areas.push_back(area[c]);
+    }
+
+    if (stats.removed_components > 0) {
+        #pragma omp parallel for schedule(static)
+        for (long f = 0; f < (long)labels.size(); f++) {
+            if (!keep[labels[f]]) mesh.indices[3 * f] = -1;
+        }
+        compact_mesh(mesh);
+    }
+    return stats;
+}
+
+#endif // COMPONENTS_H
@@ -0,0 +1,123 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include "scaling.h"
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+
+// Corpus de referencia: cada superficie incluida con una precisión y un motor
+// fijos, la cantidad de triángulos y un hash de la malla esperados. Sirve para
+// comparar el rendimiento entre cargas distintas y detectar cambios de
+// resultado. El muestreo del descarte usa una semilla por nodo (node_seed),
+// así que la malla no depende de los hilos ni de la corrida. El hash sí
+// depende de la biblioteca matemática (sin, pow, atan2): en otra plataforma
+// pueden cambiar los hashes y no los triángulos.
+
+class CorpusEntry {
+public:
+    const char* surface;
+    Engine engine;
+    double precision;
+    size_t triangles;  // esperados
+    uint64_t hash;     // mesh_hash esperado
+};
+
+inline const vector<CorpusEntry>& corpus_entries() {
+    static const vector<CorpusEntry> entries = {
+        {"sphere", Engine::MarchingCubes, 0.2, 6595, 0xb7301c33923aac7cull},
+        {"torus", Engine::MarchingCubes, 0.2, 5269, 0xca3b40f6d4733d7cull},
+        {"gyroid", Engine::MarchingCubes, 0.2, 9751, 0x65f347ff953e7d93ull},
+        {"barth", Engine::MarchingCubes, 0.4, 13555, 0xb38d06994357a7ebull},
+        {"mandelbulb", Engine::MarchingCubes, 0.1, 5660, 0x4926cb2af32b1e11ull},
+        {"terrain", Engine::MarchingCubes, 0.3, 4812, 0x2d8f772dd7996d90ull},
+        {"csg", Engine::MarchingCubes, 0.25, 16406, 0x62669830825df40dull},
+        {"sphere", Engine::DualContouring, 0.2, 6636, 0x29936b7af2a3ac5bull},
+        {"csg", Engine::DualContouring, 0.25, 16628, 0x88525b7b884b5f92ull},
+    };
+    return entries;
+}
+
+// Hash de la malla que no depende del orden de los triángulos ni del vértice
+// con que empieza cada uno (se conserva la orientación). Las coordenadas se
+// cuantizan a quantum para que el representante que elige el soldado no cambie
+// el resultado. FNV-1a de 64 bits sobre los triángulos ordenados.
+inline uint64_t mesh_hash(const IndexedMesh& mesh, double quantum) {
+    typedef array<int64_t, 9> Key;
+    vector<Key> keys(mesh.triangle_count());
+    for (size_t t = 0; t < keys.size(); t++) {
+        int64_t q[3][3];
+        for (int c = 0; c < 3; c++) {
+            const Point3D& p = mesh.vertices[mesh.indices[3 * t + c]];
+            q[c][0] = llround(p.x / quantum);
+            q[c][1] = llround(p.y / quantum);
+            q[c][2] = llround(p.z / quantum);
+        }
+        int first = 0;
+        for (int c = 1; c < 3; c++) {
+            if (lexicographical_compare(q[c], q[c] + 3, q[first], q[first] + 3)) first = c;
+        }
+        for (int c = 0; c < 3; c++) {
+            for (int a = 0; a < 3; a++) keys[t][3 * c + a] = q[(first + c) % 3][a];
+        }
+    }
+    sort(keys.begin(), keys.end());
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (const Key& key : keys) {
+        for (int64_t v : key) {
+            for (int b = 0; b < 8; b++) {
+                h ^= (uint64_t)(v >> (8 * b)) & 0xff;
+                h *= 0x100000001b3ull;
+            }
+        }
+    }
+    return h;
+}
+
+class CorpusResult {
+public:
+    CorpusEntry entry;
+    int grid = 0;
+    size_t triangles = 0;
+    uint64_t hash = 0;
+    bool stable = true;  // la misma malla en todas las repeticiones
+    PhaseSamples time;   // segundos de extracción por repetición
+
+    bool matches() const { return stable && triangles == entry.triangles && hash == entry.hash; }
+};
+
+// Extrae cada entrada con el motor y la precisión de referencia; el tiempo es
+// el de la extracción (recorrido y soldado), sin escritura.
+inline vector<CorpusResult> run_corpus(int warmup, int repetitions, const function<void(const CorpusResult&)>& report = nullptr) {
+    vector<CorpusResult> results;
+    for (const auto& entry : corpus_entries()) {
+        const BuiltinSurface& surface = *find_surface(entry.surface);
+        Extractor extractor(surface.field);
+        extractor.config.start = surface.start;
+        extractor.config.end = surface.end;
+        extractor.config.engine = entry.engine;
+        extractor.config.precision = entry.precision;
+
+        CorpusResult result;
+        result.entry = entry;
+        result.grid = CellGrid(surface.start, surface.end, entry.precision).n;
+        result.time.phase = "extract";
+        for (int r = 0; r < warmup + repetitions; r++) {
+            double t0 = omp_get_wtime();
+            vector<IndexedMesh> meshes = extractor.extract_meshes();
+            if (r < warmup) continue;
+            result.time.seconds.push_back(omp_get_wtime() - t0);
+            size_t triangles = meshes[0].triangle_count();
+            uint64_t hash = mesh_hash(meshes[0], entry.precision * 1e-6);
+            if (r > warmup && (triangles != result.triangles || hash != result.hash)) result.stable = false;
+            result.triangles = triangles;
+            result.hash = hash;
+        }
+        result.time.summarize();
+        results.push_back(result);
+        if (report) report(results.back());
+    }
+    return results;
+}
+
+#endif // CORPUS_H
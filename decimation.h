@@ -0,0 +1,398 @@
+#ifndef DECIMATION_H
+#define DECIMATION_H
+
+#include "mesh.h"
+#include <queue>
+
+// Decimación por error cuadrático (Garland-Heckbert) en paralelo.
+// La malla se parte en bloques espaciales; cada hilo colapsa aristas dentro
+// de su bloque y los vértices cuyo anillo toca otro bloque quedan bloqueados.
+// Entre fases la partición se desplaza medio bloque para liberar los bordes.
+// La grilla de bloques se arma en cada fase según los vértices que quedan:
+// al engrosarse la malla los anillos crecen y con bloques chicos todo quedaría
+// bloqueado. Si aun así dos fases seguidas no colapsan nada antes del
+// objetivo, una última pasada usa un solo bloque sin bordes.
+
+class DecimationOptions {
+public:
+    size_t target_triangles = 0;  // 0: sin objetivo, sólo el límite de error
+    double max_error = 1e30;      // error cuadrático máximo aceptado por colapso
+    int max_phases = 16;
+    int blocks_per_axis = 0;      // 0: según la cantidad de hilos y los vértices que quedan
+    size_t min_block_vertices = 256;  // con blocks_per_axis = 0, vértices por bloque como mínimo
+};
+
+class DecimationStats {
+public:
+    size_t initial_triangles = 0;
+    size_t final_triangles = 0;
+    size_t collapses = 0;
+    int phases = 0;
+    bool target_reached = true;  // false si el error máximo o la topología cortaron antes de target_triangles
+};
+
+class Quadric {
+public:
+    // xx xy xz xw yy yz yw zz zw ww
+    double q[10];
+
+    Quadric() { for (int i = 0; i < 10; i++) q[i] = 0; }
+
+    static Quadric plane(double a, double b, double c, double d, double weight) {
+        Quadric k;
+        k.q[0] = weight * a * a; k.q[1] = weight * a * b; k.q[2] = weight * a * c; k.q[3] = weight * a * d;
+        k.q[4] = weight * b * b; k.q[5] = weight * b * c; k.q[6] = weight * b * d;
+        k.q[7] = weight * c * c; k.q[8] = weight * c * d;
+        k.q[9] = weight * d * d;
+        return k;
+    }
+
+    void add(const Quadric& o) { for (int i = 0; i < 10; i++) q[i] += o.q[i]; }
+
+    double error(const Point3D& p) const {
+        return q[0] * p.x * p.x + 2 * q[1] * p.x * p.y + 2 * q[2] * p.x * p.z + 2 * q[3] * p.x
+             + q[4] * p.y * p.y + 2 * q[5] * p.y * p.z + 2 * q[6] * p.y
+             + q[7] * p.z * p.z + 2 * q[8] * p.z + q[9];
+    }
+
+    // Punto de error mínimo; false si el sistema está mal condicionado
+    bool minimizer(Point3D& p) const {
+        double a = q[0], b = q[1], c = q[2], d = q[4], e = q[5], f = q[7];
+        double det = a * (d * f - e * e) - b * (b * f - e * c) + c * (b * e - d * c);
+        double scale = a + d + f;
+        if (abs(det) < 1e-12 * scale * scale * scale || scale == 0) return false;
+        double rx = -q[3], ry = -q[6], rz = -q[8];
+        p.x = (rx * (d * f - e * e) - b * (ry * f - e * rz) + c * (ry * e - d * rz)) / det;
+        p.y = (a * (ry * f - e * rz) - rx * (b * f - e * c) + c * (b * rz - ry * c)) / det;
+        p.z = (a * (d * rz - ry * e) - b * (b * rz - ry * c) + rx * (b * e - d * c)) / det;
+        return true;
+    }
+};
+
+class Decimator {
+public:
+    IndexedMesh& mesh;
+    const DecimationOptions& options;
+    vector<vector<int>> vertex_faces;
+    vector<Quadric> quadrics;
+    vector<char> boundary;   // vértices en borde o aristas no manifold: nunca se mueven
+    vector<int> version;     // invalida entradas viejas de las colas
+    vector<int> block_of;
+    vector<char> locked;
+
+    Decimator(IndexedMesh& mesh, const DecimationOptions& options) : mesh(mesh), options(options) {}
+
+    bool face_alive(int f) const { return mesh.indices[3 * f] >= 0; }
+
+    void neighbors(int u, vector<int>& out) const {
+        out.clear();
+        for (int f : vertex_faces[u]) {
+            for (int c = 0; c < 3; c++) {
+                int w = mesh.indices[3 * f + c];
+                if (w != u && find(out.begin(), out.end(), w) == out.end()) out.push_back(w);
+            }
+        }
+    }
+
+    void build() {
+        size_t nv = mesh.vertices.size(), nf = mesh.triangle_count();
+        vertex_faces.assign(nv, vector<int>());
+        for (size_t f = 0; f < nf; f++) {
+            for (int c = 0; c < 3; c++) vertex_faces[mesh.indices[3 * f + c]].push_back((int)f);
+        }
+
+        quadrics.assign(nv, Quadric());
+        boundary.assign(nv, 0);
+        version.assign(nv, 0);
+
+        // Cada vértice suma sus propias caras: sin escrituras compartidas
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (long u = 0; u < (long)nv; u++) {
+            vector<pair<int, int>> edge_count;
+            for (int f : vertex_faces[u]) {
+                const Point3D& a = mesh.vertices[mesh.indices[3 * f]];
+                const Point3D& b = mesh.vertices[mesh.indices[3 * f + 1]];
+                const Point3D& c = mesh.vertices[mesh.indices[3 * f + 2]];
+                Point3D n = face_normal(a, b, c);
+                double len = sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+                if (len > 0) {
+                    double nx = n.x / len, ny = n.y / len, nz = n.z / len;
+                    quadrics[u].add(Quadric::plane(nx, ny, nz, -(nx * a.x + ny * a.y + nz * a.z), len / 2));
+                }
+                for (int k = 0; k < 3; k++) {
+                    int w = mesh.indices[3 * f + k];
+                    if (w == u) continue;
+                    auto it = find_if(edge_count.begin(), edge_count.end(), [w](const pair<int, int>& e) { return e.first == w; });
+                    if (it == edge_count.end()) edge_count.push_back({w, 1});
+                    else it->second++;
+                }
+            }
+            for (const auto& e : edge_count) {
+                if (e.second != 2) boundary[u] = 1;
+            }
+        }
+    }
+
+    // Costo y posición del colapso de la arista (u, v)
+    double collapse_cost(int u, int v, Point3D& position) const {
+        Quadric q = quadrics[u];
+        q.add(quadrics[v]);
+        const Point3D& a = mesh.vertices[u];
+        const Point3D& b = mesh.vertices[v];
+        Point3D mid((a.x + b.x) / 2, (a.y + b.y) / 2, (a.z + b.z) / 2);
+
+        Point3D best = mid;
+        double best_error = q.error(mid);
+        if (q.error(a) < best_error) { best = a; best_error = q.error(a); }
+        if (q.error(b) < best_error) { best = b; best_error = q.error(b); }
+
+        // El óptimo sólo se acepta cerca de la arista
+        Point3D opt;
+        double radius2 = (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z);
+        if (q.minimizer(opt)) {
+            double d2 = (opt.x - mid.x) * (opt.x - mid.x) + (opt.y - mid.y) * (opt.y - mid.y) + (opt.z - mid.z) * (opt.z - mid.z);
+            if (d2 <= radius2 && q.error(opt) < best_error) { best = opt; best_error = q.error(opt); }
+        }
+        position = best;
+        return max(0.0, best_error);
+    }
+
+    // Condición de enlace (sólo dos vecinos comunes) y que ninguna cara se invierta
+    bool collapse_valid(int u, int v, const Point3D& position, vector<int>& nu, vector<int>& nv) const {
+        neighbors(u, nu);
+        neighbors(v, nv);
+        int common = 0;
+        for (int w : nu) if (find(nv.begin(), nv.end(), w) != nv.end()) common++;
+        if (common != 2) return false;
+
+        for (int side = 0; side < 2; side++) {
+            int moved = side ? v : u, other = side ? u : v;
+            for (int f : vertex_faces[moved]) {
+                int i0 = mesh.indices[3 * f], i1 = mesh.indices[3 * f + 1], i2 = mesh.indices[3 * f + 2];
+                if (i0 == other || i1 == other || i2 == other) continue;
+                Point3D before = face_normal(mesh.vertices[i0], mesh.vertices[i1], mesh.vertices[i2]);
+                Point3D p0 = (i0 == moved) ? position : mesh.vertices[i0];
+                Point3D p1 = (i1 == moved) ? position : mesh.vertices[i1];
+                Point3D p2 = (i2 == moved) ? position : mesh.vertices[i2];
+                Point3D after = face_normal(p0, p1, p2);
+                double dot = before.x * after.x + before.y * after.y + before.z * after.z;
+                double la = after.x * after.x + after.y * after.y + after.z * after.z;
+                double lb = before.x * before.x + before.y * before.y + before.z * before.z;
+                if (dot <= 0 || la < 1e-6 * lb) return false;
+            }
+        }
+        return true;
+    }
+
+    void collapse(int u, int v, const Point3D& position) {
+        for (int f : vertex_faces[u]) {
+            int* tri = &mesh.indices[3 * f];
+            if (tri[0] == v || tri[1] == v || tri[2] == v) {
+                for (int c = 0; c < 3; c++) {
+                    int w = tri[c];
+                    if (w == u) continue;
+                    auto& list = vertex_faces[w];
+                    list.erase(remove(list.begin(), list.end(), f), list.end());
+                }
+                tri[0] = tri[1] = tri[2] = -1;
+            } else {
+                for (int c = 0; c < 3; c++) if (tri[c] == u) tri[c] = v;
+                vertex_faces[v].push_back(f);
+            }
+        }
+        vertex_faces[u].clear();
+        if (mesh.has_attributes()) {
+            // Atributos según la proyección de la nueva posición sobre la arista
+            const Point3D& a = mesh.vertices[u];
+            const Point3D& b = mesh.vertices[v];
+            double length2 = squared_distance(a, b);
+            double s = length2 > 0 ? ((position.x - a.x) * (b.x - a.x) + (position.y - a.y) * (b.y - a.y) + (position.z - a.z) * (b.z - a.z)) / length2 : 1;
+            s = min(1.0, max(0.0, s));
+            size_t count = mesh.attribute_count();
+            for (size_t k = 0; k < count; k++) {
+                float& value = mesh.attributes[v * count + k];
+                value = (float)(mesh.attributes[u * count + k] + s * (value - mesh.attributes[u * count + k]));
+            }
+        }
+        mesh.vertices[v] = position;
+        quadrics[v].add(quadrics[u]);
+        version[u]++;
+        version[v]++;
+    }
+
+    class Candidate {
+    public:
+        double cost;
+        int u, v, version_u, version_v;
+        Point3D position;
+        bool operator>(const Candidate& o) const { return cost > o.cost; }
+    };
+
+    bool movable(int u, int block) const {
+        return !boundary[u] && !locked[u] && block_of[u] == block && !vertex_faces[u].empty();
+    }
+
+    void push_edges(int u, int block, priority_queue<Candidate, vector<Candidate>, greater<Candidate>>& heap, vector<int>& scratch) {
+        neighbors(u, scratch);
+        for (int w : scratch) {
+            if (!movable(w, block)) continue;
+            Candidate c;
+            c.u = u; c.v = w;
+            c.cost = collapse_cost(u, w, c.position);
+            c.version_u = version[u]; c.version_v = version[w];
+            heap.push(c);
+        }
+    }
+
+    // Colapsa dentro de un bloque hasta agotar la cuota o superar el error
+    size_t process_block(const vector<int>& block_vertices, int block, size_t quota) {
+        priority_queue<Candidate, vector<Candidate>, greater<Candidate>> heap;
+        vector<int> scratch, nu, nv;
+        for (int u : block_vertices) {
+            neighbors(u, scratch);
+            for (int w : scratch) {
+                if (w < u || !movable(w, block)) continue;
+                Candidate c;
+                c.u = u; c.v = w;
+                c.cost = collapse_cost(u, w, c.position);
+                c.version_u = version[u]; c.version_v = version[w];
+                heap.push(c);
+            }
+        }
+
+        size_t done = 0;
+        while (!heap.empty() && done < quota) {
+            Candidate c = heap.top();
+            heap.pop();
+            if (c.version_u != version[c.u] || c.version_v != version[c.v]) continue;
+            if (c.cost > options.max_error) break;
+            if (!collapse_valid(c.u, c.v, c.position, nu, nv)) continue;
+            collapse(c.u, c.v, c.position);
+            done++;
+            push_edges(c.v, block, heap, scratch);
+        }
+        return done;
+    }
+
+    size_t live_triangles() const {
+        size_t live = 0;
+        #pragma omp parallel for reduction(+:live)
+        for (long f = 0; f < (long)mesh.triangle_count(); f++) live += face_alive((int)f) ? 1 : 0;
+        return live;
+    }
+
+    // Bloques por eje para esta fase: los que pide el hilo, sin bajar de
+    // min_block_vertices vértices vivos por bloque
+    int phase_blocks_per_axis() const {
+        if (options.blocks_per_axis > 0) return options.blocks_per_axis;
+        size_t live_vertices = 0;
+        #pragma omp parallel for reduction(+:live_vertices)
+        for (long u = 0; u < (long)mesh.vertices.size(); u++) live_vertices += vertex_faces[u].empty() ? 0 : 1;
+        int by_threads = max(2, (int)ceil(cbrt(8.0 * omp_get_max_threads())));
+        int by_size = (int)floor(cbrt((double)live_vertices / max<size_t>(1, options.min_block_vertices)));
+        return max(1, min(by_threads, by_size));
+    }
+
+    // Una fase: reparte los vértices en per_axis^3 bloques (desplazados medio
+    // bloque si shift), bloquea los bordes y colapsa en paralelo por bloque
+    size_t run_phase(const Point3D& lo, const Point3D& hi, int per_axis, bool shift, size_t live) {
+        double size_x = max(1e-12, (hi.x - lo.x) / per_axis);
+        double size_y = max(1e-12, (hi.y - lo.y) / per_axis);
+        double size_z = max(1e-12, (hi.z - lo.z) / per_axis);
+        double offset = shift ? 0.5 : 0.0;
+        int cells = shift ? per_axis + 1 : per_axis;  // con desplazamiento hay un bloque más por eje
+        size_t nv = mesh.vertices.size();
+
+        #pragma omp parallel for schedule(static)
+        for (long u = 0; u < (long)nv; u++) {
+            const Point3D& p = mesh.vertices[u];
+            int bx = min(cells - 1, (int)((p.x - lo.x) / size_x + offset));
+            int by = min(cells - 1, (int)((p.y - lo.y) / size_y + offset));
+            int bz = min(cells - 1, (int)((p.z - lo.z) / size_z + offset));
+            block_of[u] = (bx * cells + by) * cells + bz;
+        }
+
+        // Bloqueo de bordes: el anillo completo debe caer en el mismo bloque
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (long u = 0; u < (long)nv; u++) {
+            char is_locked = 0;
+            for (int f : vertex_faces[u]) {
+                for (int c = 0; c < 3 && !is_locked; c++) {
+                    if (block_of[mesh.indices[3 * f + c]] != block_of[u]) is_locked = 1;
+                }
+            }
+            locked[u] = is_locked;
+        }
+
+        vector<vector<int>> blocks(cells * cells * cells);
+        for (size_t u = 0; u < nv; u++) {
+            if (!boundary[u] && !locked[u] && !vertex_faces[u].empty()) blocks[block_of[u]].push_back((int)u);
+        }
+
+        // Cuota por bloque proporcional a sus caras
+        double ratio = options.target_triangles > 0 ? double(live - options.target_triangles) / live : 1.0;
+        size_t phase_collapses = 0;
+        #pragma omp parallel for schedule(dynamic, 1) reduction(+:phase_collapses)
+        for (long b = 0; b < (long)blocks.size(); b++) {
+            if (blocks[b].empty()) continue;
+            size_t faces = 0;
+            for (int u : blocks[b]) faces += vertex_faces[u].size();
+            faces /= 3;
+            size_t quota = options.target_triangles > 0 ? (size_t)ceil(ratio * faces / 2) : (size_t)-1;
+            phase_collapses += process_block(blocks[b], (int)b, quota);
+        }
+        return phase_collapses;
+    }
+
+    DecimationStats run() {
+        DecimationStats stats;
+        stats.initial_triangles = mesh.triangle_count();
+        if (mesh.vertices.empty()) return stats;
+        build();
+
+        Point3D lo = mesh.vertices[0], hi = mesh.vertices[0];
+        for (const auto& p : mesh.vertices) {
+            lo.x = min(lo.x, p.x); lo.y = min(lo.y, p.y); lo.z = min(lo.z, p.z);
+            hi.x = max(hi.x, p.x); hi.y = max(hi.y, p.y); hi.z = max(hi.z, p.z);
+        }
+
+        size_t live = stats.initial_triangles;
+        size_t nv = mesh.vertices.size();
+        block_of.assign(nv, 0);
+        locked.assign(nv, 0);
+
+        int idle_phases = 0;
+        bool single_block = false;  // la última fase fue un solo bloque sin bordes
+        for (int phase = 0; phase < options.max_phases && live > options.target_triangles; phase++) {
+            int per_axis = phase_blocks_per_axis();
+            single_block = per_axis == 1;
+            size_t phase_collapses = run_phase(lo, hi, per_axis, !single_block && phase % 2, live);
+            stats.phases++;
+            stats.collapses += phase_collapses;
+            live = live_triangles();
+            // Sin colapsos con las dos particiones: no queda nada bajo el error
+            // lejos de los bordes de bloque
+            idle_phases = phase_collapses == 0 ? idle_phases + 1 : 0;
+            if (idle_phases >= 2 || (single_block && phase_collapses == 0)) break;
+        }
+
+        // Lo que quedó bloqueado en los bordes de bloque: una pasada con la malla entera
+        if (options.target_triangles > 0 && live > options.target_triangles && !single_block) {
+            stats.phases++;
+            stats.collapses += run_phase(lo, hi, 1, false, live);
+            live = live_triangles();
+        }
+
+        compact_mesh(mesh);
+        stats.final_triangles = mesh.triangle_count();
+        stats.target_reached = options.target_triangles == 0 || stats.final_triangles <= options.target_triangles;
+        return stats;
+    }
+};
+
+inline DecimationStats decimate_mesh(IndexedMesh& mesh, const DecimationOptions& options) {
+    Decimator decimator(mesh, options);
+    return decimator.run();
+}
+
+#endif // DECIMATION_H
@@ -0,0 +1,413 @@
+#ifndef DUAL_CONTOURING_H
+#define DUAL_CONTOURING_H
+
+#include "marching_cubes.h"
+#include "mesh.h"
+#include <cstdint>
+#include <unordered_map>
+
+// Motores duales (surface nets y dual contouring): un vértice por celda activa
+// y un quad por cada arista de la grilla que cruza la superficie.
+// Reutilizan la misma subdivisión y el mismo descarte (cube_contains_surface)
+// que surface_to_triangles, pero producen una malla indexada.
+
+enum class DualMethod { SurfaceNets, DualContouring };
+
+// Grilla uniforme de las hojas del octree. Las hojas de surface_to_triangles
+// están todas a la misma profundidad, así que cada una es una celda (i, j, k).
+class CellGrid {
+public:
+    Point3D origin;
+    double hx, hy, hz;
+    int n;  // celdas por eje (2^profundidad)
+
+    CellGrid(Point3D start, Point3D end, double precision) : origin(start) {
+        double ex = end.x - start.x, ey = end.y - start.y, ez = end.z - start.z;
+        n = 1;
+        // Misma condición de corte que surface_to_triangles
+        while (!(ex < precision || ey < precision || ez < precision)) {
+            ex /= 2; ey /= 2; ez /= 2;
+            n *= 2;
+        }
+        hx = ex; hy = ey; hz = ez;
+    }
+
+    Point3D corner(int i, int j, int k) const {
+        return Point3D(origin.x + i * hx, origin.y + j * hy, origin.z + k * hz);
+    }
+};
+
+inline uint64_t cell_key(int i, int j, int k) {
+    return (uint64_t(i) << 42) | (uint64_t(j) << 21) | uint64_t(k);
+}
+
+inline void cell_coords(uint64_t key, int& i, int& j, int& k) {
+    i = int((key >> 42) & 0x1FFFFF);
+    j = int((key >> 21) & 0x1FFFFF);
+    k = int(key & 0x1FFFFF);
+}
+
+// Claves de nodos, celdas y aristas de los recorridos (MemoryCategory::Octree)
+typedef tracked_vector<uint64_t, MemoryCategory::Octree> NodeKeys;
+typedef unordered_map<uint64_t, int, hash<uint64_t>, equal_to<uint64_t>,
+                      TrackedAllocator<pair<const uint64_t, int>, MemoryCategory::Octree>> NodeIndex;
+
+inline void collect_active_cells_rec(const ScalarField& f, Point3D start, Point3D end,
+                                     double precision, double isovalue, int i, int j, int k,
+                                     vector<NodeKeys>& per_thread, TraversalControl* control = nullptr,
+                                     TraversalCounters* counters = nullptr, int depth = 0) {
+    if (control && control->is_cancelled()) return;
+
+    if (end.x - start.x < precision || end.y - start.y < precision || end.z - start.z < precision) {
+        per_thread[omp_get_thread_num()].push_back(cell_key(i, j, k));
+        if (control) control->complete(depth);
+        if (counters) counters->leaf(depth, 0);
+        return;
+    }
+
+    if (!cube_contains_surface(f, start, end, isovalue)) {
+        if (control) control->complete(depth);
+        if (counters) counters->node(depth, false);
+        return;
+    }
+    if (counters) counters->node(depth, true);
+
+    double mid[3] = {(start.x + end.x) / 2, (start.y + end.y) / 2, (start.z + end.z) / 2};
+    double lo[3] = {start.x, start.y, start.z};
+    double hi[3] = {end.x, end.y, end.z};
+
+    // Mismo orden de octantes que surface_to_triangles
+    for (int octant = 0; octant < 8; octant++) {
+        int dx = octant & 1, dy = (octant >> 1) & 1, dz = (octant >> 2) & 1;
+        Point3D s(dx ? mid[0] : lo[0], dy ? mid[1] : lo[1], dz ? mid[2] : lo[2]);
+        Point3D e(dx ? hi[0] : mid[0], dy ? hi[1] : mid[1], dz ? hi[2] : mid[2]);
+
+        #pragma omp task firstprivate(s, e, dx, dy, dz) shared(per_thread)
+        collect_active_cells_rec(f, s, e, precision, isovalue, 2 * i + dx, 2 * j + dy, 2 * k + dz, per_thread, control, counters, depth + 1);
+    }
+}
+
+// Hojas del octree que sobreviven al descarte, como claves de celda ordenadas.
+inline NodeKeys collect_active_cells(const ScalarField& f, Point3D start, Point3D end, double precision,
+                                     double isovalue = 0, TraversalControl* control = nullptr,
+                                     TraversalCounters* counters = nullptr) {
+    vector<NodeKeys> per_thread(omp_get_max_threads());
+
+    #pragma omp parallel
+    {
+        #pragma omp single nowait
+        collect_active_cells_rec(f, start, end, precision, isovalue, 0, 0, 0, per_thread, control, counters);
+    }
+
+    NodeKeys cells;
+    for (auto& part : per_thread) {
+        cells.insert(cells.end(), part.begin(), part.end());
+    }
+    sort(cells.begin(), cells.end());
+    return cells;
+}
+
+// Esquinas y aristas con la misma numeración que marching_cubes
+const int cube_corner_offsets[8][3] = {
+    {0,0,0},{1,0,0},{1,1,0},{0,1,0},{0,0,1},{1,0,1},{1,1,1},{0,1,1}
+};
+const int cube_edge_corners[12][2] = {
+    {0,1},{1,2},{2,3},{3,0},{4,5},{5,6},{6,7},{7,4},{0,4},{1,5},{2,6},{3,7}
+};
+
+inline Point3D field_gradient(const ScalarField& f, Point3D p, double h) {
+    double gx = f(p.x + h, p.y, p.z) - f(p.x - h, p.y, p.z);
+    double gy = f(p.x, p.y + h, p.z) - f(p.x, p.y - h, p.z);
+    double gz = f(p.x, p.y, p.z + h) - f(p.x, p.y, p.z - h);
+    double len = sqrt(gx * gx + gy * gy + gz * gz);
+    if (len < 1e-12) return Point3D(0, 0, 0);
+    return Point3D(gx / len, gy / len, gz / len);
+}
+
+// Autovalores/autovectores de una matriz simétrica 3x3 (Jacobi)
+inline void symmetric_eigen3(double a[3][3], double eigenvalues[3], double v[3][3]) {
+    for (int r = 0; r < 3; r++)
+        for (int c = 0; c < 3; c++) v[r][c] = (r == c) ? 1.0 : 0.0;
+
+    for (int sweep = 0; sweep < 12; sweep++) {
+        double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        if (off < 1e-20) break;
+        for (int p = 0; p < 2; p++) {
+            for (int q = p + 1; q < 3; q++) {
+                if (abs(a[p][q]) < 1e-30) continue;
+                double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                double t = (theta >= 0 ? 1.0 : -1.0) / (abs(theta) + sqrt(theta * theta + 1));
+                double c = 1 / sqrt(t * t + 1), s = t * c;
+                for (int r = 0; r < 3; r++) {
+                    double arp = a[r][p], arq = a[r][q];
+                    a[r][p] = c * arp - s * arq;
+                    a[r][q] = s * arp + c * arq;
+                }
+                for (int r = 0; r < 3; r++) {
+                    double apr = a[p][r], aqr = a[q][r];
+                    a[p][r] = c * apr - s * aqr;
+                    a[q][r] = s * apr + c * aqr;
+                }
+                for (int r = 0; r < 3; r++) {
+                    double vrp = v[r][p], vrq = v[r][q];
+                    v[r][p] = c * vrp - s * vrq;
+                    v[r][q] = s * vrp + c * vrq;
+                }
+            }
+        }
+    }
+    for (int r = 0; r < 3; r++) eigenvalues[r] = a[r][r];
+}
+
+// Minimiza sum (n_i . (x - p_i))^2 alrededor del centro de masa con pseudo-inversa
+// truncada, para que las celdas planas no disparen el vértice fuera de la celda.
+inline Point3D solve_qef(const vector<Point3D>& points, const vector<Point3D>& normals, Point3D mass_point) {
+    double ata[3][3] = {{0,0,0},{0,0,0},{0,0,0}};
+    double atb[3] = {0, 0, 0};
+
+    for (size_t i = 0; i < points.size(); i++) {
+        const Point3D& n = normals[i];
+        double nv[3] = {n.x, n.y, n.z};
+        double d = n.x * (points[i].x - mass_point.x) + n.y * (points[i].y - mass_point.y) + n.z * (points[i].z - mass_point.z);
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++) ata[r][c] += nv[r] * nv[c];
+            atb[r] += nv[r] * d;
+        }
+    }
+
+    double eigenvalues[3], v[3][3];
+    symmetric_eigen3(ata, eigenvalues, v);
+    double max_eigen = max(eigenvalues[0], max(eigenvalues[1], eigenvalues[2]));
+
+    double dx[3] = {0, 0, 0};
+    for (int e = 0; e < 3; e++) {
+        if (eigenvalues[e] < 0.1 * max_eigen || eigenvalues[e] < 1e-12) continue;
+        double proj = v[0][e] * atb[0] + v[1][e] * atb[1] + v[2][e] * atb[2];
+        for (int r = 0; r < 3; r++) dx[r] += v[r][e] * proj / eigenvalues[e];
+    }
+    return Point3D(mass_point.x + dx[0], mass_point.y + dx[1], mass_point.z + dx[2]);
+}
+
+// Vértice dual de la celda (i, j, k); false si la celda no cruza la superficie.
+inline bool dual_cell_vertex(const ScalarField& f, const CellGrid& grid,
+                             int i, int j, int k, DualMethod method, double isovalue, Point3D& out) {
+    Point3D corners[8];
+    double values[8];
+    for (int c = 0; c < 8; c++) {
+        corners[c] = grid.corner(i + cube_corner_offsets[c][0], j + cube_corner_offsets[c][1], k + cube_corner_offsets[c][2]);
+    }
+    f.evaluate(corners, values, 8);
+
+    vector<Point3D> points;
+    for (int e = 0; e < 12; e++) {
+        int a = cube_edge_corners[e][0], b = cube_edge_corners[e][1];
+        if ((values[a] < isovalue) != (values[b] < isovalue)) {
+            points.push_back(interpolate_3d(corners[a], corners[b], values[a], values[b], 0, isovalue));
+        }
+    }
+    if (points.empty()) return false;
+
+    Point3D mass_point;
+    for (const auto& p : points) {
+        mass_point.x += p.x; mass_point.y += p.y; mass_point.z += p.z;
+    }
+    mass_point.x /= points.size(); mass_point.y /= points.size(); mass_point.z /= points.size();
+
+    if (method == DualMethod::SurfaceNets) {
+        out = mass_point;
+        return true;
+    }
+
+    double h = 1e-3 * min(grid.hx, min(grid.hy, grid.hz));
+    vector<Point3D> normals;
+    for (const auto& p : points) normals.push_back(field_gradient(f, p, h));
+
+    Point3D x = solve_qef(points, normals, mass_point);
+    // Si el QEF se sale de la celda nos quedamos con el centro de masa
+    Point3D lo = corners[0], hi = corners[6];
+    if (x.x < lo.x || x.y < lo.y || x.z < lo.z || x.x > hi.x || x.y > hi.y || x.z > hi.z) {
+        x = mass_point;
+    }
+    out = x;
+    return true;
+}
+
+// Arista de la grilla: esquina mínima, eje (0=x, 1=y, 2=z) y si el extremo
+// inicial es el negativo (define la orientación del quad). 20 bits por eje para
+// la esquina (que llega hasta n) y 3 para eje y signo: grillas de hasta 2^19
+// celdas por eje. Ordena igual que (i, j, k, eje, signo).
+const int edge_coord_bits = 20;
+
+inline uint64_t edge_key(int i, int j, int k, int axis, bool start_negative) {
+    const int b = edge_coord_bits;
+    return (uint64_t(i) << (2 * b + 3)) | (uint64_t(j) << (b + 3)) | (uint64_t(k) << 3) | (uint64_t(axis) << 1) |
+           (start_negative ? 1 : 0);
+}
+
+// ¿Entran las esquinas de la grilla de hojas en edge_key? Misma cuenta que
+// CellGrid, cortando antes de que n desborde.
+inline bool dual_grid_fits(Point3D start, Point3D end, double precision) {
+    double ex = end.x - start.x, ey = end.y - start.y, ez = end.z - start.z;
+    int bits = 0;
+    while (!(ex < precision || ey < precision || ez < precision)) {
+        ex /= 2; ey /= 2; ez /= 2;
+        if (++bits >= edge_coord_bits) return false;
+    }
+    return true;
+}
+
+inline void edge_coords(uint64_t key, int& i, int& j, int& k, int& axis) {
+    const int b = edge_coord_bits;
+    const uint64_t mask = (uint64_t(1) << b) - 1;
+    i = int((key >> (2 * b + 3)) & mask);
+    j = int((key >> (b + 3)) & mask);
+    k = int((key >> 3) & mask);
+    axis = int((key >> 1) & 3);
+}
+
+inline IndexedMesh dual_surface(const ScalarField& f, Point3D start, Point3D end,
+                                double precision, DualMethod method, CornerSink* samples = nullptr, double isovalue = 0,
+                                TraversalControl* control = nullptr, TraversalCounters* counters = nullptr) {
+    IndexedMesh mesh;
+    // Grilla más fina de lo que entran las claves de arista: malla vacía en
+    // lugar de claves repetidas (ExtractionConfig::check lo rechaza antes)
+    if (!dual_grid_fits(start, end, precision)) return mesh;
+    CellGrid grid(start, end, precision);
+    // Con cancelación la malla se arma con las celdas ya reunidas (parcial)
+    NodeKeys cells = collect_active_cells(f, start, end, precision, isovalue, control, counters);
+
+    // Vértices de las celdas activas
+    vector<Point3D> cell_points(cells.size());
+    vector<char> has_vertex(cells.size(), 0);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (long c = 0; c < (long)cells.size(); c++) {
+        int i, j, k;
+        cell_coords(cells[c], i, j, k);
+        has_vertex[c] = dual_cell_vertex(f, grid, i, j, k, method, isovalue, cell_points[c]);
+    }
+
+    NodeIndex vertex_of;
+    vertex_of.reserve(cells.size());
+    for (size_t c = 0; c < cells.size(); c++) {
+        if (!has_vertex[c]) continue;
+        vertex_of[cells[c]] = (int)mesh.vertices.size();
+        mesh.vertices.push_back(cell_points[c]);
+    }
+
+    // Aristas que cruzan la superficie, vistas desde cualquiera de sus celdas
+    vector<NodeKeys> edge_parts(omp_get_max_threads());
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (long c = 0; c < (long)cells.size(); c++) {
+        if (!has_vertex[c]) continue;
+        int i, j, k;
+        cell_coords(cells[c], i, j, k);
+        Point3D corners[8];
+        double values[8];
+        for (int q = 0; q < 8; q++) {
+            corners[q] = grid.corner(i + cube_corner_offsets[q][0], j + cube_corner_offsets[q][1], k + cube_corner_offsets[q][2]);
+        }
+        f.evaluate(corners, values, 8);
+        if (samples) samples->record(corners, values);
+        for (int e = 0; e < 12; e++) {
+            int a = cube_edge_corners[e][0], b = cube_edge_corners[e][1];
+            if ((values[a] < isovalue) == (values[b] < isovalue)) continue;
+            // Las aristas de la tabla van en ambos sentidos; normalizar al extremo mínimo
+            const int* oa = cube_corner_offsets[a];
+            const int* ob = cube_corner_offsets[b];
+            int axis = (oa[0] != ob[0]) ? 0 : (oa[1] != ob[1]) ? 1 : 2;
+            bool a_is_min = (oa[axis] < ob[axis]);
+            const int* omin = a_is_min ? oa : ob;
+            bool min_negative = a_is_min ? (values[a] < isovalue) : (values[b] < isovalue);
+            edge_parts[omp_get_thread_num()].push_back(edge_key(i + omin[0], j + omin[1], k + omin[2], axis, min_negative));
+        }
+    }
+    NodeKeys edges;
+    for (auto& part : edge_parts) edges.insert(edges.end(), part.begin(), part.end());
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+    // Celdas vecinas de cada arista (en sentido antihorario alrededor del eje)
+    static const int ring[3][4][3] = {
+        {{0,-1,-1},{0,0,-1},{0,0,0},{0,-1,0}},
+        {{-1,0,-1},{-1,0,0},{0,0,0},{0,0,-1}},
+        {{-1,-1,0},{0,-1,0},{0,0,0},{-1,0,0}}
+    };
+
+    // Celdas vecinas que el muestreo descartó pero que la arista necesita
+    NodeKeys missing;
+    for (uint64_t key : edges) {
+        int axis, i, j, k;
+        edge_coords(key, i, j, k, axis);
+        for (int r = 0; r < 4; r++) {
+            int ci = i + ring[axis][r][0], cj = j + ring[axis][r][1], ck = k + ring[axis][r][2];
+            if (ci < 0 || cj < 0 || ck < 0 || ci >= grid.n || cj >= grid.n || ck >= grid.n) continue;
+            if (!vertex_of.count(cell_key(ci, cj, ck))) missing.push_back(cell_key(ci, cj, ck));
+        }
+    }
+    sort(missing.begin(), missing.end());
+    missing.erase(unique(missing.begin(), missing.end()), missing.end());
+
+    vector<Point3D> missing_points(missing.size());
+    vector<char> missing_ok(missing.size(), 0);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (long c = 0; c < (long)missing.size(); c++) {
+        int i, j, k;
+        cell_coords(missing[c], i, j, k);
+        missing_ok[c] = dual_cell_vertex(f, grid, i, j, k, method, isovalue, missing_points[c]);
+    }
+    for (size_t c = 0; c < missing.size(); c++) {
+        if (!missing_ok[c]) continue;
+        vertex_of[missing[c]] = (int)mesh.vertices.size();
+        mesh.vertices.push_back(missing_points[c]);
+    }
+
+    // Un quad por arista, partido por la diagonal más corta
+    vector<vector<int>> index_parts(omp_get_max_threads());
+    #pragma omp parallel for schedule(static)
+    for (long e = 0; e < (long)edges.size(); e++) {
+        uint64_t key = edges[e];
+        int axis, i, j, k;
+        bool start_negative = key & 1;
+        edge_coords(key, i, j, k, axis);
+
+        int quad[4];
+        bool complete = true;
+        for (int r = 0; r < 4 && complete; r++) {
+            int ci = i + ring[axis][r][0], cj = j + ring[axis][r][1], ck = k + ring[axis][r][2];
+            if (ci < 0 || cj < 0 || ck < 0 || ci >= grid.n || cj >= grid.n || ck >= grid.n) {
+                complete = false;
+                break;
+            }
+            auto it = vertex_of.find(cell_key(ci, cj, ck));
+            if (it == vertex_of.end()) complete = false;
+            else quad[r] = it->second;
+        }
+        if (!complete) continue;
+
+        // Misma orientación que marching_cubes: la normal apunta hacia los valores negativos
+        if (start_negative) swap(quad[1], quad[3]);
+
+        vector<int>& out = index_parts[omp_get_thread_num()];
+        const vector<Point3D>& v = mesh.vertices;
+        if (squared_distance(v[quad[0]], v[quad[2]]) <= squared_distance(v[quad[1]], v[quad[3]])) {
+            out.insert(out.end(), {quad[0], quad[1], quad[2], quad[0], quad[2], quad[3]});
+        } else {
+            out.insert(out.end(), {quad[0], quad[1], quad[3], quad[1], quad[2], quad[3]});
+        }
+    }
+    for (auto& part : index_parts) {
+        mesh.indices.insert(mesh.indices.end(), part.begin(), part.end());
+    }
+
+    return mesh;
+}
+
+inline IndexedMesh surface_nets(const ScalarField& f, Point3D start, Point3D end, double precision) {
+    return dual_surface(f, start, end, precision, DualMethod::SurfaceNets);
+}
+
+inline IndexedMesh dual_contouring(const ScalarField& f, Point3D start, Point3D end, double precision) {
+    return dual_surface(f, start, end, precision, DualMethod::DualContouring);
+}
+
+#endif // DUAL_CONTOURING_H
@@ -0,0 +1,244 @@
+#ifndef EXPRESSION_FIELD_H
+#define EXPRESSION_FIELD_H
+
+#include "marching_cubes.h"
+#include <cctype>
+#include <cstdlib>
+
+// Campo escalar escrito como expresión en x, y, z, p. ej.
+//   "x^2 + y^2 + z^2 - 1"   o   "sin(x)*cos(y) + sin(y)*cos(z) + sin(z)*cos(x)"
+// Se compila una vez a una secuencia en notación polaca inversa que se evalúa
+// con una pila fija, sin reservas de memoria por punto.
+//
+// Gramática: suma := producto (('+' | '-') producto)*
+//            producto := unario (('*' | '/') unario)*
+//            unario := '-' unario | potencia
+//            potencia := primario ('^' unario)?
+//            primario := número | x | y | z | pi | e | función '(' args ')' | '(' suma ')'
+class Expression {
+public:
+    enum Op : unsigned char {
+        Constant, X, Y, Z, Add, Sub, Mul, Div, Pow, Neg,
+        Sin, Cos, Tan, Asin, Acos, Atan, Sqrt, Abs, Exp, Log, Floor, Atan2, Min, Max
+    };
+
+    class Instruction {
+    public:
+        Op op;
+        double value;
+    };
+
+    vector<Instruction> code;
+    int max_depth = 0;
+
+    // false y un mensaje si el texto no es una expresión válida
+    bool compile(const string& text, string& error) {
+        source = text;
+        position = 0;
+        code.clear();
+        error.clear();
+        this->error = &error;
+        parse_sum();
+        skip_spaces();
+        if (error.empty() && position < source.size()) fail("unexpected '" + string(1, source[position]) + "'");
+        if (!error.empty()) {
+            code.clear();
+            return false;
+        }
+        // Profundidad máxima de la pila
+        int depth = 0;
+        max_depth = 0;
+        for (const auto& ins : code) {
+            depth += stack_effect(ins.op);
+            max_depth = max(max_depth, depth);
+        }
+        if (max_depth > 64) {
+            error = "expression too deep";
+            code.clear();
+            return false;
+        }
+        return true;
+    }
+
+    double evaluate(double x, double y, double z) const {
+        double stack[64];
+        int top = -1;
+        for (const auto& ins : code) {
+            switch (ins.op) {
+                case Constant: stack[++top] = ins.value; break;
+                case X: stack[++top] = x; break;
+                case Y: stack[++top] = y; break;
+                case Z: stack[++top] = z; break;
+                case Add: top--; stack[top] += stack[top + 1]; break;
+                case Sub: top--; stack[top] -= stack[top + 1]; break;
+                case Mul: top--; stack[top] *= stack[top + 1]; break;
+                case Div: top--; stack[top] /= stack[top + 1]; break;
+                case Pow: top--; stack[top] = power(stack[top], stack[top + 1]); break;
+                case Atan2: top--; stack[top] = atan2(stack[top], stack[top + 1]); break;
+                case Min: top--; stack[top] = min(stack[top], stack[top + 1]); break;
+                case Max: top--; stack[top] = max(stack[top], stack[top + 1]); break;
+                case Neg: stack[top] = -stack[top]; break;
+                case Sin: stack[top] = sin(stack[top]); break;
+                case Cos: stack[top] = cos(stack[top]); break;
+                case Tan: stack[top] = tan(stack[top]); break;
+                case Asin: stack[top] = asin(stack[top]); break;
+                case Acos: stack[top] = acos(stack[top]); break;
+                case Atan: stack[top] = atan(stack[top]); break;
+                case Sqrt: stack[top] = sqrt(stack[top]); break;
+                case Abs: stack[top] = abs(stack[top]); break;
+                case Exp: stack[top] = exp(stack[top]); break;
+                case Log: stack[top] = log(stack[top]); break;
+                case Floor: stack[top] = floor(stack[top]); break;
+            }
+        }
+        return top == 0 ? stack[0] : 0;
+    }
+
+    ScalarField field() const {
+        return ScalarField([](const void* data, double x, double y, double z) { return ((const Expression*)data)->evaluate(x, y, z); },
+                           this);
+    }
+
+private:
+    string source;
+    size_t position = 0;
+    string* error = nullptr;
+
+    // Potencias enteras chicas sin pasar por pow
+    static double power(double base, double exponent) {
+        if (exponent == 2) return base * base;
+        if (exponent == 3) return base * base * base;
+        if (exponent == 4) { double b2 = base * base; return b2 * b2; }
+        return pow(base, exponent);
+    }
+
+    static int stack_effect(Op op) {
+        switch (op) {
+            case Constant: case X: case Y: case Z: return 1;
+            case Add: case Sub: case Mul: case Div: case Pow: case Atan2: case Min: case Max: return -1;
+            default: return 0;
+        }
+    }
+
+    void fail(const string& message) {
+        if (error->empty()) *error = message + " at position " + to_string(position);
+    }
+
+    void skip_spaces() {
+        while (position < source.size() && isspace((unsigned char)source[position])) position++;
+    }
+
+    bool accept(char c) {
+        skip_spaces();
+        if (position < source.size() && source[position] == c) {
+            position++;
+            return true;
+        }
+        return false;
+    }
+
+    void emit(Op op, double value = 0) { code.push_back({op, value}); }
+
+    void parse_sum() {
+        parse_product();
+        while (error->empty()) {
+            if (accept('+')) { parse_product(); emit(Add); }
+            else if (accept('-')) { parse_product(); emit(Sub); }
+            else break;
+        }
+    }
+
+    void parse_product() {
+        parse_unary();
+        while (error->empty()) {
+            if (accept('*')) { parse_unary(); emit(Mul); }
+            else if (accept('/')) { parse_unary(); emit(Div); }
+            else break;
+        }
+    }
+
+    void parse_unary() {
+        if (accept('-')) {
+            parse_unary();
+            emit(Neg);
+        } else if (accept('+')) {
+            parse_unary();
+        } else {
+            parse_power();
+        }
+    }
+
+    void parse_power() {
+        parse_primary();
+        // Asociativa a derecha: 2^3^2 = 2^(3^2)
+        if (error->empty() && accept('^')) {
+            parse_unary();
+            emit(Pow);
+        }
+    }
+
+    void parse_primary() {
+        skip_spaces();
+        if (position >= source.size()) {
+            fail("unexpected end of expression");
+            return;
+        }
+        char c = source[position];
+        if (isdigit((unsigned char)c) || c == '.') {
+            char* end = nullptr;
+            double value = strtod(source.c_str() + position, &end);
+            if (end == source.c_str() + position) {
+                fail("invalid number");
+                return;
+            }
+            position = end - source.c_str();
+            emit(Constant, value);
+            return;
+        }
+        if (accept('(')) {
+            parse_sum();
+            if (error->empty() && !accept(')')) fail("expected ')'");
+            return;
+        }
+        if (!isalpha((unsigned char)c)) {
+            fail("unexpected '" + string(1, c) + "'");
+            return;
+        }
+        size_t begin = position;
+        while (position < source.size() && (isalnum((unsigned char)source[position]) || source[position] == '_')) position++;
+        string name = source.substr(begin, position - begin);
+
+        if (name == "x") { emit(X); return; }
+        if (name == "y") { emit(Y); return; }
+        if (name == "z") { emit(Z); return; }
+        if (name == "pi") { emit(Constant, M_PI); return; }
+        if (name == "e") { emit(Constant, M_E); return; }
+
+        static const struct { const char* name; Op op; int arguments; } functions[] = {
+            {"sin", Sin, 1}, {"cos", Cos, 1}, {"tan", Tan, 1}, {"asin", Asin, 1}, {"acos", Acos, 1}, {"atan", Atan, 1},
+            {"sqrt", Sqrt, 1}, {"abs", Abs, 1}, {"exp", Exp, 1}, {"log", Log, 1}, {"floor", Floor, 1},
+            {"atan2", Atan2, 2}, {"min", Min, 2}, {"max", Max, 2}, {"pow", Pow, 2},
+        };
+        for (const auto& function : functions) {
+            if (name != function.name) continue;
+            if (!accept('(')) {
+                fail("expected '(' after " + name);
+                return;
+            }
+            for (int a = 0; a < function.arguments && error->empty(); a++) {
+                if (a > 0 && !accept(',')) {
+                    fail(name + " takes " + to_string(function.arguments) + " arguments");
+                    return;
+                }
+                parse_sum();
+            }
+            if (error->empty() && !accept(')')) fail("expected ')' after arguments of " + name);
+            emit(function.op);
+            return;
+        }
+        position = begin;
+        fail("unknown name '" + name + "'");
+    }
+};
+
+#endif // EXPRESSION_FIELD_H
@@ -0,0 +1,351 @@
+#ifndef EXTRACTOR_H
+#define EXTRACTOR_H
+
+#include "marching_cubes.h"
+#include "dual_contouring.h"
+#include "volume_field.h"
+#include "progressive.h"
+#include <atomic>
+#include <memory>
+
+// Punto de entrada como biblioteca: un contexto con el campo (función,
+// callback o volumen muestreado), el dominio, los isovalores, los atributos y
+// el motor. La extracción entrega lotes de triángulos a un TriangleSink desde
+// los hilos que los producen, o junta las mallas si no hace falta streaming.
+
+enum class Engine { MarchingCubes, MarchingCubes33, SurfaceNets, DualContouring };
+
+inline bool parse_engine(const string& name, Engine& engine) {
+    if (name == "mc") engine = Engine::MarchingCubes;
+    else if (name == "mc33") engine = Engine::MarchingCubes33;
+    else if (name == "surfacenets" || name == "sn") engine = Engine::SurfaceNets;
+    else if (name == "dc") engine = Engine::DualContouring;
+    else return false;
+    return true;
+}
+
+inline const char* engine_name(Engine engine) {
+    switch (engine) {
+        case Engine::MarchingCubes33: return "mc33";
+        case Engine::SurfaceNets: return "surfacenets";
+        case Engine::DualContouring: return "dc";
+        default: return "mc";
+    }
+}
+
+inline bool is_dual(Engine engine) { return engine == Engine::SurfaceNets || engine == Engine::DualContouring; }
+
+class ExtractionConfig {
+public:
+    Engine engine = Engine::MarchingCubes;
+    Point3D start = Point3D(-1, -1, -1), end = Point3D(1, 1, 1);
+    double precision = 0.1;
+    vector<double> isovalues = vector<double>(1, 0.0);
+    double snap = 0;                 // ver CellOptions
+    size_t batch_size = 4096;        // triángulos por lote entregado al receptor
+    CornerSink* samples = nullptr;   // valores de esquina de cada hoja (p. ej. NarrowBandRecorder)
+    TraversalControl* control = nullptr;  // cancelación y avance; nullptr = sin control
+    TraversalCounters* counters = nullptr;  // nodos por profundidad para ProgressMonitor
+    TaskTracer* tracer = nullptr;    // línea de tiempo de las tareas (trace.h; no cubre los motores duales)
+    double time_limit = 0;           // plazo en segundos desde el inicio de la extracción; 0 = sin plazo
+    double fallback_share = 0.25;    // tiempo de la malla gruesa de respaldo, en fracción de time_limit (0 = sin respaldo)
+
+    // Lo que los setters no pueden ver por separado; false con el mensaje de error
+    bool check(string& error) const {
+        if (is_dual(engine) && !dual_grid_fits(start, end, precision)) {
+            error = "precision too fine for the dual engines (at most 2^19 cells per axis)";
+            return false;
+        }
+        return true;
+    }
+};
+
+class ExtractionStats {
+public:
+    vector<size_t> triangles;  // por isovalor
+    double seconds = 0;
+    bool cancelled = false;    // la salida es parcial
+    bool expired = false;      // se canceló por el plazo
+    double progress = 1;       // fracción del dominio recorrida
+
+    size_t total_triangles() const {
+        size_t total = 0;
+        for (size_t n : triangles) total += n;
+        return total;
+    }
+};
+
+class Extractor {
+public:
+    ExtractionConfig config;
+
+    Extractor() {}
+    explicit Extractor(const ScalarField& f, const ExtractionConfig& config = ExtractionConfig()) : config(config), field_(f) {}
+
+    // Campo analítico o callback con datos propios
+    void set_field(const ScalarField& f) {
+        volume_field.reset();
+        field_ = f;
+    }
+
+    // Volumen muestreado: arma la pirámide de rangos y toma el dominio del volumen
+    void set_volume(const Volume& volume, Reconstruction reconstruction = Reconstruction::Trilinear, double threshold = 0) {
+        volume_field.reset(new VolumeField(volume, reconstruction, threshold));
+        field_ = volume_field->field();
+        config.start = volume.origin;
+        config.end = volume.end();
+    }
+
+    // Campo auxiliar interpolado en cada vértice (ver CellAttributes)
+    void add_attribute(const string& name, const ScalarField& f) {
+        attribute_names.push_back(name);
+        attributes.push_back(f);
+    }
+
+    const ScalarField& field() const { return field_; }
+    const VolumeField* volume() const { return volume_field.get(); }
+    const vector<string>& attribute_name_list() const { return attribute_names; }
+
+    CellOptions cell_options(double isovalue = 0) const {
+        CellOptions options(config.engine == Engine::MarchingCubes33 ? CellTable::AsymptoticDecider : CellTable::Classic,
+                            config.snap, isovalue);
+        options.samples = config.samples;
+        options.control = config.control;
+        options.counters = config.counters;
+        options.tracer = config.tracer;
+        if (!attributes.empty()) options.attributes = &attributes;
+        return options;
+    }
+
+    // Entrega los triángulos por lotes a medida que se producen. Con marching
+    // cubes los lotes salen de los hilos del recorrido; los motores duales
+    // necesitan la malla completa para unir las celdas y entregan al final.
+    // Si se cancela o vence el plazo, lo entregado hasta ahí es la salida parcial.
+    ExtractionStats extract(TriangleSink& sink) const {
+        double t0 = omp_get_wtime();
+        TraversalControl own;
+        TraversalControl* control = start_control(config, own);
+        CountingSink counter(sink, config.isovalues.size());
+        if (is_dual(config.engine)) {
+            for (size_t k = 0; k < config.isovalues.size(); k++) deliver_mesh(dual_mesh(config, k, control), k, counter);
+        } else {
+            CellOptions options = cell_options();
+            options.control = control;
+            surface_to_sink(field_, config.start, config.end, config.precision, config.isovalues, options, counter, config.batch_size);
+        }
+        ExtractionStats stats;
+        for (auto& n : counter.counts) stats.triangles.push_back(n.load());
+        finish_stats(stats, control, t0);
+        return stats;
+    }
+
+    // Una sopa por isovalor (sólo marching cubes)
+    vector<TriangleSoup> extract_soups(ExtractionStats* stats = nullptr) const {
+        double t0 = omp_get_wtime();
+        TraversalControl own;
+        TraversalControl* control = start_control(config, own);
+        CellOptions options = cell_options();
+        options.control = control;
+        vector<TriangleSoup> soups = surface_to_soups(field_, config.start, config.end, config.precision, config.isovalues, options);
+        if (stats) {
+            stats->triangles.clear();
+            for (const auto& soup : soups) stats->triangles.push_back(soup.triangles.size());
+            finish_stats(*stats, control, t0);
+        }
+        return soups;
+    }
+
+    // Una malla indexada por isovalor, con los atributos por vértice. Si vence
+    // el plazo las mallas son parciales y fallback recibe la de respaldo.
+    vector<IndexedMesh> extract_meshes(ExtractionStats* stats = nullptr, vector<IndexedMesh>* fallback = nullptr) const {
+        ExtractionStats own_stats;
+        if (!stats) stats = &own_stats;
+        vector<IndexedMesh> meshes = meshes_for(config, stats);
+        if (fallback && stats->expired) *fallback = fallback_meshes(*stats);
+        return meshes;
+    }
+
+    // Vistas previas de gruesa a fina y la malla final (progressive.h). Los
+    // motores duales entregan sólo el nivel final.
+    ExtractionStats extract_progressive(PreviewSink& sink, int first_preview = 2) const {
+        double t0 = omp_get_wtime();
+        TraversalControl own;
+        TraversalControl* control = start_control(config, own);
+
+        // Cuenta los triángulos del último nivel entregado
+        class FinalCounter : public PreviewSink {
+        public:
+            PreviewSink& target;
+            vector<size_t> triangles;
+            FinalCounter(PreviewSink& target) : target(target) {}
+            void preview(PreviewLevel& level) override {
+                if (level.final) {
+                    triangles.clear();
+                    for (const auto& soup : level.soups) triangles.push_back(soup.triangles.size());
+                }
+                target.preview(level);
+            }
+        } counter(sink);
+
+        if (is_dual(config.engine)) {
+            CellGrid grid(config.start, config.end, config.precision);
+            PreviewLevel level;
+            level.final = true;
+            while ((1 << level.depth) < grid.n) level.depth++;
+            level.cell_size = Point3D(grid.hx, grid.hy, grid.hz);
+            for (size_t k = 0; k < config.isovalues.size(); k++) {
+                IndexedMesh mesh = dual_mesh(config, k, control);
+                level.active_nodes += mesh.vertices.size();
+                level.soups.push_back(mesh_soup(mesh));
+            }
+            level.seconds = omp_get_wtime() - t0;
+            counter.preview(level);
+        } else {
+            CellOptions options = cell_options();
+            options.control = control;
+            progressive_surface(field_, config.start, config.end, config.precision, config.isovalues, options, counter, first_preview);
+        }
+        ExtractionStats stats;
+        stats.triangles = counter.triangles;
+        finish_stats(stats, control, t0);
+        return stats;
+    }
+
+    // Malla gruesa completa para acompañar una salida cortada por el plazo. La
+    // precisión se elige para que entre en fallback_share * time_limit,
+    // estimando la corrida fina completa como seconds / progress y un costo que
+    // crece como 1 / precisión² (los nodos activos están cerca de la
+    // superficie). Tiene su propio plazo de time_limit por si la estimación falla.
+    vector<IndexedMesh> fallback_meshes(const ExtractionStats& stats) const {
+        if (config.fallback_share <= 0 || config.time_limit <= 0) return vector<IndexedMesh>();
+        double budget = config.fallback_share * config.time_limit;
+        double full = stats.seconds / max(stats.progress, 1e-3);
+        double extent = min(config.end.x - config.start.x, min(config.end.y - config.start.y, config.end.z - config.start.z));
+        double factor = 2;
+        while (full / (factor * factor) > budget && config.precision * factor * 2 < extent) factor *= 2;
+
+        ExtractionConfig coarse = config;
+        coarse.precision = config.precision * factor;
+        coarse.samples = nullptr;
+        coarse.control = nullptr;
+        coarse.counters = nullptr;
+        coarse.tracer = nullptr;
+        coarse.fallback_share = 0;
+        ExtractionStats coarse_stats;
+        return meshes_for(coarse, &coarse_stats);
+    }
+
+private:
+    ScalarField field_;
+    unique_ptr<VolumeField> volume_field;
+    vector<string> attribute_names;
+    vector<ScalarField> attributes;
+
+    // Cuenta lo entregado por isovalor y pasa el lote tal cual
+    class CountingSink : public TriangleSink {
+    public:
+        TriangleSink& target;
+        vector<atomic<size_t>> counts;
+
+        CountingSink(TriangleSink& target, size_t isovalues) : target(target), counts(isovalues) {
+            for (auto& n : counts) n = 0;
+        }
+        void deliver(size_t k, const TriangleSoup& batch) override {
+            counts[k] += batch.triangles.size();
+            target.deliver(k, batch);
+        }
+    };
+
+    // El control del llamador, o uno propio si sólo hace falta el plazo. Los
+    // contadores toman la profundidad de las hojas de esta corrida.
+    static TraversalControl* start_control(const ExtractionConfig& c, TraversalControl& own) {
+        if (c.counters) c.counters->start(c.start, c.end, c.precision);
+        TraversalControl* control = c.control;
+        if (c.time_limit > 0) {
+            if (!control) control = &own;
+            control->set_time_limit(c.time_limit);
+        }
+        return control;
+    }
+
+    void finish_stats(ExtractionStats& stats, TraversalControl* control, double t0) const {
+        stats.seconds = omp_get_wtime() - t0;
+        if (!control) return;
+        stats.cancelled = control->cancelled;  // sin volver a mirar el plazo: ya terminó
+        stats.expired = control->expired;
+        // Los motores duales recorren el dominio una vez por isovalor
+        double passes = is_dual(config.engine) ? (double)config.isovalues.size() : 1.0;
+        stats.progress = min(1.0, (double)control->done.load() / (double)(uint64_t(1) << 60) / passes);
+        if (!stats.cancelled) stats.progress = 1;
+    }
+
+    vector<IndexedMesh> meshes_for(const ExtractionConfig& c, ExtractionStats* stats) const {
+        double t0 = omp_get_wtime();
+        TraversalControl own;
+        TraversalControl* control = start_control(c, own);
+        vector<IndexedMesh> meshes;
+        if (is_dual(c.engine)) {
+            for (size_t k = 0; k < c.isovalues.size(); k++) meshes.push_back(dual_mesh(c, k, control));
+        } else {
+            CellOptions options = cell_options();
+            options.samples = c.samples;
+            options.control = control;
+            options.counters = c.counters;
+            options.tracer = c.tracer;
+            vector<TriangleSoup> soups = surface_to_soups(field_, c.start, c.end, c.precision, c.isovalues, options);
+            for (auto& soup : soups) {
+                meshes.push_back(weld_soup(soup, attribute_names));
+                soup = TriangleSoup();
+            }
+        }
+        stats->triangles.clear();
+        for (const auto& mesh : meshes) stats->triangles.push_back(mesh.triangle_count());
+        finish_stats(*stats, control, t0);
+        return meshes;
+    }
+
+    IndexedMesh dual_mesh(const ExtractionConfig& c, size_t k, TraversalControl* control) const {
+        DualMethod method = (c.engine == Engine::SurfaceNets) ? DualMethod::SurfaceNets : DualMethod::DualContouring;
+        IndexedMesh mesh = dual_surface(field_, c.start, c.end, c.precision, method, c.samples, c.isovalues[k], control,
+                                        c.counters);
+        // El vértice dual no está sobre una arista: los atributos se evalúan en él
+        if (!attributes.empty()) sample_attributes(mesh, attributes, attribute_names);
+        return mesh;
+    }
+
+    static TriangleSoup mesh_soup(const IndexedMesh& mesh) {
+        TriangleSoup soup;
+        soup.attribute_count = mesh.has_attributes() ? mesh.attribute_count() : 0;
+        for (size_t t = 0; t < mesh.triangle_count(); t++) {
+            const int* tri = &mesh.indices[3 * t];
+            soup.triangles.push_back(Triangle(mesh.vertices[tri[0]], mesh.vertices[tri[1]], mesh.vertices[tri[2]]));
+            for (int c = 0; c < 3; c++) {
+                soup.attributes.insert(soup.attributes.end(), mesh.attributes.begin() + tri[c] * soup.attribute_count,
+                                       mesh.attributes.begin() + (tri[c] + 1) * soup.attribute_count);
+            }
+        }
+        return soup;
+    }
+
+    void deliver_mesh(const IndexedMesh& mesh, size_t k, TriangleSink& sink) const {
+        size_t count = mesh.has_attributes() ? mesh.attribute_count() : 0;
+        size_t batch_size = max<size_t>(1, config.batch_size);
+        TriangleSoup batch;
+        batch.attribute_count = count;
+        for (size_t t = 0; t < mesh.triangle_count(); t++) {
+            const int* tri = &mesh.indices[3 * t];
+            batch.triangles.push_back(Triangle(mesh.vertices[tri[0]], mesh.vertices[tri[1]], mesh.vertices[tri[2]]));
+            for (int c = 0; c < 3; c++) {
+                batch.attributes.insert(batch.attributes.end(), mesh.attributes.begin() + tri[c] * count,
+                                        mesh.attributes.begin() + (tri[c] + 1) * count);
+            }
+            if (batch.triangles.size() >= batch_size || t + 1 == mesh.triangle_count()) {
+                sink.deliver(k, batch);
+                batch.triangles.clear();
+                batch.attributes.clear();
+            }
+        }
+    }
+};
+
+#endif // EXTRACTOR_H
@@ -2,15 +2,23 @@ import pandas as pd
 import matplotlib.pyplot as plt
 import seaborn as sns
 
-df = pd.read_csv("matrix_analysis.csv")
+# Salida de ./paralelo --scaling scaling (ver benchmark.sh): una fila por caso y fase
+df = pd.read_csv("scaling.csv")
+debil = df[df['mode'] == 'weak']
+df = df[df['mode'] == 'strong']
+total = df[df['phase'] == 'total']
 
-# Gráfico 1: Tiempo vs Threads por resolución
+def etiqueta(surface, engine, res):
+    return f"{surface} {engine} res={res}"
+
+# Gráfico 1: Tiempo vs Threads por resolución, con el intervalo de confianza de la mediana
 plt.figure(figsize=(10,6))
-for res in sorted(df['Resolution'].unique(), key=lambda x: float(x)):
-    subset = df[df['Resolution'] == res].groupby('Threads')['Time_seconds'].mean()
-    plt.plot(subset.index, subset.values, marker='o', label=f"res={res}")
+for (surface, engine, res), subset in total.groupby(['surface', 'engine', 'precision']):
+    subset = subset.sort_values('threads')
+    error = [subset['median_s'] - subset['ci_low_s'], subset['ci_high_s'] - subset['median_s']]
+    plt.errorbar(subset['threads'], subset['median_s'], yerr=error, marker='o', capsize=3, label=etiqueta(surface, engine, res))
 plt.xlabel("Threads")
-plt.ylabel("Tiempo promedio (s)")
+plt.ylabel("Tiempo mediano (s)")
 plt.title("Tiempo de ejecución vs Threads por resolución")
 plt.legend()
 plt.grid(True)
@@ -19,9 +27,9 @@ plt.show()
 
 # Gráfico 2: Speedup vs Threads por resolución
 plt.figure(figsize=(10,6))
-for res in sorted(df['Resolution'].unique(), key=lambda x: float(x)):
-    subset = df[df['Resolution'] == res].groupby('Threads')['Speedup_vs_1thread'].mean()
-    plt.plot(subset.index, subset.values, marker='o', label=f"res={res}")
+for (surface, engine, res), subset in total.groupby(['surface', 'engine', 'precision']):
+    subset = subset.sort_values('threads')
+    plt.plot(subset['threads'], subset['speedup'], marker='o', label=etiqueta(surface, engine, res))
 plt.xlabel("Threads")
 plt.ylabel("Speedup")
 plt.title("Speedup vs Threads por resolución")
@@ -32,9 +40,9 @@ plt.show()
 
 # Gráfico 3: Eficiencia vs Threads por resolución
 plt.figure(figsize=(10,6))
-for res in sorted(df['Resolution'].unique(), key=lambda x: float(x)):
-    subset = df[df['Resolution'] == res].groupby('Threads')['Efficiency'].mean()
-    plt.plot(subset.index, subset.values, marker='o', label=f"res={res}")
+for (surface, engine, res), subset in total.groupby(['surface', 'engine', 'precision']):
+    subset = subset.sort_values('threads')
+    plt.plot(subset['threads'], subset['efficiency'], marker='o', label=etiqueta(surface, engine, res))
 plt.xlabel("Threads")
 plt.ylabel("Eficiencia")
 plt.title("Eficiencia vs Threads por resolución")
@@ -42,3 +50,42 @@ plt.legend()
 plt.grid(True)
 plt.tight_layout()
 plt.show()
+
+# Gráfico 4: Tiempo por fase (recorrido, unión, soldado, escritura) en la resolución más fina
+fases = df[df['phase'] != 'total']
+fina = fases[fases['precision'] == fases['precision'].min()]
+for (surface, engine), subset in fina.groupby(['surface', 'engine']):
+    tabla = subset.pivot_table(values='median_s', index='threads', columns='phase', sort=False)
+    tabla.plot(kind='bar', stacked=True, figsize=(10,6))
+    plt.xlabel("Threads")
+    plt.ylabel("Tiempo mediano (s)")
+    plt.title(f"Tiempo por fase: {surface} {engine} res={fina['precision'].iloc[0]}")
+    plt.grid(True, axis='y')
+    plt.tight_layout()
+    plt.show()
+
+# Escalabilidad débil: el problema crece con los threads (columna work) y la
+# eficiencia ideal es 1. excess_s dice qué fase se come la eficiencia.
+if not debil.empty:
+    plt.figure(figsize=(10,6))
+    for (surface, engine, res), subset in debil[debil['phase'] == 'total'].groupby(['surface', 'engine', 'precision']):
+        subset = subset.sort_values('threads')
+        plt.plot(subset['threads'], subset['efficiency'], marker='o', label=f"{surface} {engine}")
+    plt.axhline(y=1.0, color='k', linestyle='--', alpha=0.5)
+    plt.xlabel("Threads")
+    plt.ylabel("Eficiencia (débil)")
+    plt.title("Escalabilidad débil: trabajo por thread constante")
+    plt.legend()
+    plt.grid(True)
+    plt.tight_layout()
+    plt.show()
+
+    for (surface, engine), subset in debil[debil['phase'] != 'total'].groupby(['surface', 'engine']):
+        tabla = subset.pivot_table(values='excess_s', index='threads', columns='phase', sort=False)
+        tabla.plot(kind='bar', stacked=True, figsize=(10,6))
+        plt.xlabel("Threads")
+        plt.ylabel("Tiempo sobre el ideal (s)")
+        plt.title(f"Pérdida de eficiencia por fase (débil): {surface} {engine}")
+        plt.grid(True, axis='y')
+        plt.tight_layout()
+        plt.show()
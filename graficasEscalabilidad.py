@@ -2,6 +2,7 @@ import numpy as np
 import matplotlib.pyplot as plt
 from scipy.optimize import curve_fit
 import pandas as pd
+import os
 
 # Configuración de matplotlib para mejor visualización
 plt.rcParams['figure.figsize'] = (15, 12)
@@ -22,6 +23,29 @@ datos_tiempo = {
     }
 }
 
+def cargar_escalabilidad(archivo):
+    """
+    Tiempos medianos de la fase total desde el CSV de ./paralelo --scaling,
+    (escalabilidad fuerte), para la primera superficie y el primer motor del barrido
+    """
+    df = pd.read_csv(archivo)
+    df = df[(df['phase'] == 'total') & (df['mode'] == 'strong')]
+    df = df[(df['surface'] == df['surface'].iloc[0]) & (df['engine'] == df['engine'].iloc[0])]
+    tabla = df.pivot_table(values='median_s', index='precision', columns='threads').dropna()
+    resoluciones = sorted(tabla.index, reverse=True)
+    return {
+        'resoluciones': resoluciones,
+        'hilos': [int(p) for p in tabla.columns],
+        'tiempos': {r: list(tabla.loc[r]) for r in resoluciones}
+    }
+
+# Con scaling.csv (benchmark.sh) se usan las mediciones propias
+if os.path.exists('scaling.csv'):
+    datos_tiempo = cargar_escalabilidad('scaling.csv')
+    print("Datos de scaling.csv:", datos_tiempo['resoluciones'], "x", datos_tiempo['hilos'], "hilos")
+else:
+    print("No se encontró scaling.csv (ver benchmark.sh): se usan los datos del documento")
+
 # Parámetros del modelo teórico (estimados basándose en los datos)
 params = {
     'k': 0.2,  # Factor de eficiencia espacial
@@ -110,12 +134,12 @@ markers = ['o', 's', '^', 'D']
 for i, r in enumerate(datos_tiempo['resoluciones']):
     # Datos experimentales
     tiempos_exp = datos_tiempo['tiempos'][r]
-    ax1.plot(hilos, tiempos_exp, marker=markers[i], color=colores[i], 
+    ax1.plot(hilos, tiempos_exp, marker=markers[i % len(markers)], color=colores[i % len(colores)], 
              linewidth=2, markersize=8, label=f'Experimental r={r}')
     
     # Modelo teórico
     tiempos_teo = [modelo_tiempo_teorico(p, r, **params_opt) for p in hilos]
-    ax1.plot(hilos, tiempos_teo, '--', color=colores[i], alpha=0.7, 
+    ax1.plot(hilos, tiempos_teo, '--', color=colores[i % len(colores)], alpha=0.7, 
              linewidth=2, label=f'Teórico r={r}')
 
 ax1.set_xlabel('Número de Hilos')
@@ -130,12 +154,12 @@ for i, r in enumerate(datos_tiempo['resoluciones']):
     # Speedup experimental
     tiempos_exp = datos_tiempo['tiempos'][r]
     speedup_exp = [tiempos_exp[0] / t for t in tiempos_exp]
-    ax2.plot(hilos, speedup_exp, marker=markers[i], color=colores[i], 
+    ax2.plot(hilos, speedup_exp, marker=markers[i % len(markers)], color=colores[i % len(colores)], 
              linewidth=2, markersize=8, label=f'Experimental r={r}')
     
     # Speedup teórico
     speedup_teo = [speedup_teorico(p, r, **params_opt) for p in hilos]
-    ax2.plot(hilos, speedup_teo, '--', color=colores[i], alpha=0.7, 
+    ax2.plot(hilos, speedup_teo, '--', color=colores[i % len(colores)], alpha=0.7, 
              linewidth=2, label=f'Teórico r={r}')
 
 # Línea de speedup ideal
@@ -151,12 +175,12 @@ for i, r in enumerate(datos_tiempo['resoluciones']):
     # Eficiencia experimental
     tiempos_exp = datos_tiempo['tiempos'][r]
     eficiencia_exp = [(tiempos_exp[0] / t) / p for t, p in zip(tiempos_exp, hilos)]
-    ax3.plot(hilos, eficiencia_exp, marker=markers[i], color=colores[i], 
+    ax3.plot(hilos, eficiencia_exp, marker=markers[i % len(markers)], color=colores[i % len(colores)], 
              linewidth=2, markersize=8, label=f'Experimental r={r}')
     
     # Eficiencia teórica
     eficiencia_teo = [eficiencia_teorica(p, r, **params_opt) for p in hilos]
-    ax3.plot(hilos, eficiencia_teo, '--', color=colores[i], alpha=0.7, 
+    ax3.plot(hilos, eficiencia_teo, '--', color=colores[i % len(colores)], alpha=0.7, 
              linewidth=2, label=f'Teórico r={r}')
 
 ax3.axhline(y=1.0, color='k', linestyle='--', alpha=0.5, label='Eficiencia Ideal')
@@ -181,7 +205,7 @@ for i, E in enumerate(eficiencias):
 # Puntos experimentales de trabajo
 for i, r in enumerate(datos_tiempo['resoluciones']):
     trabajo_exp = [params_opt['k'] * (1/r)**3 * params_opt['T_cubo']] * len(hilos)
-    ax4.scatter(hilos, trabajo_exp, marker=markers[i], color=colores[i], 
+    ax4.scatter(hilos, trabajo_exp, marker=markers[i % len(markers)], color=colores[i % len(colores)], 
                s=80, label=f'Trabajo r={r}', alpha=0.7)
 
 ax4.set_xlabel('Número de Hilos')
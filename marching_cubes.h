@@ -0,0 +1,1311 @@
+#ifndef MARCHING_CUBES_H
+#define MARCHING_CUBES_H
+
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <algorithm>
+#include <omp.h>
+#include <random>
+#include <type_traits>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include "memory_accounting.h"
+
+using namespace std;
+
+class Point3D {
+public:
+    double x, y, z;
+
+    Point3D(double x = 0, double y = 0, double z = 0) : x(x), y(y), z(z) {}
+
+    bool operator==(const Point3D& other) const {
+        return (abs(x - other.x) < 1e-9 && abs(y - other.y) < 1e-9 && abs(z - other.z) < 1e-9);
+    }
+};
+
+class Triangle {
+public:
+    Point3D p1, p2, p3;
+
+    Triangle(Point3D p1, Point3D p2, Point3D p3) : p1(p1), p2(p2), p3(p3) {}
+
+    // Sin área: dos vértices coinciden, o los tres quedan alineados (dos
+    // cruces pegados a las esquinas de una arista y el tercero sobre ella).
+    // Mismo umbral relativo que validate_mesh.
+    bool collapsed() const {
+        if (p1 == p2 || p2 == p3 || p3 == p1) return true;
+        double ux = p2.x - p1.x, uy = p2.y - p1.y, uz = p2.z - p1.z;
+        double vx = p3.x - p1.x, vy = p3.y - p1.y, vz = p3.z - p1.z;
+        double nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+        double wx = p3.x - p2.x, wy = p3.y - p2.y, wz = p3.z - p2.z;
+        double longest = max(ux * ux + uy * uy + uz * uz, max(vx * vx + vy * vy + vz * vz, wx * wx + wy * wy + wz * wz));
+        return nx * nx + ny * ny + nz * nz <= 1e-24 * longest * longest;
+    }
+};
+
+class Face {
+public:
+    vector<Point3D> vertices;
+
+    Face() {}
+    
+    void addVertex(const Point3D& vertex) {
+        vertices.push_back(vertex);
+    }
+    
+    vector<Triangle> triangulate() const {
+        vector<Triangle> triangles;
+        if (vertices.size() < 3) return triangles;
+        
+        // Fan triangulation from first vertex
+        for (size_t i = 1; i < vertices.size() - 1; i++) {
+            triangles.push_back(Triangle(vertices[0], vertices[i], vertices[i + 1]));
+        }
+        return triangles;
+    }
+};
+
+// Campo escalar evaluado por los motores: una función libre (las superficies
+// analíticas) o una función con datos propios, como un volumen muestreado o un
+// callback externo. Un campo con datos puede traer además su propio descarte
+// de nodos (contains_surface) en lugar del muestreo aleatorio. Un callback por
+// lotes (batch) recibe varios puntos por llamada: las 8 esquinas de una hoja o
+// las muestras del descarte, lo que amortiza llamadas caras (p. ej. desde Python).
+class ScalarField {
+public:
+    typedef double (*Function)(double, double, double);
+    typedef double (*Callback)(const void* data, double x, double y, double z);
+    typedef void (*BatchCallback)(const void* data, const double* xyz, double* values, size_t count);
+    typedef bool (*RangeQuery)(const void* data, Point3D start, Point3D end, double isovalue);
+
+    Function function = nullptr;
+    Callback callback = nullptr;
+    BatchCallback batch = nullptr;
+    const void* data = nullptr;
+    RangeQuery contains_surface = nullptr;
+
+    ScalarField() {}
+    // Acepta punteros a función y lambdas sin captura
+    template <class F, class = typename enable_if<is_convertible<F, Function>::value>::type>
+    ScalarField(F function) : function(function) {}
+    ScalarField(Callback callback, const void* data, RangeQuery contains_surface = nullptr)
+        : callback(callback), data(data), contains_surface(contains_surface) {}
+
+    static ScalarField batched(BatchCallback batch, const void* data, RangeQuery contains_surface = nullptr) {
+        ScalarField field;
+        field.batch = batch;
+        field.data = data;
+        field.contains_surface = contains_surface;
+        return field;
+    }
+
+    double operator()(double x, double y, double z) const {
+        if (function) return function(x, y, z);
+        if (callback) return callback(data, x, y, z);
+        double p[3] = {x, y, z}, value;
+        batch(data, p, &value, 1);
+        return value;
+    }
+
+    // values[i] = f(points[i])
+    void evaluate(const Point3D* points, double* values, size_t count) const {
+        if (batch) {
+            static_assert(sizeof(Point3D) == 3 * sizeof(double), "Point3D debe ser x, y, z contiguos");
+            batch(data, &points[0].x, values, count);
+            return;
+        }
+        for (size_t i = 0; i < count; i++) values[i] = (*this)(points[i].x, points[i].y, points[i].z);
+    }
+
+    // Puntos por llamada al muestrear: con callback por lotes conviene juntar
+    // muchos; con una función, uno, para cortar apenas se ven los dos signos.
+    size_t sample_chunk() const { return batch ? 256 : 1; }
+
+    explicit operator bool() const { return function != nullptr || callback != nullptr || batch != nullptr; }
+};
+
+inline Point3D get_random_point_3d(double xmin, double ymin, double zmin, double xmax, double ymax, double zmax, std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist_x(xmin, xmax);
+    std::uniform_real_distribution<double> dist_y(ymin, ymax);
+    std::uniform_real_distribution<double> dist_z(zmin, zmax);
+    return Point3D(dist_x(rng), dist_y(rng), dist_z(rng));
+}
+
+// Semilla del muestreo de un nodo a partir de sus extremos: el mismo nodo
+// toma las mismas muestras en cualquier hilo y corrida, así la malla de un
+// campo analítico es reproducible (ver el corpus de surfaces.h).
+inline uint32_t node_seed(Point3D start, Point3D end) {
+    const double coords[6] = {start.x, start.y, start.z, end.x, end.y, end.z};
+    uint64_t h = 0x9e3779b97f4a7c15ull;
+    for (double c : coords) {
+        uint64_t bits;
+        memcpy(&bits, &c, sizeof(bits));
+        h ^= bits + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    }
+    // splitmix64 para mezclar los bits
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return (uint32_t)(h ^ (h >> 31));
+}
+
+inline bool cube_contains_surface(const ScalarField& f, Point3D start, Point3D end, double isovalue = 0) {
+    if (f.contains_surface) return f.contains_surface(f.data, start, end, isovalue);
+
+    const int num_samples = 10000;
+    bool has_positive = false;
+    bool has_negative = false;
+
+    std::mt19937 rng(node_seed(start, end));
+
+    const size_t chunk = f.sample_chunk();
+    vector<Point3D> points(chunk);
+    vector<double> values(chunk);
+    for (int i = 0; i < num_samples; i += (int)chunk) {
+        size_t n = min(chunk, (size_t)(num_samples - i));
+        for (size_t s = 0; s < n; s++) points[s] = get_random_point_3d(start.x, start.y, start.z, end.x, end.y, end.z, rng);
+        f.evaluate(points.data(), values.data(), n);
+
+        for (size_t s = 0; s < n; s++) {
+            if (values[s] >= isovalue)
+                has_positive = true;
+            else
+                has_negative = true;
+        }
+
+        if (has_positive && has_negative)
+            return true;
+    }
+
+    return false;
+}
+
+// Receptor opcional de los valores de esquina que el kernel ya evaluó, para
+// reutilizarlos (p. ej. exportar el volumen) sin una segunda pasada sobre f.
+// Se llama desde varios hilos a la vez.
+class CornerSink {
+public:
+    virtual ~CornerSink() {}
+    virtual void record(const Point3D corners[8], const double values[8]) = 0;
+};
+
+enum class CellTable { Classic, AsymptoticDecider };
+
+// Cancelación y avance de un recorrido del octree en curso. Cada tarea mira
+// cancelled al empezar y no baja más; cada nodo terminado (hoja o descartado)
+// suma su fracción del dominio, 8^-profundidad, en unidades de 2^-60.
+// Con un plazo (deadline, en segundos de omp_get_wtime) la misma consulta
+// cancela al vencer y deja expired en true. Lo ya producido queda en la salida.
+class TraversalControl {
+public:
+    atomic<bool> cancelled{false};
+    atomic<bool> expired{false};
+    atomic<uint64_t> done{0};
+    atomic<int> reported_percent{0};
+    double deadline = 0;  // 0 = sin plazo
+
+    virtual ~TraversalControl() {}
+
+    // Se llama desde los hilos del recorrido cada vez que el avance cruza un 1%
+    virtual void progressed(double) {}
+
+    void cancel() { cancelled = true; }
+    void reset() {
+        cancelled = false;
+        expired = false;
+        done = 0;
+        reported_percent = 0;
+        deadline = 0;
+    }
+    // Plazo a seconds segundos de ahora; 0 lo quita
+    void set_time_limit(double seconds) { deadline = seconds > 0 ? omp_get_wtime() + seconds : 0; }
+
+    bool is_cancelled() {
+        if (cancelled.load(memory_order_relaxed)) return true;
+        if (deadline > 0 && omp_get_wtime() >= deadline) {
+            expired = true;
+            cancelled = true;
+            return true;
+        }
+        return false;
+    }
+
+    void complete(int depth, uint64_t count = 1) {
+        if (depth > 20) return;
+        uint64_t amount = (uint64_t(1) << (60 - 3 * depth)) * count;
+        uint64_t total = done.fetch_add(amount, memory_order_relaxed) + amount;
+        int percent = (int)(100 * ((double)total / (double)(uint64_t(1) << 60)));
+        int last = reported_percent.load(memory_order_relaxed);
+        while (percent > last) {
+            if (reported_percent.compare_exchange_weak(last, percent)) {
+                progressed(percent / 100.0);
+                break;
+            }
+        }
+    }
+
+    double progress() const { return min(1.0, (double)done.load(memory_order_relaxed) / (double)(uint64_t(1) << 60)); }
+};
+
+// Contadores del recorrido por profundidad, para estimar el trabajo restante
+// (progress.h). Cada hilo suma en su propia línea de caché, sin compartirla,
+// y un hilo monitor los lee de a ratos. visited cuenta todos los nodos,
+// active los que pasaron el descarte y se subdividen.
+class TraversalCounters {
+public:
+    static const int max_depth = 22;
+
+    class alignas(64) Slot {
+    public:
+        atomic<uint64_t> visited[max_depth];
+        atomic<uint64_t> active[max_depth];
+        atomic<uint64_t> triangles;
+
+        Slot() {
+            for (int d = 0; d < max_depth; d++) visited[d] = active[d] = 0;
+            triangles = 0;
+        }
+    };
+
+    vector<Slot> slots;
+    int leaf_depth = 0;  // profundidad de las hojas del recorrido
+
+    TraversalCounters(int threads = omp_get_max_threads()) : slots(max(1, threads)) {}
+
+    // Pone los contadores en cero para una corrida; las hojas están donde las
+    // pone la condición de corte de surface_to_triangles
+    void start(Point3D start, Point3D end, double precision) {
+        for (auto& s : slots) {
+            for (int d = 0; d < max_depth; d++) s.visited[d] = s.active[d] = 0;
+            s.triangles = 0;
+        }
+        double ex = end.x - start.x, ey = end.y - start.y, ez = end.z - start.z;
+        leaf_depth = 0;
+        while (!(ex < precision || ey < precision || ez < precision) && leaf_depth + 1 < max_depth) {
+            ex /= 2; ey /= 2; ez /= 2;
+            leaf_depth++;
+        }
+    }
+
+    // Un hilo por ranura mientras haya; las sumas son atómicas por si se repiten
+    Slot& slot() {
+        static atomic<int> next{0};
+        thread_local int index = next++;
+        return slots[index % slots.size()];
+    }
+
+    void node(int depth, bool active) {
+        if (depth >= max_depth) return;
+        Slot& s = slot();
+        s.visited[depth].fetch_add(1, memory_order_relaxed);
+        if (active) s.active[depth].fetch_add(1, memory_order_relaxed);
+    }
+
+    void leaf(int depth, size_t triangles, uint64_t count = 1) {
+        if (depth >= max_depth) return;
+        Slot& s = slot();
+        s.visited[depth].fetch_add(count, memory_order_relaxed);
+        if (triangles) s.triangles.fetch_add(triangles, memory_order_relaxed);
+    }
+};
+
+// Registro de las tareas del recorrido para ver la línea de tiempo (trace.h la
+// exporta como Chrome trace). Cada hilo escribe en su propio anillo, que se
+// reserva la primera vez que lo usa y pisa los eventos más viejos al llenarse.
+// Sin tracer (nullptr en CellOptions) el costo es comparar un puntero.
+enum class TraceKind : uint8_t { Node, Leaf, Culled, Span };
+
+class TraceEvent {
+public:
+    double begin, end;       // segundos de omp_get_wtime
+    Point3D start, stop;     // extremos del nodo
+    uint32_t triangles;
+    int16_t depth;
+    TraceKind kind;
+    const char* name;        // para Span
+};
+
+class TaskTracer {
+public:
+    static const int max_threads = 256;
+
+    class Ring {
+    public:
+        vector<TraceEvent> events;
+        uint64_t written = 0;  // total; los últimos events.size() quedan
+    };
+
+    size_t capacity;  // eventos por hilo
+    double origin;
+    uint64_t id;      // distingue este tracer de otro creado después en la misma dirección
+    unique_ptr<Ring> rings[max_threads];
+    atomic<int> next_thread{0};
+
+    TaskTracer(size_t capacity = size_t(1) << 16) : capacity(max<size_t>(1, capacity)), origin(omp_get_wtime()) {
+        static atomic<uint64_t> next_id{1};
+        id = next_id++;
+    }
+
+    // Anillo del hilo que llama; nullptr si ya hay max_threads hilos (se pierde el evento)
+    Ring* ring() {
+        thread_local uint64_t owner = 0;
+        thread_local int index = -1;
+        if (owner != id) {
+            owner = id;
+            index = next_thread++;
+            if (index < max_threads) {
+                rings[index].reset(new Ring());
+                rings[index]->events.resize(capacity);
+            }
+        }
+        return index < max_threads ? rings[index].get() : nullptr;
+    }
+
+    void record(const TraceEvent& event) {
+        Ring* r = ring();
+        if (!r) return;
+        r->events[r->written % capacity] = event;
+        r->written++;
+    }
+
+    // Tramo con nombre en el hilo que llama (fases del programa)
+    void span(const char* name, double begin, double end) {
+        TraceEvent event = {begin, end, Point3D(), Point3D(), 0, -1, TraceKind::Span, name};
+        record(event);
+    }
+};
+
+// Registra la tarea del nodo al salir de su alcance
+class TraceScope {
+public:
+    TaskTracer* tracer;
+    TraceEvent event;
+
+    TraceScope(TaskTracer* tracer, Point3D start, Point3D end, int depth) : tracer(tracer) {
+        if (!tracer) return;
+        event = {omp_get_wtime(), 0, start, end, 0, (int16_t)depth, TraceKind::Node, nullptr};
+    }
+    ~TraceScope() {
+        if (!tracer) return;
+        event.end = omp_get_wtime();
+        tracer->record(event);
+    }
+    void leaf(size_t triangles) {
+        event.kind = TraceKind::Leaf;
+        event.triangles = (uint32_t)triangles;
+    }
+    void culled() { event.kind = TraceKind::Culled; }
+};
+
+// Triángulos sueltos con atributos por vértice: attribute_count valores por
+// cada esquina de triángulo, en el mismo orden que triangles. Sus búferes se
+// cuentan en MemoryCategory::Triangles.
+typedef tracked_vector<Triangle, MemoryCategory::Triangles> TriangleBuffer;
+typedef tracked_vector<float, MemoryCategory::Triangles> AttributeBuffer;
+
+class TriangleSoup {
+public:
+    TriangleBuffer triangles;
+    AttributeBuffer attributes;
+    size_t attribute_count = 0;
+};
+
+// Receptor de lotes de triángulos a medida que la extracción los produce, sin
+// juntar la malla entera. deliver se llama desde varios hilos a la vez; el lote
+// es el búfer del hilo y sólo es válido durante la llamada.
+class TriangleSink {
+public:
+    virtual ~TriangleSink() {}
+    virtual void deliver(size_t isovalue_index, const TriangleSoup& batch) = 0;
+};
+
+// Campos auxiliares (temperatura, curvatura, material...) que el núcleo
+// interpola con el mismo parámetro t que la posición del vértice. Sólo se
+// evalúan en las esquinas de celdas con cruce; los valores se añaden a out.
+class CellAttributes {
+public:
+    const vector<ScalarField>* fields = nullptr;
+    AttributeBuffer* out = nullptr;
+
+    CellAttributes() {}
+    CellAttributes(const vector<ScalarField>* fields, AttributeBuffer* out) : fields(fields), out(out) {}
+
+    bool active() const { return fields && out && !fields->empty(); }
+};
+
+// Opciones del núcleo por celda. snap es la fracción de arista dentro de la
+// cual un cruce se pega a la esquina (0 = interpolación exacta); con snap > 0
+// los triángulos aplastados se descartan antes de salir de la celda.
+class CellOptions {
+public:
+    CellTable table = CellTable::Classic;
+    double snap = 0;
+    double isovalue = 0;             // la superficie es f = isovalue
+    CornerSink* samples = nullptr;  // recibe los valores de esquina de cada hoja
+    const vector<ScalarField>* attributes = nullptr;  // campos auxiliares por vértice
+    TraversalControl* control = nullptr;              // cancelación y avance del recorrido
+    TraversalCounters* counters = nullptr;            // nodos por profundidad para el avance estimado
+    TaskTracer* tracer = nullptr;                     // línea de tiempo de las tareas
+
+    CellOptions() {}
+    CellOptions(CellTable table, double snap = 0, double isovalue = 0) : table(table), snap(snap), isovalue(isovalue) {}
+};
+
+// Parámetro del cruce con el isovalor sobre la arista (0 en p1, 1 en p2).
+// snap: si el cruce queda a menos de esa fracción de la arista de una
+// esquina, se devuelve la esquina exacta. Así los triángulos que se
+// aplastan contra un vértice de la malla repiten puntos y se pueden
+// descartar en la misma celda.
+inline double edge_parameter(double f1, double f2, double isovalue = 0, double snap = 0) {
+    // punto medio
+    if (abs(f2 - f1) < 1e-9) return 0.5;
+    double t = (isovalue - f1) / (f2 - f1);
+    if (t < snap) return 0;
+    if (t > 1 - snap) return 1;
+    return t;
+}
+
+inline Point3D point_on_edge(Point3D p1, Point3D p2, double t) {
+    if (t == 0) return p1;
+    if (t == 1) return p2;
+    return Point3D(p1.x + t * (p2.x - p1.x), p1.y + t * (p2.y - p1.y), p1.z + t * (p2.z - p1.z));
+}
+
+inline Point3D interpolate_3d(Point3D p1, Point3D p2, double f1, double f2, double snap = 0, double isovalue = 0) {
+    double t = edge_parameter(f1, f2, isovalue, snap);
+    if (t == 0) return p1;
+    if (t == 1) return p2;
+    return Point3D(p1.x + t * (p2.x - p1.x), p1.y + t * (p2.y - p1.y), p1.z + t * (p2.z - p1.z));
+}
+
+inline void cell_corners(Point3D start, Point3D end, Point3D vertices[8]) {
+    vertices[0] = Point3D(start.x, start.y, start.z); vertices[1] = Point3D(end.x, start.y, start.z);
+    vertices[2] = Point3D(end.x, end.y, start.z);     vertices[3] = Point3D(start.x, end.y, start.z);
+    vertices[4] = Point3D(start.x, start.y, end.z);   vertices[5] = Point3D(end.x, start.y, end.z);
+    vertices[6] = Point3D(end.x, end.y, end.z);       vertices[7] = Point3D(start.x, end.y, end.z);
+}
+
+// Atributos de una celda con cruce: values[i * count + a] es el campo a en la
+// esquina i; las filas 8..19 guardan los valores interpolados en las aristas y
+// la 20 el centro de los lazos de MC33.
+class CellAttributeValues {
+public:
+    size_t count = 0;
+    vector<double> values;
+
+    CellAttributeValues(const Point3D vertices[8], const vector<ScalarField>& fields) : count(fields.size()), values(21 * count) {
+        for (int i = 0; i < 8; i++) {
+            for (size_t a = 0; a < count; a++) values[i * count + a] = fields[a](vertices[i].x, vertices[i].y, vertices[i].z);
+        }
+    }
+
+    double* row(int r) { return &values[r * count]; }
+
+    void interpolate_edge(int edge, int c1, int c2, double t) {
+        double* out = row(8 + edge);
+        const double* a = row(c1);
+        const double* b = row(c2);
+        for (size_t k = 0; k < count; k++) out[k] = a[k] + t * (b[k] - a[k]);
+    }
+
+    // rows: índice de fila de cada vértice del triángulo
+    void append(AttributeBuffer& out, int r1, int r2, int r3) {
+        for (int r : {r1, r2, r3}) {
+            const double* v = row(r);
+            for (size_t k = 0; k < count; k++) out.push_back((float)v[k]);
+        }
+    }
+};
+
+// Triangulación de una celda con los valores de esquina ya evaluados
+inline vector<Triangle> marching_cubes_cell(const Point3D vertices[8], const double values[8], double isovalue = 0, double snap = 0,
+                                            const CellAttributes& attributes = CellAttributes()) {
+    int config = 0;
+    for (int i = 0; i < 8; i++) if (values[i] < isovalue) config |= (1 << i);
+
+
+    static const int edgeTable[256]={
+        0x0  , 0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c,
+        0x80c, 0x905, 0xa0f, 0xb06, 0xc0a, 0xd03, 0xe09, 0xf00,
+        0x190, 0x99 , 0x393, 0x29a, 0x596, 0x49f, 0x795, 0x69c,
+        0x99c, 0x895, 0xb9f, 0xa96, 0xd9a, 0xc93, 0xf99, 0xe90,
+        0x230, 0x339, 0x33 , 0x13a, 0x636, 0x73f, 0x435, 0x53c,
+        0xa3c, 0xb35, 0x83f, 0x936, 0xe3a, 0xf33, 0xc39, 0xd30,
+        0x3a0, 0x2a9, 0x1a3, 0xaa , 0x7a6, 0x6af, 0x5a5, 0x4ac,
+        0xbac, 0xaa5, 0x9af, 0x8a6, 0xfaa, 0xea3, 0xda9, 0xca0,
+        0x460, 0x569, 0x663, 0x76a, 0x66 , 0x16f, 0x265, 0x36c,
+        0xc6c, 0xd65, 0xe6f, 0xf66, 0x86a, 0x963, 0xa69, 0xb60,
+        0x5f0, 0x4f9, 0x7f3, 0x6fa, 0x1f6, 0xff , 0x3f5, 0x2fc,
+        0xdfc, 0xcf5, 0xfff, 0xef6, 0x9fa, 0x8f3, 0xbf9, 0xaf0,
+        0x650, 0x759, 0x453, 0x55a, 0x256, 0x35f, 0x55 , 0x15c,
+        0xe5c, 0xf55, 0xc5f, 0xd56, 0xa5a, 0xb53, 0x859, 0x950,
+        0x7c0, 0x6c9, 0x5c3, 0x4ca, 0x3c6, 0x2cf, 0x1c5, 0xcc ,
+        0xfcc, 0xec5, 0xdcf, 0xcc6, 0xbca, 0xac3, 0x9c9, 0x8c0,
+        0x8c0, 0x9c9, 0xac3, 0xbca, 0xcc6, 0xdcf, 0xec5, 0xfcc,
+        0xcc , 0x1c5, 0x2cf, 0x3c6, 0x4ca, 0x5c3, 0x6c9, 0x7c0,
+        0x950, 0x859, 0xb53, 0xa5a, 0xd56, 0xc5f, 0xf55, 0xe5c,
+        0x15c, 0x55 , 0x35f, 0x256, 0x55a, 0x453, 0x759, 0x650,
+        0xaf0, 0xbf9, 0x8f3, 0x9fa, 0xef6, 0xfff, 0xcf5, 0xdfc,
+        0x2fc, 0x3f5, 0xff , 0x1f6, 0x6fa, 0x7f3, 0x4f9, 0x5f0,
+        0xb60, 0xa69, 0x963, 0x86a, 0xf66, 0xe6f, 0xd65, 0xc6c,
+        0x36c, 0x265, 0x16f, 0x66 , 0x76a, 0x663, 0x569, 0x460,
+        0xca0, 0xda9, 0xea3, 0xfaa, 0x8a6, 0x9af, 0xaa5, 0xbac,
+        0x4ac, 0x5a5, 0x6af, 0x7a6, 0xaa , 0x1a3, 0x2a9, 0x3a0,
+        0xd30, 0xc39, 0xf33, 0xe3a, 0x936, 0x83f, 0xb35, 0xa3c,
+        0x53c, 0x435, 0x73f, 0x636, 0x13a, 0x33 , 0x339, 0x230,
+        0xe90, 0xf99, 0xc93, 0xd9a, 0xa96, 0xb9f, 0x895, 0x99c,
+        0x69c, 0x795, 0x49f, 0x596, 0x29a, 0x393, 0x99 , 0x190,
+        0xf00, 0xe09, 0xd03, 0xc0a, 0xb06, 0xa0f, 0x905, 0x80c,
+        0x70c, 0x605, 0x50f, 0x406, 0x30a, 0x203, 0x109, 0x0   };
+        static const int triTable[256][16] =
+        {{-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 1, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 8, 3, 9, 8, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 3, 1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 2, 10, 0, 2, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {2, 8, 3, 2, 10, 8, 10, 9, 8, -1, -1, -1, -1, -1, -1, -1},
+        {3, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 11, 2, 8, 11, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 9, 0, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 11, 2, 1, 9, 11, 9, 8, 11, -1, -1, -1, -1, -1, -1, -1},
+        {3, 10, 1, 11, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 10, 1, 0, 8, 10, 8, 11, 10, -1, -1, -1, -1, -1, -1, -1},
+        {3, 9, 0, 3, 11, 9, 11, 10, 9, -1, -1, -1, -1, -1, -1, -1},
+        {9, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 3, 0, 7, 3, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 1, 9, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 1, 9, 4, 7, 1, 7, 3, 1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 10, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {3, 4, 7, 3, 0, 4, 1, 2, 10, -1, -1, -1, -1, -1, -1, -1},
+        {9, 2, 10, 9, 0, 2, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
+        {2, 10, 9, 2, 9, 7, 2, 7, 3, 7, 9, 4, -1, -1, -1, -1},
+        {8, 4, 7, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {11, 4, 7, 11, 2, 4, 2, 0, 4, -1, -1, -1, -1, -1, -1, -1},
+        {9, 0, 1, 8, 4, 7, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
+        {4, 7, 11, 9, 4, 11, 9, 11, 2, 9, 2, 1, -1, -1, -1, -1},
+        {3, 10, 1, 3, 11, 10, 7, 8, 4, -1, -1, -1, -1, -1, -1, -1},
+        {1, 11, 10, 1, 4, 11, 1, 0, 4, 7, 11, 4, -1, -1, -1, -1},
+        {4, 7, 8, 9, 0, 11, 9, 11, 10, 11, 0, 3, -1, -1, -1, -1},
+        {4, 7, 11, 4, 11, 9, 9, 11, 10, -1, -1, -1, -1, -1, -1, -1},
+        {9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 5, 4, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 5, 4, 1, 5, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {8, 5, 4, 8, 3, 5, 3, 1, 5, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 10, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {3, 0, 8, 1, 2, 10, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
+        {5, 2, 10, 5, 4, 2, 4, 0, 2, -1, -1, -1, -1, -1, -1, -1},
+        {2, 10, 5, 3, 2, 5, 3, 5, 4, 3, 4, 8, -1, -1, -1, -1},
+        {9, 5, 4, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 11, 2, 0, 8, 11, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
+        {0, 5, 4, 0, 1, 5, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
+        {2, 1, 5, 2, 5, 8, 2, 8, 11, 4, 8, 5, -1, -1, -1, -1},
+        {10, 3, 11, 10, 1, 3, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1},
+        {4, 9, 5, 0, 8, 1, 8, 10, 1, 8, 11, 10, -1, -1, -1, -1},
+        {5, 4, 0, 5, 0, 11, 5, 11, 10, 11, 0, 3, -1, -1, -1, -1},
+        {5, 4, 8, 5, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1},
+        {9, 7, 8, 5, 7, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 3, 0, 9, 5, 3, 5, 7, 3, -1, -1, -1, -1, -1, -1, -1},
+        {0, 7, 8, 0, 1, 7, 1, 5, 7, -1, -1, -1, -1, -1, -1, -1},
+        {1, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 7, 8, 9, 5, 7, 10, 1, 2, -1, -1, -1, -1, -1, -1, -1},
+        {10, 1, 2, 9, 5, 0, 5, 3, 0, 5, 7, 3, -1, -1, -1, -1},
+        {8, 0, 2, 8, 2, 5, 8, 5, 7, 10, 5, 2, -1, -1, -1, -1},
+        {2, 10, 5, 2, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1},
+        {7, 9, 5, 7, 8, 9, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1},
+        {9, 5, 7, 9, 7, 2, 9, 2, 0, 2, 7, 11, -1, -1, -1, -1},
+        {2, 3, 11, 0, 1, 8, 1, 7, 8, 1, 5, 7, -1, -1, -1, -1},
+        {11, 2, 1, 11, 1, 7, 7, 1, 5, -1, -1, -1, -1, -1, -1, -1},
+        {9, 5, 8, 8, 5, 7, 10, 1, 3, 10, 3, 11, -1, -1, -1, -1},
+        {5, 7, 0, 5, 0, 9, 7, 11, 0, 1, 0, 10, 11, 10, 0, -1},
+        {11, 10, 0, 11, 0, 3, 10, 5, 0, 8, 0, 7, 5, 7, 0, -1},
+        {11, 10, 5, 7, 11, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 3, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 0, 1, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 8, 3, 1, 9, 8, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
+        {1, 6, 5, 2, 6, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 6, 5, 1, 2, 6, 3, 0, 8, -1, -1, -1, -1, -1, -1, -1},
+        {9, 6, 5, 9, 0, 6, 0, 2, 6, -1, -1, -1, -1, -1, -1, -1},
+        {5, 9, 8, 5, 8, 2, 5, 2, 6, 3, 2, 8, -1, -1, -1, -1},
+        {2, 3, 11, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {11, 0, 8, 11, 2, 0, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
+        {0, 1, 9, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
+        {5, 10, 6, 1, 9, 2, 9, 11, 2, 9, 8, 11, -1, -1, -1, -1},
+        {6, 3, 11, 6, 5, 3, 5, 1, 3, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 11, 0, 11, 5, 0, 5, 1, 5, 11, 6, -1, -1, -1, -1},
+        {3, 11, 6, 0, 3, 6, 0, 6, 5, 0, 5, 9, -1, -1, -1, -1},
+        {6, 5, 9, 6, 9, 11, 11, 9, 8, -1, -1, -1, -1, -1, -1, -1},
+        {5, 10, 6, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 3, 0, 4, 7, 3, 6, 5, 10, -1, -1, -1, -1, -1, -1, -1},
+        {1, 9, 0, 5, 10, 6, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
+        {10, 6, 5, 1, 9, 7, 1, 7, 3, 7, 9, 4, -1, -1, -1, -1},
+        {6, 1, 2, 6, 5, 1, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 5, 5, 2, 6, 3, 0, 4, 3, 4, 7, -1, -1, -1, -1},
+        {8, 4, 7, 9, 0, 5, 0, 6, 5, 0, 2, 6, -1, -1, -1, -1},
+        {7, 3, 9, 7, 9, 4, 3, 2, 9, 5, 9, 6, 2, 6, 9, -1},
+        {3, 11, 2, 7, 8, 4, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
+        {5, 10, 6, 4, 7, 2, 4, 2, 0, 2, 7, 11, -1, -1, -1, -1},
+        {0, 1, 9, 4, 7, 8, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1},
+        {9, 2, 1, 9, 11, 2, 9, 4, 11, 7, 11, 4, 5, 10, 6, -1},
+        {8, 4, 7, 3, 11, 5, 3, 5, 1, 5, 11, 6, -1, -1, -1, -1},
+        {5, 1, 11, 5, 11, 6, 1, 0, 11, 7, 11, 4, 0, 4, 11, -1},
+        {0, 5, 9, 0, 6, 5, 0, 3, 6, 11, 6, 3, 8, 4, 7, -1},
+        {6, 5, 9, 6, 9, 11, 4, 7, 9, 7, 11, 9, -1, -1, -1, -1},
+        {10, 4, 9, 6, 4, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 10, 6, 4, 9, 10, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1},
+        {10, 0, 1, 10, 6, 0, 6, 4, 0, -1, -1, -1, -1, -1, -1, -1},
+        {8, 3, 1, 8, 1, 6, 8, 6, 4, 6, 1, 10, -1, -1, -1, -1},
+        {1, 4, 9, 1, 2, 4, 2, 6, 4, -1, -1, -1, -1, -1, -1, -1},
+        {3, 0, 8, 1, 2, 9, 2, 4, 9, 2, 6, 4, -1, -1, -1, -1},
+        {0, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {8, 3, 2, 8, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1},
+        {10, 4, 9, 10, 6, 4, 11, 2, 3, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 2, 2, 8, 11, 4, 9, 10, 4, 10, 6, -1, -1, -1, -1},
+        {3, 11, 2, 0, 1, 6, 0, 6, 4, 6, 1, 10, -1, -1, -1, -1},
+        {6, 4, 1, 6, 1, 10, 4, 8, 1, 2, 1, 11, 8, 11, 1, -1},
+        {9, 6, 4, 9, 3, 6, 9, 1, 3, 11, 6, 3, -1, -1, -1, -1},
+        {8, 11, 1, 8, 1, 0, 11, 6, 1, 9, 1, 4, 6, 4, 1, -1},
+        {3, 11, 6, 3, 6, 0, 0, 6, 4, -1, -1, -1, -1, -1, -1, -1},
+        {6, 4, 8, 11, 6, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {7, 10, 6, 7, 8, 10, 8, 9, 10, -1, -1, -1, -1, -1, -1, -1},
+        {0, 7, 3, 0, 10, 7, 0, 9, 10, 6, 7, 10, -1, -1, -1, -1},
+        {10, 6, 7, 1, 10, 7, 1, 7, 8, 1, 8, 0, -1, -1, -1, -1},
+        {10, 6, 7, 10, 7, 1, 1, 7, 3, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 6, 1, 6, 8, 1, 8, 9, 8, 6, 7, -1, -1, -1, -1},
+        {2, 6, 9, 2, 9, 1, 6, 7, 9, 0, 9, 3, 7, 3, 9, -1},
+        {7, 8, 0, 7, 0, 6, 6, 0, 2, -1, -1, -1, -1, -1, -1, -1},
+        {7, 3, 2, 6, 7, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {2, 3, 11, 10, 6, 8, 10, 8, 9, 8, 6, 7, -1, -1, -1, -1},
+        {2, 0, 7, 2, 7, 11, 0, 9, 7, 6, 7, 10, 9, 10, 7, -1},
+        {1, 8, 0, 1, 7, 8, 1, 10, 7, 6, 7, 10, 2, 3, 11, -1},
+        {11, 2, 1, 11, 1, 7, 10, 6, 1, 6, 7, 1, -1, -1, -1, -1},
+        {8, 9, 6, 8, 6, 7, 9, 1, 6, 11, 6, 3, 1, 3, 6, -1},
+        {0, 9, 1, 11, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {7, 8, 0, 7, 0, 6, 3, 11, 0, 11, 6, 0, -1, -1, -1, -1},
+        {7, 11, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {3, 0, 8, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 1, 9, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {8, 1, 9, 8, 3, 1, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
+        {10, 1, 2, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 10, 3, 0, 8, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+        {2, 9, 0, 2, 10, 9, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
+        {6, 11, 7, 2, 10, 3, 10, 8, 3, 10, 9, 8, -1, -1, -1, -1},
+        {7, 2, 3, 6, 2, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {7, 0, 8, 7, 6, 0, 6, 2, 0, -1, -1, -1, -1, -1, -1, -1},
+        {2, 7, 6, 2, 3, 7, 0, 1, 9, -1, -1, -1, -1, -1, -1, -1},
+        {1, 6, 2, 1, 8, 6, 1, 9, 8, 8, 7, 6, -1, -1, -1, -1},
+        {10, 7, 6, 10, 1, 7, 1, 3, 7, -1, -1, -1, -1, -1, -1, -1},
+        {10, 7, 6, 1, 7, 10, 1, 8, 7, 1, 0, 8, -1, -1, -1, -1},
+        {0, 3, 7, 0, 7, 10, 0, 10, 9, 6, 10, 7, -1, -1, -1, -1},
+        {7, 6, 10, 7, 10, 8, 8, 10, 9, -1, -1, -1, -1, -1, -1, -1},
+        {6, 8, 4, 11, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {3, 6, 11, 3, 0, 6, 0, 4, 6, -1, -1, -1, -1, -1, -1, -1},
+        {8, 6, 11, 8, 4, 6, 9, 0, 1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 4, 6, 9, 6, 3, 9, 3, 1, 11, 3, 6, -1, -1, -1, -1},
+        {6, 8, 4, 6, 11, 8, 2, 10, 1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 10, 3, 0, 11, 0, 6, 11, 0, 4, 6, -1, -1, -1, -1},
+        {4, 11, 8, 4, 6, 11, 0, 2, 9, 2, 10, 9, -1, -1, -1, -1},
+        {10, 9, 3, 10, 3, 2, 9, 4, 3, 11, 3, 6, 4, 6, 3, -1},
+        {8, 2, 3, 8, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1},
+        {0, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 9, 0, 2, 3, 4, 2, 4, 6, 4, 3, 8, -1, -1, -1, -1},
+        {1, 9, 4, 1, 4, 2, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1},
+        {8, 1, 3, 8, 6, 1, 8, 4, 6, 6, 10, 1, -1, -1, -1, -1},
+        {10, 1, 0, 10, 0, 6, 6, 0, 4, -1, -1, -1, -1, -1, -1, -1},
+        {4, 6, 3, 4, 3, 8, 6, 10, 3, 0, 3, 9, 10, 9, 3, -1},
+        {10, 9, 4, 6, 10, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 9, 5, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 3, 4, 9, 5, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
+        {5, 0, 1, 5, 4, 0, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
+        {11, 7, 6, 8, 3, 4, 3, 5, 4, 3, 1, 5, -1, -1, -1, -1},
+        {9, 5, 4, 10, 1, 2, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
+        {6, 11, 7, 1, 2, 10, 0, 8, 3, 4, 9, 5, -1, -1, -1, -1},
+        {7, 6, 11, 5, 4, 10, 4, 2, 10, 4, 0, 2, -1, -1, -1, -1},
+        {3, 4, 8, 3, 5, 4, 3, 2, 5, 10, 5, 2, 11, 7, 6, -1},
+        {7, 2, 3, 7, 6, 2, 5, 4, 9, -1, -1, -1, -1, -1, -1, -1},
+        {9, 5, 4, 0, 8, 6, 0, 6, 2, 6, 8, 7, -1, -1, -1, -1},
+        {3, 6, 2, 3, 7, 6, 1, 5, 0, 5, 4, 0, -1, -1, -1, -1},
+        {6, 2, 8, 6, 8, 7, 2, 1, 8, 4, 8, 5, 1, 5, 8, -1},
+        {9, 5, 4, 10, 1, 6, 1, 7, 6, 1, 3, 7, -1, -1, -1, -1},
+        {1, 6, 10, 1, 7, 6, 1, 0, 7, 8, 7, 0, 9, 5, 4, -1},
+        {4, 0, 10, 4, 10, 5, 0, 3, 10, 6, 10, 7, 3, 7, 10, -1},
+        {7, 6, 10, 7, 10, 8, 5, 4, 10, 4, 8, 10, -1, -1, -1, -1},
+        {6, 9, 5, 6, 11, 9, 11, 8, 9, -1, -1, -1, -1, -1, -1, -1},
+        {3, 6, 11, 0, 6, 3, 0, 5, 6, 0, 9, 5, -1, -1, -1, -1},
+        {0, 11, 8, 0, 5, 11, 0, 1, 5, 5, 6, 11, -1, -1, -1, -1},
+        {6, 11, 3, 6, 3, 5, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 10, 9, 5, 11, 9, 11, 8, 11, 5, 6, -1, -1, -1, -1},
+        {0, 11, 3, 0, 6, 11, 0, 9, 6, 5, 6, 9, 1, 2, 10, -1},
+        {11, 8, 5, 11, 5, 6, 8, 0, 5, 10, 5, 2, 0, 2, 5, -1},
+        {6, 11, 3, 6, 3, 5, 2, 10, 3, 10, 5, 3, -1, -1, -1, -1},
+        {5, 8, 9, 5, 2, 8, 5, 6, 2, 3, 8, 2, -1, -1, -1, -1},
+        {9, 5, 6, 9, 6, 0, 0, 6, 2, -1, -1, -1, -1, -1, -1, -1},
+        {1, 5, 8, 1, 8, 0, 5, 6, 8, 3, 8, 2, 6, 2, 8, -1},
+        {1, 5, 6, 2, 1, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 3, 6, 1, 6, 10, 3, 8, 6, 5, 6, 9, 8, 9, 6, -1},
+        {10, 1, 0, 10, 0, 6, 9, 5, 0, 5, 6, 0, -1, -1, -1, -1},
+        {0, 3, 8, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {10, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {11, 5, 10, 7, 5, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {11, 5, 10, 11, 7, 5, 8, 3, 0, -1, -1, -1, -1, -1, -1, -1},
+        {5, 11, 7, 5, 10, 11, 1, 9, 0, -1, -1, -1, -1, -1, -1, -1},
+        {10, 7, 5, 10, 11, 7, 9, 8, 1, 8, 3, 1, -1, -1, -1, -1},
+        {11, 1, 2, 11, 7, 1, 7, 5, 1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 3, 1, 2, 7, 1, 7, 5, 7, 2, 11, -1, -1, -1, -1},
+        {9, 7, 5, 9, 2, 7, 9, 0, 2, 2, 11, 7, -1, -1, -1, -1},
+        {7, 5, 2, 7, 2, 11, 5, 9, 2, 3, 2, 8, 9, 8, 2, -1},
+        {2, 5, 10, 2, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1},
+        {8, 2, 0, 8, 5, 2, 8, 7, 5, 10, 2, 5, -1, -1, -1, -1},
+        {9, 0, 1, 5, 10, 3, 5, 3, 7, 3, 10, 2, -1, -1, -1, -1},
+        {9, 8, 2, 9, 2, 1, 8, 7, 2, 10, 2, 5, 7, 5, 2, -1},
+        {1, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 7, 0, 7, 1, 1, 7, 5, -1, -1, -1, -1, -1, -1, -1},
+        {9, 0, 3, 9, 3, 5, 5, 3, 7, -1, -1, -1, -1, -1, -1, -1},
+        {9, 8, 7, 5, 9, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {5, 8, 4, 5, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1},
+        {5, 0, 4, 5, 11, 0, 5, 10, 11, 11, 3, 0, -1, -1, -1, -1},
+        {0, 1, 9, 8, 4, 10, 8, 10, 11, 10, 4, 5, -1, -1, -1, -1},
+        {10, 11, 4, 10, 4, 5, 11, 3, 4, 9, 4, 1, 3, 1, 4, -1},
+        {2, 5, 1, 2, 8, 5, 2, 11, 8, 4, 5, 8, -1, -1, -1, -1},
+        {0, 4, 11, 0, 11, 3, 4, 5, 11, 2, 11, 1, 5, 1, 11, -1},
+        {0, 2, 5, 0, 5, 9, 2, 11, 5, 4, 5, 8, 11, 8, 5, -1},
+        {9, 4, 5, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {2, 5, 10, 3, 5, 2, 3, 4, 5, 3, 8, 4, -1, -1, -1, -1},
+        {5, 10, 2, 5, 2, 4, 4, 2, 0, -1, -1, -1, -1, -1, -1, -1},
+        {3, 10, 2, 3, 5, 10, 3, 8, 5, 4, 5, 8, 0, 1, 9, -1},
+        {5, 10, 2, 5, 2, 4, 1, 9, 2, 9, 4, 2, -1, -1, -1, -1},
+        {8, 4, 5, 8, 5, 3, 3, 5, 1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 4, 5, 1, 0, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {8, 4, 5, 8, 5, 3, 9, 0, 5, 0, 3, 5, -1, -1, -1, -1},
+        {9, 4, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 11, 7, 4, 9, 11, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1},
+        {0, 8, 3, 4, 9, 7, 9, 11, 7, 9, 10, 11, -1, -1, -1, -1},
+        {1, 10, 11, 1, 11, 4, 1, 4, 0, 7, 4, 11, -1, -1, -1, -1},
+        {3, 1, 4, 3, 4, 8, 1, 10, 4, 7, 4, 11, 10, 11, 4, -1},
+        {4, 11, 7, 9, 11, 4, 9, 2, 11, 9, 1, 2, -1, -1, -1, -1},
+        {9, 7, 4, 9, 11, 7, 9, 1, 11, 2, 11, 1, 0, 8, 3, -1},
+        {11, 7, 4, 11, 4, 2, 2, 4, 0, -1, -1, -1, -1, -1, -1, -1},
+        {11, 7, 4, 11, 4, 2, 8, 3, 4, 3, 2, 4, -1, -1, -1, -1},
+        {2, 9, 10, 2, 7, 9, 2, 3, 7, 7, 4, 9, -1, -1, -1, -1},
+        {9, 10, 7, 9, 7, 4, 10, 2, 7, 8, 7, 0, 2, 0, 7, -1},
+        {3, 7, 10, 3, 10, 2, 7, 4, 10, 1, 10, 0, 4, 0, 10, -1},
+        {1, 10, 2, 8, 7, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 9, 1, 4, 1, 7, 7, 1, 3, -1, -1, -1, -1, -1, -1, -1},
+        {4, 9, 1, 4, 1, 7, 0, 8, 1, 8, 7, 1, -1, -1, -1, -1},
+        {4, 0, 3, 7, 4, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {9, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {3, 0, 9, 3, 9, 11, 11, 9, 10, -1, -1, -1, -1, -1, -1, -1},
+        {0, 1, 10, 0, 10, 8, 8, 10, 11, -1, -1, -1, -1, -1, -1, -1},
+        {3, 1, 10, 11, 3, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 2, 11, 1, 11, 9, 9, 11, 8, -1, -1, -1, -1, -1, -1, -1},
+        {3, 0, 9, 3, 9, 11, 1, 2, 9, 2, 11, 9, -1, -1, -1, -1},
+        {0, 2, 11, 8, 0, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {3, 2, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {2, 3, 8, 2, 8, 10, 10, 8, 9, -1, -1, -1, -1, -1, -1, -1},
+        {9, 10, 2, 0, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {2, 3, 8, 2, 8, 10, 0, 1, 8, 1, 10, 8, -1, -1, -1, -1},
+        {1, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {1, 3, 8, 9, 1, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 9, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+        {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}};
+ 
+ 
+    if (edgeTable[config] == 0) return {};
+ 
+    int edges[12][2] = {{0,1},{1,2},{2,3},{3,0},{4,5},{5,6},{6,7},{7,4},{0,4},{1,5},{2,6},{3,7}};
+    Point3D edge_points[12];
+ 
+    double edge_t[12];
+    for (int e = 0; e < 12; e++) {
+        if (!(edgeTable[config] & (1 << e))) continue;
+        edge_t[e] = edge_parameter(values[edges[e][0]], values[edges[e][1]], isovalue, snap);
+        edge_points[e] = point_on_edge(vertices[edges[e][0]], vertices[edges[e][1]], edge_t[e]);
+    }
+
+    unique_ptr<CellAttributeValues> extra;
+    if (attributes.active()) {
+        extra.reset(new CellAttributeValues(vertices, *attributes.fields));
+        for (int e = 0; e < 12; e++) {
+            if (edgeTable[config] & (1 << e)) extra->interpolate_edge(e, edges[e][0], edges[e][1], edge_t[e]);
+        }
+    }
+ 
+    vector<Triangle> triangles;
+    for (int i = 0; triTable[config][i] != -1; i += 3) {
+        Triangle triangle(
+            edge_points[triTable[config][i]],
+            edge_points[triTable[config][i+1]],
+            edge_points[triTable[config][i+2]]
+        );
+        if (snap > 0 && triangle.collapsed()) continue;
+        triangles.push_back(triangle);
+        if (extra) extra->append(*attributes.out, 8 + triTable[config][i], 8 + triTable[config][i+1], 8 + triTable[config][i+2]);
+    }
+ 
+    return triangles;
+}
+
+// Una celda. Con options.attributes, los valores interpolados de cada vértice
+// se añaden a attributes_out (options.attributes->size() por vértice); sin
+// búfer los campos auxiliares no se evalúan.
+inline vector<Triangle> marching_cubes(Point3D start, Point3D end, const ScalarField& f, const CellOptions& options = CellOptions(),
+                                       AttributeBuffer* attributes_out = nullptr) {
+    Point3D vertices[8];
+    cell_corners(start, end, vertices);
+    double values[8];
+    f.evaluate(vertices, values, 8);
+    if (options.samples) options.samples->record(vertices, values);
+    return marching_cubes_cell(vertices, values, options.isovalue, options.snap, CellAttributes(options.attributes, attributes_out));
+}
+
+// Variante con decisor asintótico (Nielson-Hamann, la base de MC33).
+// La tabla clásica triangula igual las caras ambiguas sin mirar los valores,
+// así que dos celdas vecinas pueden cerrar la cara de forma distinta y dejar
+// agujeros. Aquí cada cara ambigua se resuelve con el valor del punto silla
+// del bilineal y la triangulación sale de una tabla extendida indexada por
+// (configuración, decisiones de las caras ambiguas), generada en compilación.
+namespace mc33 {
+
+// Esquinas de cada cara en sentido antihorario vistas desde fuera del cubo
+constexpr int face_corners[6][4] = {
+    {0, 3, 2, 1}, {4, 5, 6, 7}, {0, 1, 5, 4}, {3, 7, 6, 2}, {0, 4, 7, 3}, {1, 2, 6, 5}
+};
+constexpr int edge_corners[12][2] = {
+    {0,1},{1,2},{2,3},{3,0},{4,5},{5,6},{6,7},{7,4},{0,4},{1,5},{2,6},{3,7}
+};
+// Cada caso guarda sus lazos como [largo | centro << 4, aristas...], terminado en 0.
+// A lo sumo 4 lazos con 12 aristas en total.
+constexpr int max_entry = 18;
+
+constexpr int corner_edge(int a, int b) {
+    for (int e = 0; e < 12; e++) {
+        if ((edge_corners[e][0] == a && edge_corners[e][1] == b) ||
+            (edge_corners[e][0] == b && edge_corners[e][1] == a)) return e;
+    }
+    return -1;
+}
+
+constexpr bool is_negative(int config, int corner) { return (config >> corner) & 1; }
+
+constexpr bool face_ambiguous(int config, int face) {
+    bool s0 = is_negative(config, face_corners[face][0]), s1 = is_negative(config, face_corners[face][1]);
+    bool s2 = is_negative(config, face_corners[face][2]), s3 = is_negative(config, face_corners[face][3]);
+    return s0 == s2 && s1 == s3 && s0 != s1;
+}
+
+constexpr int ambiguous_mask(int config) {
+    int mask = 0;
+    for (int face = 0; face < 6; face++) if (face_ambiguous(config, face)) mask |= 1 << face;
+    return mask;
+}
+
+constexpr int popcount6(int mask) {
+    int n = 0;
+    for (int b = 0; b < 6; b++) n += (mask >> b) & 1;
+    return n;
+}
+
+constexpr int total_cases() {
+    int total = 0;
+    for (int config = 0; config < 256; config++) total += 1 << popcount6(ambiguous_mask(config));
+    return total;
+}
+
+struct Tables {
+    unsigned char ambiguous_faces[256];
+    unsigned short offset[256];
+    unsigned char loops[total_cases()][max_entry];
+};
+
+// Segmentos dirigidos sobre la cara de modo que lo negativo quede a la
+// izquierda visto desde fuera; al encadenarlos la normal apunta hacia lo
+// negativo, igual que la tabla clásica.
+constexpr void build_case(int config, int decisions, unsigned char* out) {
+    int next[12] = {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+    int segment_face[12] = {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+    int ambiguous_index = 0;
+
+    for (int face = 0; face < 6; face++) {
+        bool negative[4] = {false, false, false, false};
+        int edge[4] = {0, 0, 0, 0};
+        int crossings = 0;
+        for (int q = 0; q < 4; q++) {
+            negative[q] = is_negative(config, face_corners[face][q]);
+            edge[q] = corner_edge(face_corners[face][q], face_corners[face][(q + 1) % 4]);
+        }
+        for (int q = 0; q < 4; q++) if (negative[q] != negative[(q + 1) % 4]) crossings++;
+
+        if (crossings == 2) {
+            int a = -1, b = -1;
+            for (int q = 0; q < 4; q++) {
+                if (negative[q] == negative[(q + 1) % 4]) continue;
+                if (a < 0) a = q; else b = q;
+            }
+            // Las esquinas a+1..b quedan separadas del resto
+            int from = negative[(a + 1) % 4] ? edge[b] : edge[a];
+            next[from] = negative[(a + 1) % 4] ? edge[a] : edge[b];
+            segment_face[from] = face;
+        } else if (crossings == 4) {
+            bool negatives_joined = (decisions >> ambiguous_index) & 1;
+            ambiguous_index++;
+            for (int q = 0; q < 4; q++) {
+                // Se recortan las esquinas del signo que queda separado
+                if (negative[q] == negatives_joined) continue;
+                int before = edge[(q + 3) % 4], after = edge[q];
+                int from = negative[q] ? after : before;
+                next[from] = negative[q] ? before : after;
+                segment_face[from] = face;
+            }
+        }
+    }
+
+    int count = 0;
+    bool visited[12] = {false, false, false, false, false, false, false, false, false, false, false, false};
+    for (int e = 0; e < 12; e++) {
+        if (next[e] < 0 || visited[e]) continue;
+        int header = count++;
+        int length = 0, faces_seen = 0;
+        bool needs_center = false;
+        for (int cur = e; !visited[cur]; cur = next[cur]) {
+            visited[cur] = true;
+            out[count++] = (unsigned char)cur;
+            length++;
+            if ((faces_seen >> segment_face[cur]) & 1) needs_center = true;
+            faces_seen |= 1 << segment_face[cur];
+        }
+        // Si el lazo pasa dos veces por una cara ambigua, un abanico desde un
+        // vértice del lazo dejaría triángulos sobre la cara, repetidos por la
+        // celda vecina; en ese caso se triangula desde el centro del lazo.
+        out[header] = (unsigned char)(length | (needs_center ? 16 : 0));
+    }
+    out[count] = 0;
+}
+
+constexpr Tables build_tables() {
+    Tables t{};
+    int offset = 0;
+    for (int config = 0; config < 256; config++) {
+        int mask = ambiguous_mask(config);
+        t.ambiguous_faces[config] = (unsigned char)mask;
+        t.offset[config] = (unsigned short)offset;
+        for (int decisions = 0; decisions < (1 << popcount6(mask)); decisions++) {
+            build_case(config, decisions, t.loops[offset + decisions]);
+        }
+        offset += 1 << popcount6(mask);
+    }
+    return t;
+}
+
+constexpr Tables tables = build_tables();
+
+// Decisor asintótico: los negativos de la cara quedan unidos si el punto silla
+// es negativo. Equivale a comparar los productos de las diagonales, lo que da
+// la misma respuesta en las dos celdas que comparten la cara.
+inline bool negatives_joined(const double values[8], int face, double isovalue = 0) {
+    double a = values[face_corners[face][0]] - isovalue, b = values[face_corners[face][1]] - isovalue;
+    double c = values[face_corners[face][2]] - isovalue, d = values[face_corners[face][3]] - isovalue;
+    double negative_diagonal = (a < 0) ? a * c : b * d;
+    double positive_diagonal = (a < 0) ? b * d : a * c;
+    return negative_diagonal > positive_diagonal;
+}
+
+} // namespace mc33
+
+inline vector<Triangle> marching_cubes_33_cell(const Point3D vertices[8], const double values[8], double isovalue = 0, double snap = 0,
+                                               const CellAttributes& attributes = CellAttributes()) {
+    int config = 0;
+    for (int i = 0; i < 8; i++) if (values[i] < isovalue) config |= (1 << i);
+    if (config == 0 || config == 255) return {};
+
+    int mask = mc33::tables.ambiguous_faces[config];
+    int decisions = 0, bit = 0;
+    for (int face = 0; face < 6; face++) {
+        if (!((mask >> face) & 1)) continue;
+        if (mc33::negatives_joined(values, face, isovalue)) decisions |= 1 << bit;
+        bit++;
+    }
+    const unsigned char* entry = mc33::tables.loops[mc33::tables.offset[config] + decisions];
+
+    unique_ptr<CellAttributeValues> extra;
+    if (attributes.active()) extra.reset(new CellAttributeValues(vertices, *attributes.fields));
+
+    Point3D edge_points[12];
+    for (int e = 0; e < 12; e++) {
+        int a = mc33::edge_corners[e][0], b = mc33::edge_corners[e][1];
+        if ((values[a] < isovalue) != (values[b] < isovalue)) {
+            double t = edge_parameter(values[a], values[b], isovalue, snap);
+            edge_points[e] = point_on_edge(vertices[a], vertices[b], t);
+            if (extra) extra->interpolate_edge(e, a, b, t);
+        }
+    }
+
+    vector<Triangle> triangles;
+    for (int i = 0; entry[i] != 0; i += (entry[i] & 15) + 1) {
+        int length = entry[i] & 15;
+        const unsigned char* loop = entry + i + 1;
+        if (entry[i] & 16) {
+            Point3D center;
+            for (int v = 0; v < length; v++) {
+                center.x += edge_points[loop[v]].x; center.y += edge_points[loop[v]].y; center.z += edge_points[loop[v]].z;
+            }
+            center.x /= length; center.y /= length; center.z /= length;
+            if (extra) {
+                double* c = extra->row(20);
+                for (size_t k = 0; k < extra->count; k++) {
+                    c[k] = 0;
+                    for (int v = 0; v < length; v++) c[k] += extra->row(8 + loop[v])[k];
+                    c[k] /= length;
+                }
+            }
+            for (int v = 0; v < length; v++) {
+                Triangle triangle(center, edge_points[loop[v]], edge_points[loop[(v + 1) % length]]);
+                if (snap > 0 && triangle.collapsed()) continue;
+                triangles.push_back(triangle);
+                if (extra) extra->append(*attributes.out, 20, 8 + loop[v], 8 + loop[(v + 1) % length]);
+            }
+        } else {
+            for (int v = 1; v + 1 < length; v++) {
+                Triangle triangle(edge_points[loop[0]], edge_points[loop[v]], edge_points[loop[v + 1]]);
+                if (snap > 0 && triangle.collapsed()) continue;
+                triangles.push_back(triangle);
+                if (extra) extra->append(*attributes.out, 8 + loop[0], 8 + loop[v], 8 + loop[v + 1]);
+            }
+        }
+    }
+    return triangles;
+}
+
+// Igual que marching_cubes, también para attributes_out
+inline vector<Triangle> marching_cubes_33(Point3D start, Point3D end, const ScalarField& f, const CellOptions& options = CellOptions(),
+                                          AttributeBuffer* attributes_out = nullptr) {
+    Point3D vertices[8];
+    cell_corners(start, end, vertices);
+    double values[8];
+    f.evaluate(vertices, values, 8);
+    if (options.samples) options.samples->record(vertices, values);
+    return marching_cubes_33_cell(vertices, values, options.isovalue, options.snap, CellAttributes(options.attributes, attributes_out));
+}
+
+inline vector<Triangle> cell_triangles(Point3D start, Point3D end, const ScalarField& f, const CellOptions& options,
+                                       AttributeBuffer* attributes_out = nullptr) {
+    return options.table == CellTable::Classic ? marching_cubes(start, end, f, options, attributes_out)
+                                               : marching_cubes_33(start, end, f, options, attributes_out);
+}
+
+// ¿Hay algún isovalor con muestras a ambos lados? Mismo muestreo que
+// cube_contains_surface, llevando el mínimo y el máximo vistos.
+inline bool cube_contains_any(const ScalarField& f, Point3D start, Point3D end, const vector<double>& isovalues) {
+    if (f.contains_surface) {
+        for (double isovalue : isovalues) {
+            if (f.contains_surface(f.data, start, end, isovalue)) return true;
+        }
+        return false;
+    }
+
+    const int num_samples = 10000;
+    double lowest = INFINITY, highest = -INFINITY;
+    std::mt19937 rng(node_seed(start, end));
+
+    const size_t chunk = f.sample_chunk();
+    vector<Point3D> points(chunk);
+    vector<double> values(chunk);
+    for (int i = 0; i < num_samples; i += (int)chunk) {
+        size_t n = min(chunk, (size_t)(num_samples - i));
+        for (size_t s = 0; s < n; s++) points[s] = get_random_point_3d(start.x, start.y, start.z, end.x, end.y, end.z, rng);
+        f.evaluate(points.data(), values.data(), n);
+        bool widened = false;
+        for (size_t s = 0; s < n; s++) {
+            if (values[s] >= lowest && values[s] <= highest) continue;
+            lowest = min(lowest, values[s]);
+            highest = max(highest, values[s]);
+            widened = true;
+        }
+        if (!widened) continue;
+        for (double isovalue : isovalues) {
+            if (lowest < isovalue && highest >= isovalue) return true;
+        }
+    }
+    return false;
+}
+
+inline vector<Triangle> cell_triangles_from_values(const Point3D vertices[8], const double values[8], CellTable table,
+                                                   double isovalue, double snap,
+                                                   const CellAttributes& attributes = CellAttributes()) {
+    return table == CellTable::Classic ? marching_cubes_cell(vertices, values, isovalue, snap, attributes)
+                                       : marching_cubes_33_cell(vertices, values, isovalue, snap, attributes);
+}
+
+// Una celda contra los K isovalores: evalúa las 8 esquinas una vez, las pasa a
+// options.samples y agrega los triángulos (y atributos) a la sopa de cada isovalor.
+inline void cell_soups(const ScalarField& f, Point3D start, Point3D end, const vector<double>& isovalues,
+                       const CellOptions& options, vector<TriangleSoup>& out) {
+    Point3D vertices[8];
+    cell_corners(start, end, vertices);
+    double values[8];
+    f.evaluate(vertices, values, 8);
+    if (options.samples) options.samples->record(vertices, values);
+
+    for (size_t k = 0; k < isovalues.size(); k++) {
+        CellAttributes attributes(options.attributes, &out[k].attributes);
+        vector<Triangle> cell = cell_triangles_from_values(vertices, values, options.table, isovalues[k], options.snap, attributes);
+        out[k].triangles.insert(out[k].triangles.end(), cell.begin(), cell.end());
+    }
+}
+
+inline void surface_to_triangles_multi_rec(const ScalarField& f, Point3D start, Point3D end, double precision,
+                                           const vector<double>& isovalues, const CellOptions& options,
+                                           vector<vector<TriangleSoup>>& per_thread,
+                                           TriangleSink* sink = nullptr, size_t batch_size = 0, int depth = 0) {
+    TraversalControl* control = options.control;
+    TraceScope trace(options.tracer, start, end, depth);
+    if (control && control->is_cancelled()) return;
+
+    if (end.x - start.x < precision || end.y - start.y < precision || end.z - start.z < precision) {
+        vector<TriangleSoup>& out = per_thread[omp_get_thread_num()];
+        bool counted = options.counters || options.tracer;
+        size_t before = 0, after = 0;
+        if (counted) for (const auto& soup : out) before += soup.triangles.size();
+        cell_soups(f, start, end, isovalues, options, out);
+        if (counted) {
+            for (const auto& soup : out) after += soup.triangles.size();
+            if (options.counters) options.counters->leaf(depth, after - before);
+            trace.leaf(after - before);
+        }
+        for (size_t k = 0; k < isovalues.size(); k++) {
+            if (sink && out[k].triangles.size() >= batch_size) {
+                sink->deliver(k, out[k]);
+                out[k].triangles.clear();
+                out[k].attributes.clear();
+            }
+        }
+        if (control) control->complete(depth);
+        return;
+    }
+
+    if (!cube_contains_any(f, start, end, isovalues)) {
+        if (control) control->complete(depth);
+        if (options.counters) options.counters->node(depth, false);
+        trace.culled();
+        return;
+    }
+    if (options.counters) options.counters->node(depth, true);
+
+    double mid[3] = {(start.x + end.x) / 2, (start.y + end.y) / 2, (start.z + end.z) / 2};
+    double lo[3] = {start.x, start.y, start.z};
+    double hi[3] = {end.x, end.y, end.z};
+
+    for (int octant = 0; octant < 8; octant++) {
+        int dx = octant & 1, dy = (octant >> 1) & 1, dz = (octant >> 2) & 1;
+        Point3D s(dx ? mid[0] : lo[0], dy ? mid[1] : lo[1], dz ? mid[2] : lo[2]);
+        Point3D e(dx ? hi[0] : mid[0], dy ? hi[1] : mid[1], dz ? hi[2] : mid[2]);
+
+        #pragma omp task firstprivate(s, e) shared(f, isovalues, options, per_thread)
+        surface_to_triangles_multi_rec(f, s, e, precision, isovalues, options, per_thread, sink, batch_size, depth + 1);
+    }
+    #pragma omp taskwait
+}
+
+// El recorrido de surface_to_soups sin juntar: las sopas de cada hilo, por
+// isovalor. Separado para medir el recorrido y la unión por separado.
+inline vector<vector<TriangleSoup>> surface_to_thread_soups(const ScalarField& f, Point3D start, Point3D end, double precision,
+                                                            const vector<double>& isovalues, const CellOptions& options = CellOptions()) {
+    vector<vector<TriangleSoup>> per_thread(omp_get_max_threads(), vector<TriangleSoup>(isovalues.size()));
+
+    #pragma omp parallel
+    {
+        #pragma omp single nowait
+        surface_to_triangles_multi_rec(f, start, end, precision, isovalues, options, per_thread);
+    }
+    return per_thread;
+}
+
+// Une las sopas por hilo en una por isovalor, liberando cada parte al copiarla
+inline vector<TriangleSoup> merge_thread_soups(vector<vector<TriangleSoup>>& per_thread, size_t isovalues, size_t attribute_count) {
+    vector<TriangleSoup> soups(isovalues);
+    for (size_t k = 0; k < isovalues; k++) {
+        size_t triangles = 0, attributes = 0;
+        for (const auto& part : per_thread) {
+            triangles += part[k].triangles.size();
+            attributes += part[k].attributes.size();
+        }
+        soups[k].attribute_count = attribute_count;
+        soups[k].triangles.reserve(triangles);
+        soups[k].attributes.reserve(attributes);
+        for (auto& part : per_thread) {
+            soups[k].triangles.insert(soups[k].triangles.end(), part[k].triangles.begin(), part[k].triangles.end());
+            soups[k].attributes.insert(soups[k].attributes.end(), part[k].attributes.begin(), part[k].attributes.end());
+            part[k] = TriangleSoup();
+        }
+    }
+    return soups;
+}
+
+// Varias isosuperficies del mismo campo en un solo recorrido: cada esquina se
+// evalúa una vez y se clasifica contra los K isovalores. Un nodo se subdivide
+// si puede contener alguno. Devuelve una sopa por isovalor, con los atributos
+// de options.attributes interpolados en cada vértice.
+inline vector<TriangleSoup> surface_to_soups(const ScalarField& f, Point3D start, Point3D end, double precision,
+                                             const vector<double>& isovalues, const CellOptions& options = CellOptions()) {
+    vector<vector<TriangleSoup>> per_thread = surface_to_thread_soups(f, start, end, precision, isovalues, options);
+    return merge_thread_soups(per_thread, isovalues.size(), options.attributes ? options.attributes->size() : 0);
+}
+
+// Mismo recorrido entregando lotes de hasta batch_size triángulos al receptor
+// en lugar de acumularlos. Los restos de cada hilo se entregan al final.
+inline void surface_to_sink(const ScalarField& f, Point3D start, Point3D end, double precision, const vector<double>& isovalues,
+                            const CellOptions& options, TriangleSink& sink, size_t batch_size = 4096) {
+    size_t attribute_count = options.attributes ? options.attributes->size() : 0;
+    vector<vector<TriangleSoup>> per_thread(omp_get_max_threads(), vector<TriangleSoup>(isovalues.size()));
+    for (auto& part : per_thread) {
+        for (auto& soup : part) {
+            soup.attribute_count = attribute_count;
+            soup.triangles.reserve(batch_size + 64);
+        }
+    }
+
+    #pragma omp parallel
+    {
+        #pragma omp single nowait
+        surface_to_triangles_multi_rec(f, start, end, precision, isovalues, options, per_thread, &sink, max<size_t>(1, batch_size));
+    }
+
+    for (auto& part : per_thread) {
+        for (size_t k = 0; k < part.size(); k++) {
+            if (!part[k].triangles.empty()) sink.deliver(k, part[k]);
+        }
+    }
+}
+
+inline vector<vector<Triangle>> surface_to_triangles_multi(const ScalarField& f, Point3D start, Point3D end, double precision,
+                                                           const vector<double>& isovalues,
+                                                           const CellOptions& options = CellOptions()) {
+    CellOptions geometry = options;
+    geometry.attributes = nullptr;
+    vector<TriangleSoup> soups = surface_to_soups(f, start, end, precision, isovalues, geometry);
+    vector<vector<Triangle>> meshes(isovalues.size());
+    for (size_t k = 0; k < isovalues.size(); k++) {
+        meshes[k].assign(soups[k].triangles.begin(), soups[k].triangles.end());
+        TriangleBuffer().swap(soups[k].triangles);
+    }
+    return meshes;
+}
+
+// Una sola isosuperficie, la de options.isovalue, con el mismo recorrido
+inline vector<Triangle> surface_to_triangles(const ScalarField& f, Point3D start, Point3D end, double precision,
+                                             const CellOptions& options = CellOptions()) {
+    return surface_to_triangles_multi(f, start, end, precision, vector<double>(1, options.isovalue), options)[0];
+}
+
+#endif // MARCHING_CUBES_H
@@ -0,0 +1,349 @@
+// Implementación del ABI en C (marching_cubes_c.h) sobre Extractor.
+#include "marching_cubes_c.h"
+#include "extractor.h"
+#include <cstring>
+#include <deque>
+#include <new>
+
+static_assert(sizeof(Point3D) == 3 * sizeof(double), "los vértices se entregan como 3 doubles");
+static_assert(sizeof(Triangle) == 9 * sizeof(double), "los triángulos se entregan como 9 doubles");
+static_assert(sizeof(int) == sizeof(int32_t), "los índices se entregan como int32_t");
+
+// Avance hacia el callback del llamador; un valor distinto de cero cancela
+class ProgressControl : public TraversalControl {
+public:
+    mc_progress_fn callback = nullptr;
+    void* user = nullptr;
+
+    void progressed(double fraction) override {
+        if (callback && callback(user, fraction) != 0) cancel();
+    }
+};
+
+class FieldCallback {
+public:
+    mc_field_fn field = nullptr;
+    mc_field_batch_fn batch = nullptr;
+    void* user = nullptr;
+};
+
+struct mc_context {
+    Extractor extractor;
+    Volume volume;
+    FieldCallback field;
+    deque<FieldCallback> attributes;  // direcciones estables: los ScalarField apuntan aquí
+    ProgressControl control;
+    int threads = 0;
+    vector<IndexedMesh> fallback;  // de la última extracción cortada por el plazo
+};
+
+struct mc_mesh {
+    IndexedMesh mesh;
+};
+
+static double call_field(const void* data, double x, double y, double z) {
+    const FieldCallback* callback = (const FieldCallback*)data;
+    return callback->field(callback->user, x, y, z);
+}
+
+static void call_field_batch(const void* data, const double* xyz, double* values, size_t count) {
+    const FieldCallback* callback = (const FieldCallback*)data;
+    callback->batch(callback->user, xyz, values, count);
+}
+
+// Corre una extracción con el control de avance y sin dejar salir excepciones
+template <class Run>
+static mc_status run_extraction(mc_context* context, Run run) {
+    if (!context) return MC_ERROR_ARGUMENT;
+    if (!context->extractor.field()) return MC_ERROR_NO_FIELD;
+    string error;
+    if (!context->extractor.config.check(error)) return MC_ERROR_ARGUMENT;
+    context->control.reset();
+    context->fallback.clear();
+    context->extractor.config.control = &context->control;
+    if (context->threads > 0) omp_set_num_threads(context->threads);
+    try {
+        mc_status status = run();
+        if (status == MC_OK && context->control.cancelled) return context->control.expired ? MC_TIMED_OUT : MC_CANCELLED;
+        return status;
+    } catch (...) {
+        return MC_ERROR_INTERNAL;
+    }
+}
+
+// Mueve la malla a un mc_mesh sin copiar
+static mc_mesh* wrap_mesh(IndexedMesh& mesh) {
+    mc_mesh* out = new mc_mesh();
+    out->mesh.vertices.swap(mesh.vertices);
+    out->mesh.indices.swap(mesh.indices);
+    out->mesh.normals.swap(mesh.normals);
+    out->mesh.attribute_names.swap(mesh.attribute_names);
+    out->mesh.attributes.swap(mesh.attributes);
+    return out;
+}
+
+extern "C" {
+
+MC_API int mc_api_version(void) { return MC_API_VERSION; }
+
+MC_API mc_context* mc_context_create(void) {
+    return new (nothrow) mc_context();
+}
+
+MC_API void mc_context_destroy(mc_context* context) { delete context; }
+
+MC_API mc_status mc_set_field(mc_context* context, mc_field_fn field, void* user) {
+    if (!context || !field) return MC_ERROR_ARGUMENT;
+    context->field = FieldCallback();
+    context->field.field = field;
+    context->field.user = user;
+    context->extractor.set_field(ScalarField(call_field, &context->field));
+    return MC_OK;
+}
+
+MC_API mc_status mc_set_field_batch(mc_context* context, mc_field_batch_fn field, void* user) {
+    if (!context || !field) return MC_ERROR_ARGUMENT;
+    context->field = FieldCallback();
+    context->field.batch = field;
+    context->field.user = user;
+    context->extractor.set_field(ScalarField::batched(call_field_batch, &context->field));
+    return MC_OK;
+}
+
+MC_API mc_status mc_set_volume(mc_context* context, const void* voxels, int nx, int ny, int nz, mc_voxel_type type,
+                               int tricubic, double threshold, const double origin[3], const double spacing[3]) {
+    if (!context || !voxels || nx < 2 || ny < 2 || nz < 2) return MC_ERROR_ARGUMENT;
+    if (type != MC_VOXEL_U8 && type != MC_VOXEL_U16 && type != MC_VOXEL_F32) return MC_ERROR_ARGUMENT;
+    if (spacing && (spacing[0] <= 0 || spacing[1] <= 0 || spacing[2] <= 0)) return MC_ERROR_ARGUMENT;
+    try {
+        VoxelType voxel_type = type == MC_VOXEL_U8 ? VoxelType::UInt8 : type == MC_VOXEL_U16 ? VoxelType::UInt16 : VoxelType::Float32;
+        context->extractor.set_field(ScalarField());
+        context->volume = Volume(nx, ny, nz, voxel_type);
+        memcpy(context->volume.data.data(), voxels, context->volume.data.size());
+        if (origin) context->volume.origin = Point3D(origin[0], origin[1], origin[2]);
+        if (spacing) context->volume.spacing = Point3D(spacing[0], spacing[1], spacing[2]);
+        context->extractor.set_volume(context->volume, tricubic ? Reconstruction::Tricubic : Reconstruction::Trilinear, threshold);
+    } catch (...) {
+        return MC_ERROR_INTERNAL;
+    }
+    return MC_OK;
+}
+
+MC_API mc_status mc_set_domain(mc_context* context, const double start[3], const double end[3]) {
+    if (!context || !start || !end || start[0] >= end[0] || start[1] >= end[1] || start[2] >= end[2]) return MC_ERROR_ARGUMENT;
+    context->extractor.config.start = Point3D(start[0], start[1], start[2]);
+    context->extractor.config.end = Point3D(end[0], end[1], end[2]);
+    return MC_OK;
+}
+
+MC_API mc_status mc_set_precision(mc_context* context, double precision) {
+    if (!context || !(precision > 0)) return MC_ERROR_ARGUMENT;
+    context->extractor.config.precision = precision;
+    return MC_OK;
+}
+
+MC_API mc_status mc_set_engine(mc_context* context, mc_engine engine) {
+    if (!context) return MC_ERROR_ARGUMENT;
+    switch (engine) {
+        case MC_ENGINE_MC: context->extractor.config.engine = Engine::MarchingCubes; break;
+        case MC_ENGINE_MC33: context->extractor.config.engine = Engine::MarchingCubes33; break;
+        case MC_ENGINE_SURFACE_NETS: context->extractor.config.engine = Engine::SurfaceNets; break;
+        case MC_ENGINE_DUAL_CONTOURING: context->extractor.config.engine = Engine::DualContouring; break;
+        default: return MC_ERROR_ARGUMENT;
+    }
+    return MC_OK;
+}
+
+MC_API mc_status mc_set_isovalues(mc_context* context, const double* isovalues, size_t count) {
+    if (!context || !isovalues || count == 0) return MC_ERROR_ARGUMENT;
+    context->extractor.config.isovalues.assign(isovalues, isovalues + count);
+    return MC_OK;
+}
+
+MC_API mc_status mc_set_snap(mc_context* context, double snap) {
+    if (!context || !(snap >= 0 && snap < 0.5)) return MC_ERROR_ARGUMENT;
+    context->extractor.config.snap = snap;
+    return MC_OK;
+}
+
+MC_API mc_status mc_set_threads(mc_context* context, int threads) {
+    if (!context || threads < 0) return MC_ERROR_ARGUMENT;
+    context->threads = threads;
+    return MC_OK;
+}
+
+MC_API mc_status mc_set_batch_size(mc_context* context, size_t triangles) {
+    if (!context || triangles == 0) return MC_ERROR_ARGUMENT;
+    context->extractor.config.batch_size = triangles;
+    return MC_OK;
+}
+
+MC_API mc_status mc_add_attribute(mc_context* context, const char* name, mc_field_fn field, void* user) {
+    if (!context || !name || !field) return MC_ERROR_ARGUMENT;
+    context->attributes.push_back(FieldCallback());
+    context->attributes.back().field = field;
+    context->attributes.back().user = user;
+    context->extractor.add_attribute(name, ScalarField(call_field, &context->attributes.back()));
+    return MC_OK;
+}
+
+MC_API mc_status mc_set_time_limit(mc_context* context, double seconds, double fallback_share) {
+    if (!context || !(seconds >= 0) || !(fallback_share >= 0)) return MC_ERROR_ARGUMENT;
+    context->extractor.config.time_limit = seconds;
+    context->extractor.config.fallback_share = fallback_share;
+    return MC_OK;
+}
+
+MC_API mc_status mc_set_progress_callback(mc_context* context, mc_progress_fn progress, void* user) {
+    if (!context) return MC_ERROR_ARGUMENT;
+    context->control.callback = progress;
+    context->control.user = user;
+    return MC_OK;
+}
+
+MC_API double mc_get_progress(const mc_context* context) { return context ? context->control.progress() : 0; }
+
+MC_API void mc_cancel(mc_context* context) {
+    if (context) context->control.cancel();
+}
+
+MC_API mc_status mc_extract_stream(mc_context* context, mc_batch_fn batch, void* user) {
+    if (!batch) return MC_ERROR_ARGUMENT;
+
+    class CallbackSink : public TriangleSink {
+    public:
+        mc_batch_fn batch;
+        void* user;
+        CallbackSink(mc_batch_fn batch, void* user) : batch(batch), user(user) {}
+        void deliver(size_t k, const TriangleSoup& soup) override {
+            batch(user, k, &soup.triangles[0].p1.x, soup.triangles.size(), soup.attributes.empty() ? nullptr : soup.attributes.data(),
+                  soup.attribute_count);
+        }
+    };
+
+    return run_extraction(context, [&]() {
+        CallbackSink sink(batch, user);
+        context->extractor.extract(sink);
+        return MC_OK;
+    });
+}
+
+MC_API mc_status mc_extract_into(mc_context* context, mc_soup_buffer* buffers) {
+    if (!buffers) return MC_ERROR_ARGUMENT;
+
+    // Cada lote reserva su tramo con un contador atómico y se copia sin candados
+    class BufferSink : public TriangleSink {
+    public:
+        mc_soup_buffer* buffers;
+        vector<atomic<size_t>> counts;
+        BufferSink(mc_soup_buffer* buffers, size_t isovalues) : buffers(buffers), counts(isovalues) {
+            for (auto& n : counts) n = 0;
+        }
+        void deliver(size_t k, const TriangleSoup& soup) override {
+            size_t n = soup.triangles.size();
+            size_t offset = counts[k].fetch_add(n);
+            mc_soup_buffer& buffer = buffers[k];
+            if (offset >= buffer.capacity || !buffer.triangles) return;
+            size_t fit = min(n, buffer.capacity - offset);
+            memcpy(buffer.triangles + 9 * offset, &soup.triangles[0].p1.x, fit * sizeof(Triangle));
+            size_t per_triangle = 3 * soup.attribute_count;
+            if (buffer.attributes && per_triangle > 0) {
+                memcpy(buffer.attributes + per_triangle * offset, soup.attributes.data(), fit * per_triangle * sizeof(float));
+            }
+        }
+    };
+
+    return run_extraction(context, [&]() {
+        size_t isovalues = context->extractor.config.isovalues.size();
+        BufferSink sink(buffers, isovalues);
+        context->extractor.extract(sink);
+        mc_status status = MC_OK;
+        for (size_t k = 0; k < isovalues; k++) {
+            buffers[k].count = sink.counts[k];
+            if (buffers[k].count > buffers[k].capacity) status = MC_ERROR_BUFFER_TOO_SMALL;
+        }
+        return status;
+    });
+}
+
+MC_API mc_status mc_extract(mc_context* context, mc_mesh** meshes) {
+    if (!meshes) return MC_ERROR_ARGUMENT;
+    if (context) {
+        for (size_t k = 0; k < context->extractor.config.isovalues.size(); k++) meshes[k] = nullptr;
+    }
+    return run_extraction(context, [&]() {
+        ExtractionStats stats;
+        vector<IndexedMesh> result = context->extractor.extract_meshes(&stats, &context->fallback);
+        // Cancelada o no, se entregan las mallas (parciales en ese caso)
+        for (size_t k = 0; k < result.size(); k++) meshes[k] = wrap_mesh(result[k]);
+        return MC_OK;
+    });
+}
+
+MC_API mc_status mc_take_fallback(mc_context* context, mc_mesh** meshes) {
+    if (!context || !meshes) return MC_ERROR_ARGUMENT;
+    if (context->fallback.empty()) return MC_ERROR_ARGUMENT;
+    for (size_t k = 0; k < context->fallback.size(); k++) meshes[k] = wrap_mesh(context->fallback[k]);
+    context->fallback.clear();
+    return MC_OK;
+}
+
+static_assert((int)MemoryCategory::Count == MC_MEMORY_TOTAL, "mc_memory_category sigue el orden de MemoryCategory");
+
+MC_API mc_status mc_memory_usage(mc_memory_category category, size_t* current, size_t* peak) {
+    if (category < MC_MEMORY_TRIANGLES || category > MC_MEMORY_TOTAL) return MC_ERROR_ARGUMENT;
+    MemoryUsage usage = memory_accounting().usage((MemoryCategory)category);
+    if (current) *current = (size_t)max<int64_t>(0, usage.current);
+    if (peak) *peak = (size_t)max<int64_t>(0, usage.peak);
+    return MC_OK;
+}
+
+MC_API void mc_memory_reset_peaks(void) { memory_accounting().reset_peaks(); }
+
+MC_API size_t mc_mesh_vertex_count(const mc_mesh* mesh) { return mesh ? mesh->mesh.vertices.size() : 0; }
+
+MC_API size_t mc_mesh_triangle_count(const mc_mesh* mesh) { return mesh ? mesh->mesh.triangle_count() : 0; }
+
+MC_API const double* mc_mesh_vertices(const mc_mesh* mesh) {
+    return mesh && !mesh->mesh.vertices.empty() ? &mesh->mesh.vertices[0].x : nullptr;
+}
+
+MC_API const int32_t* mc_mesh_indices(const mc_mesh* mesh) {
+    return mesh && !mesh->mesh.indices.empty() ? (const int32_t*)mesh->mesh.indices.data() : nullptr;
+}
+
+MC_API const double* mc_mesh_normals(const mc_mesh* mesh) {
+    if (!mesh || mesh->mesh.normals.empty() || mesh->mesh.normals.size() != mesh->mesh.vertices.size()) return nullptr;
+    return &mesh->mesh.normals[0].x;
+}
+
+MC_API size_t mc_mesh_attribute_count(const mc_mesh* mesh) {
+    return mesh && mesh->mesh.has_attributes() ? mesh->mesh.attribute_count() : 0;
+}
+
+MC_API const char* mc_mesh_attribute_name(const mc_mesh* mesh, size_t index) {
+    if (!mesh || index >= mc_mesh_attribute_count(mesh)) return nullptr;
+    return mesh->mesh.attribute_names[index].c_str();
+}
+
+MC_API const float* mc_mesh_attributes(const mc_mesh* mesh) {
+    return mc_mesh_attribute_count(mesh) > 0 ? mesh->mesh.attributes.data() : nullptr;
+}
+
+MC_API mc_status mc_mesh_copy(const mc_mesh* mesh, double* vertices, size_t vertex_capacity, int32_t* indices,
+                              size_t triangle_capacity, float* attributes) {
+    if (!mesh || !vertices || !indices) return MC_ERROR_ARGUMENT;
+    if (vertex_capacity < mesh->mesh.vertices.size() || triangle_capacity < mesh->mesh.triangle_count()) {
+        return MC_ERROR_BUFFER_TOO_SMALL;
+    }
+    if (!mesh->mesh.vertices.empty()) memcpy(vertices, &mesh->mesh.vertices[0].x, mesh->mesh.vertices.size() * sizeof(Point3D));
+    if (!mesh->mesh.indices.empty()) memcpy(indices, mesh->mesh.indices.data(), mesh->mesh.indices.size() * sizeof(int32_t));
+    if (attributes && mc_mesh_attribute_count(mesh) > 0) {
+        memcpy(attributes, mesh->mesh.attributes.data(), mesh->mesh.attributes.size() * sizeof(float));
+    }
+    return MC_OK;
+}
+
+MC_API void mc_mesh_destroy(mc_mesh* mesh) { delete mesh; }
+
+} // extern "C"
@@ -0,0 +1,160 @@
+#ifndef MARCHING_CUBES_C_H
+#define MARCHING_CUBES_C_H
+
+/*
+ * ABI en C del extractor, para cargarlo como biblioteca compartida desde otros
+ * lenguajes (ctypes/cffi, Rust FFI...). Sólo tipos de C, estructuras opacas y
+ * códigos de estado: ninguna excepción cruza la frontera.
+ *
+ *   g++ -std=c++17 -O3 -fopenmp -fPIC -shared -fvisibility=hidden marching_cubes_c.cpp -o libmarching_cubes.so
+ *
+ * Un mc_context no se usa desde dos hilos a la vez, salvo mc_cancel y
+ * mc_get_progress, que se pueden llamar durante una extracción.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define MC_API __declspec(dllexport)
+#else
+#define MC_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MC_API_VERSION 3
+
+typedef struct mc_context mc_context;
+typedef struct mc_mesh mc_mesh;
+
+typedef enum {
+    MC_OK = 0,
+    MC_ERROR_ARGUMENT = 1,          /* puntero nulo o valor fuera de rango */
+    MC_ERROR_NO_FIELD = 2,          /* falta mc_set_field / mc_set_volume */
+    MC_ERROR_BUFFER_TOO_SMALL = 3,  /* el tamaño necesario queda en el búfer */
+    MC_CANCELLED = 4,               /* la salida es parcial */
+    MC_ERROR_INTERNAL = 5,          /* p. ej. sin memoria */
+    MC_TIMED_OUT = 6                /* venció el plazo: salida parcial y, con mc_extract, malla de respaldo */
+} mc_status;
+
+typedef enum {
+    MC_ENGINE_MC = 0,
+    MC_ENGINE_MC33 = 1,
+    MC_ENGINE_SURFACE_NETS = 2,
+    MC_ENGINE_DUAL_CONTOURING = 3
+} mc_engine;
+
+/* Subsistemas de la contabilidad de memoria; MC_MEMORY_TOTAL los suma. */
+typedef enum {
+    MC_MEMORY_TRIANGLES = 0,  /* sopas de triángulos */
+    MC_MEMORY_OCTREE = 1,     /* claves de nodos y celdas activas */
+    MC_MEMORY_CACHES = 2,     /* pirámides de volumen, ladrillos SDF, soldado */
+    MC_MEMORY_WRITER = 3,     /* búferes de escritura */
+    MC_MEMORY_TOTAL = 4
+} mc_memory_category;
+
+typedef enum { MC_VOXEL_U8 = 0, MC_VOXEL_U16 = 1, MC_VOXEL_F32 = 2 } mc_voxel_type;
+
+/* Campo escalar. Se llama desde varios hilos a la vez. */
+typedef double (*mc_field_fn)(void* user, double x, double y, double z);
+/* Por lotes: xyz tiene 3 * count coordenadas; escribir count valores. */
+typedef void (*mc_field_batch_fn)(void* user, const double* xyz, double* values, size_t count);
+/* Avance en [0, 1], desde los hilos de la extracción; devolver != 0 cancela. */
+typedef int (*mc_progress_fn)(void* user, double fraction);
+/*
+ * Lote de triángulos: 9 doubles por triángulo y attribute_count floats por
+ * esquina. Los punteros apuntan al búfer del hilo y sólo valen durante la
+ * llamada. Se llama desde varios hilos a la vez.
+ */
+typedef void (*mc_batch_fn)(void* user, size_t isovalue_index, const double* triangles, size_t triangle_count,
+                            const float* attributes, size_t attribute_count);
+
+/* Búfer del llamador para mc_extract_into: capacity en triángulos. */
+typedef struct {
+    double* triangles;      /* 9 * capacity doubles */
+    float* attributes;      /* 3 * attribute_count * capacity floats, o NULL */
+    size_t capacity;
+    size_t count;           /* salida: triángulos producidos (puede superar capacity) */
+} mc_soup_buffer;
+
+MC_API int mc_api_version(void);
+
+MC_API mc_context* mc_context_create(void);
+MC_API void mc_context_destroy(mc_context* context);
+
+/* Campo: función, función por lotes o volumen (los vóxeles se copian). */
+MC_API mc_status mc_set_field(mc_context* context, mc_field_fn field, void* user);
+MC_API mc_status mc_set_field_batch(mc_context* context, mc_field_batch_fn field, void* user);
+MC_API mc_status mc_set_volume(mc_context* context, const void* voxels, int nx, int ny, int nz, mc_voxel_type type,
+                               int tricubic, double threshold, const double origin[3], const double spacing[3]);
+
+MC_API mc_status mc_set_domain(mc_context* context, const double start[3], const double end[3]);
+MC_API mc_status mc_set_precision(mc_context* context, double precision);
+MC_API mc_status mc_set_engine(mc_context* context, mc_engine engine);
+MC_API mc_status mc_set_isovalues(mc_context* context, const double* isovalues, size_t count);
+MC_API mc_status mc_set_snap(mc_context* context, double snap);
+MC_API mc_status mc_set_threads(mc_context* context, int threads);
+MC_API mc_status mc_set_batch_size(mc_context* context, size_t triangles);
+MC_API mc_status mc_add_attribute(mc_context* context, const char* name, mc_field_fn field, void* user);
+
+/*
+ * Plazo en segundos (0 = sin plazo), mirado al empezar cada tarea del octree.
+ * Si vence, la extracción devuelve MC_TIMED_OUT con lo producido hasta ahí y
+ * mc_extract arma además una malla más gruesa completa en fallback_share *
+ * seconds, que se obtiene con mc_take_fallback.
+ */
+MC_API mc_status mc_set_time_limit(mc_context* context, double seconds, double fallback_share);
+MC_API mc_status mc_set_progress_callback(mc_context* context, mc_progress_fn progress, void* user);
+MC_API double mc_get_progress(const mc_context* context);
+MC_API void mc_cancel(mc_context* context);
+
+/*
+ * Las tres extracciones devuelven MC_ERROR_ARGUMENT si la configuración no se
+ * puede extraer (p. ej. motor dual con más de 2^19 celdas por eje).
+ */
+/* Streaming: los lotes llegan a medida que se producen. */
+MC_API mc_status mc_extract_stream(mc_context* context, mc_batch_fn batch, void* user);
+/* Sopa escrita directamente en búferes del llamador, uno por isovalor. */
+MC_API mc_status mc_extract_into(mc_context* context, mc_soup_buffer* buffers);
+/*
+ * Mallas indexadas, una por isovalor; meshes tiene lugar para todas. Con
+ * MC_CANCELLED o MC_TIMED_OUT también se llenan, con las mallas parciales.
+ */
+MC_API mc_status mc_extract(mc_context* context, mc_mesh** meshes);
+/* Mallas de respaldo de la última mc_extract con MC_TIMED_OUT, una por isovalor. */
+MC_API mc_status mc_take_fallback(mc_context* context, mc_mesh** meshes);
+
+/*
+ * Bytes reservados ahora y pico por subsistema, de todo el proceso (todos los
+ * contextos). Se puede llamar en cualquier momento desde cualquier hilo, p. ej.
+ * para decidir si admitir otra extracción. mc_memory_reset_peaks lleva los
+ * picos al uso actual.
+ */
+MC_API mc_status mc_memory_usage(mc_memory_category category, size_t* current, size_t* peak);
+MC_API void mc_memory_reset_peaks(void);
+
+/*
+ * Acceso sin copia: los punteros son el almacenamiento de la malla y valen
+ * hasta mc_mesh_destroy. Vértices y normales con 3 doubles cada uno.
+ */
+MC_API size_t mc_mesh_vertex_count(const mc_mesh* mesh);
+MC_API size_t mc_mesh_triangle_count(const mc_mesh* mesh);
+MC_API const double* mc_mesh_vertices(const mc_mesh* mesh);
+MC_API const int32_t* mc_mesh_indices(const mc_mesh* mesh);
+MC_API const double* mc_mesh_normals(const mc_mesh* mesh);      /* NULL si no hay */
+MC_API size_t mc_mesh_attribute_count(const mc_mesh* mesh);
+MC_API const char* mc_mesh_attribute_name(const mc_mesh* mesh, size_t index);
+MC_API const float* mc_mesh_attributes(const mc_mesh* mesh);    /* attribute_count por vértice */
+/* Copia a búferes del llamador (capacidades en vértices y triángulos). */
+MC_API mc_status mc_mesh_copy(const mc_mesh* mesh, double* vertices, size_t vertex_capacity, int32_t* indices,
+                              size_t triangle_capacity, float* attributes);
+MC_API void mc_mesh_destroy(mc_mesh* mesh);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MARCHING_CUBES_C_H */
@@ -1,569 +1,862 @@
-#include <iostream>
-#include <fstream>
-#include <cmath>
-#include <vector>
-#include <string>
-#include <iomanip>
-#include <algorithm>
-#include <omp.h>
-#include <random>
-
-using namespace std;
-
-class Point3D {
+#include <cstdlib>
+#include <memory>
+#include "marching_cubes.h"
+#include "dual_contouring.h"
+#include "decimation.h"
+#include "normals.h"
+#include "components.h"
+#include "validation.h"
+#include "sdf_volume.h"
+#include "volume_field.h"
+#include "mesh_io.h"
+#include "extractor.h"
+#include "expression_field.h"
+#include "server.h"
+#include "progress.h"
+#include "trace.h"
+#include "spill.h"
+#include "surfaces.h"
+#include "scaling.h"
+#include "corpus.h"
+#include "roofline.h"
+#include <mutex>
+
+// Pasos opcionales sobre la malla indexada antes de escribirla
+class PostOptions {
 public:
-    double x, y, z;
+    bool components = false;
+    ComponentOptions component_filter;
+    bool decimate = false;
+    DecimationOptions decimation;
+    int smooth_iterations = 0;
+    bool taubin = false;
+    bool normals = false;
+    NormalWeighting normal_weighting = NormalWeighting::Area;
+    bool validate = false;
+
+    bool needs_indexed_mesh() const { return components || decimate || smooth_iterations > 0 || normals || validate; }
+};
 
-    Point3D(double x = 0, double y = 0, double z = 0) : x(x), y(y), z(z) {}
+void print_validation_report(const ValidationReport& r) {
+    cout << "Validation: " << (r.ok() ? "OK" : "FAILED") << " - " << r.triangles << " triangles, " << r.vertices << " vertices, "
+         << r.edges << " edges" << endl;
+    cout << "  invalid indices: " << r.invalid_indices << ", degenerate: " << r.degenerate_triangles
+         << ", duplicated: " << r.duplicate_triangles << endl;
+    cout << "  non-manifold edges: " << r.non_manifold_edges << ", inconsistent orientation: " << r.inconsistent_edges << endl;
+    cout << "  boundary edges: " << r.boundary_edges << " in " << r.boundary_loops << " loops" << endl;
+    if (r.distance_samples > 0) {
+        cout << "  distance to the isosurface (" << r.distance_samples << " samples): max " << r.max_distance
+             << ", mean " << r.mean_distance << endl;
+    }
+}
 
-    bool operator==(const Point3D& other) const {
-        return (abs(x - other.x) < 1e-9 && abs(y - other.y) < 1e-9 && abs(z - other.z) < 1e-9);
+void post_process(IndexedMesh& mesh, const PostOptions& post, const ScalarField& f = ScalarField(), double isovalue = 0) {
+    if (post.components) {
+        double t0 = omp_get_wtime();
+        ComponentStats stats = filter_components(mesh, post.component_filter);
+        cout << "Components: " << stats.components << " (" << omp_get_wtime() - t0 << " s), largest:";
+        for (size_t c = 0; c < stats.triangle_counts.size() && c < 5; c++) cout << " " << stats.triangle_counts[c];
+        cout << " triangles" << endl;
+        if (stats.removed_components > 0) {
+            cout << "Removed " << stats.removed_components << " small components (" << stats.removed_triangles << " triangles)" << endl;
+        }
     }
-};
+    if (post.decimate) {
+        double t0 = omp_get_wtime();
+        DecimationStats stats = decimate_mesh(mesh, post.decimation);
+        cout << "Decimated " << stats.initial_triangles << " -> " << stats.final_triangles << " triangles ("
+             << stats.collapses << " collapses, " << stats.phases << " phases, " << omp_get_wtime() - t0 << " s)" << endl;
+        if (!stats.target_reached) {
+            cerr << "Warning: decimation stopped at " << stats.final_triangles << " triangles, above the target of "
+                 << post.decimation.target_triangles << " (error limit or topology)" << endl;
+        }
+    }
+    if (post.smooth_iterations > 0) {
+        double t0 = omp_get_wtime();
+        smooth_mesh(mesh, post.smooth_iterations, post.taubin);
+        cout << (post.taubin ? "Taubin" : "Laplacian") << " smoothing: " << post.smooth_iterations
+             << " iterations (" << omp_get_wtime() - t0 << " s)" << endl;
+    }
+    if (post.normals) {
+        double t0 = omp_get_wtime();
+        compute_vertex_normals(mesh, post.normal_weighting);
+        cout << "Vertex normals (" << (post.normal_weighting == NormalWeighting::Angle ? "angle" : "area")
+             << "-weighted): " << omp_get_wtime() - t0 << " s" << endl;
+    }
+    if (post.validate) {
+        double t0 = omp_get_wtime();
+        ValidationReport report = validate_mesh(mesh, f, 10000, 1e-6, isovalue);
+        print_validation_report(report);
+        cout << "  validation time: " << omp_get_wtime() - t0 << " s" << endl;
+    }
+}
+
+// Banda estrecha con los valores que evaluó la extracción, como distancia con signo
+void save_narrow_band(const NarrowBandRecorder& recorder, const string& volume_filename) {
+    double t0 = omp_get_wtime();
+    SparseVolume volume = build_sparse_volume(recorder);
+    if (!write_sparse_volume(volume_filename, volume)) {
+        cerr << "Error writing volume: " << volume_filename << endl;
+        return;
+    }
+    double dense = pow((double)volume.samples_per_axis, 3) * sizeof(float);
+    cout << "SDF volume: " << volume.sample_count() << " samples in " << volume.brick_keys.size() << " bricks, "
+         << volume.stored_bytes() << " bytes (" << 100.0 * volume.stored_bytes() / dense << "% of a dense float grid), "
+         << omp_get_wtime() - t0 << " s -> " << volume_filename << endl;
+}
 
-class Triangle {
+// Sopa de marching cubes escrita a medida que llegan los lotes, sin juntar la
+// malla: cada triángulo escribe sus 3 vértices y su cara. Un archivo por isovalor.
+class ObjStreamSink : public TriangleSink {
 public:
-    Point3D p1, p2, p3;
+    vector<ofstream> files;
+    vector<size_t> vertex_counts;
+    vector<mutex> locks;
+
+    ObjStreamSink(const vector<string>& filenames) : files(filenames.size()), vertex_counts(filenames.size(), 0), locks(filenames.size()) {
+        for (size_t k = 0; k < filenames.size(); k++) {
+            files[k].open(filenames[k]);
+            files[k] << "# Marching Cubes Output\n\n";
+        }
+    }
 
-    Triangle(Point3D p1, Point3D p2, Point3D p3) : p1(p1), p2(p2), p3(p3) {}
-};
+    bool is_open() const {
+        for (const auto& file : files) if (!file.is_open()) return false;
+        return true;
+    }
 
-class Face {
-public:
-    vector<Point3D> vertices;
-
-    Face() {}
-    
-    void addVertex(const Point3D& vertex) {
-        vertices.push_back(vertex);
-    }
-    
-    vector<Triangle> triangulate() const {
-        vector<Triangle> triangles;
-        if (vertices.size() < 3) return triangles;
-        
-        // Fan triangulation from first vertex
-        for (size_t i = 1; i < vertices.size() - 1; i++) {
-            triangles.push_back(Triangle(vertices[0], vertices[i], vertices[i + 1]));
+    void deliver(size_t k, const TriangleSoup& batch) override {
+        // Los vértices se formatean fuera del candado; las caras dependen del contador
+        WriterText text;
+        for (const auto& triangle : batch.triangles) {
+            text << "v " << triangle.p1.x << " " << triangle.p1.y << " " << triangle.p1.z << "\n";
+            text << "v " << triangle.p2.x << " " << triangle.p2.y << " " << triangle.p2.z << "\n";
+            text << "v " << triangle.p3.x << " " << triangle.p3.y << " " << triangle.p3.z << "\n";
+        }
+        lock_guard<mutex> guard(locks[k]);
+        files[k] << text.str();
+        for (size_t t = 0; t < batch.triangles.size(); t++) {
+            size_t base = vertex_counts[k] + 3 * t + 1;
+            files[k] << "f " << base << " " << (base + 1) << " " << (base + 2) << "\n";
         }
-        return triangles;
+        vertex_counts[k] += 3 * batch.triangles.size();
     }
 };
 
-
-Point3D get_random_point_3d(double xmin, double ymin, double zmin, double xmax, double ymax, double zmax, std::mt19937& rng) {
-    std::uniform_real_distribution<double> dist_x(xmin, xmax);
-    std::uniform_real_distribution<double> dist_y(ymin, ymax);
-    std::uniform_real_distribution<double> dist_z(zmin, zmax);
-    return Point3D(dist_x(rng), dist_y(rng), dist_z(rng));
+// surface.obj -> surface<suffix>.obj
+string suffixed_filename(const string& filename, const string& suffix) {
+    size_t dot = filename.rfind('.');
+    size_t slash = filename.find_last_of("/\\");
+    if (dot == string::npos || (slash != string::npos && dot < slash)) return filename + suffix;
+    return filename.substr(0, dot) + suffix + filename.substr(dot);
 }
 
-bool cube_contains_surface(double (*f)(double, double, double), Point3D start, Point3D end) {
-    const int num_samples = 10000;
-    bool has_positive = false;
-    bool has_negative = false;
-
-    // Crear generador de números aleatorios seguro por hilo
-    std::random_device rd;
-    std::mt19937 rng(rd());
-
-    for (int i = 0; i < num_samples; ++i) {
-        Point3D p = get_random_point_3d(start.x, start.y, start.z, end.x, end.y, end.z, rng);
-        double value = f(p.x, p.y, p.z);
-
-        if (value >= 0)
-            has_positive = true;
-        else
-            has_negative = true;
-
-        if (has_positive && has_negative)
-            return true;
+// Con varios isovalores cada malla va a su archivo: surface.obj -> surface_iso0.obj, ...
+string isovalue_filename(const string& filename, size_t k) { return suffixed_filename(filename, "_iso" + to_string(k)); }
+
+// Plazo vencido: la salida es parcial y la malla gruesa de respaldo va a *_fallback
+void write_fallback(const ExtractionStats& stats, const vector<IndexedMesh>& fallback, const vector<string>& filenames) {
+    cout << "Time limit reached after " << stats.seconds << " s with " << 100 * stats.progress
+         << "% of the domain traversed: the output is partial" << endl;
+    for (size_t k = 0; k < fallback.size(); k++) {
+        string filename = suffixed_filename(filenames[k], "_fallback");
+        if (!write_mesh(filename, fallback[k])) {
+            cerr << "Error opening file: " << filename << endl;
+            return;
+        }
+        cout << "Fallback: " << fallback[k].triangle_count() << " triangles -> " << filename << endl;
     }
-
-    return false;
 }
 
-Point3D interpolate_3d(Point3D p1, Point3D p2, double f1, double f2) {
-    // retornar punto medio
-    if (abs(f2 - f1) < 1e-9) {
-        return Point3D((p1.x + p2.x) / 2, (p1.y + p2.y) / 2, (p1.z + p2.z) / 2);
+// --progressive: cada vista previa se escribe a surface_preview<d>.obj apenas
+// llega; la malla final se suelda y sigue el camino de siempre.
+class PreviewWriter : public PreviewSink {
+public:
+    vector<string> filenames;
+    vector<string> attribute_names;
+    vector<IndexedMesh> meshes;
+
+    PreviewWriter(const vector<string>& filenames, const vector<string>& attribute_names)
+        : filenames(filenames), attribute_names(attribute_names) {}
+
+    void preview(PreviewLevel& level) override {
+        size_t triangles = 0;
+        for (const auto& soup : level.soups) triangles += soup.triangles.size();
+        cout << (level.final ? "Final" : "Preview") << " depth " << level.depth << " (cells of " << level.cell_size.x << "): "
+             << level.active_nodes << " cells, " << triangles << " triangles after " << 1000 * level.seconds << " ms";
+        if (level.final) {
+            cout << endl;
+            for (auto& soup : level.soups) {
+                meshes.push_back(weld_soup(soup, attribute_names));
+                soup = TriangleSoup();
+            }
+            return;
+        }
+        for (size_t k = 0; k < level.soups.size(); k++) {
+            string filename = suffixed_filename(filenames[k], "_preview" + to_string(level.depth));
+            if (!write_mesh(filename, weld_soup(level.soups[k], attribute_names))) {
+                cerr << "Error opening file: " << filename << endl;
+                return;
+            }
+            if (k == 0) cout << " -> " << filename;
+        }
+        cout << endl;
     }
-    double t = (0 - f1) / (f2 - f1);
-    return Point3D(p1.x + t * (p2.x - p1.x), p1.y + t * (p2.y - p1.y), p1.z + t * (p2.z - p1.z));
-}
+};
 
-vector<Triangle> marching_cubes(Point3D start, Point3D end, double (*f)(double, double, double)) {
-    Point3D vertices[8] = {
-        Point3D(start.x, start.y, start.z), Point3D(end.x, start.y, start.z),
-        Point3D(end.x, end.y, start.z), Point3D(start.x, end.y, start.z),
-        Point3D(start.x, start.y, end.z), Point3D(end.x, start.y, end.z),
-        Point3D(end.x, end.y, end.z), Point3D(start.x, end.y, end.z)
-    };
- 
-    double values[8];
-    for (int i = 0; i < 8; i++) values[i] = f(vertices[i].x, vertices[i].y, vertices[i].z);
- 
-    int config = 0;
-    for (int i = 0; i < 8; i++) if (values[i] < 0) config |= (1 << i);
-
-
-    int edgeTable[256]={
-        0x0  , 0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c,
-        0x80c, 0x905, 0xa0f, 0xb06, 0xc0a, 0xd03, 0xe09, 0xf00,
-        0x190, 0x99 , 0x393, 0x29a, 0x596, 0x49f, 0x795, 0x69c,
-        0x99c, 0x895, 0xb9f, 0xa96, 0xd9a, 0xc93, 0xf99, 0xe90,
-        0x230, 0x339, 0x33 , 0x13a, 0x636, 0x73f, 0x435, 0x53c,
-        0xa3c, 0xb35, 0x83f, 0x936, 0xe3a, 0xf33, 0xc39, 0xd30,
-        0x3a0, 0x2a9, 0x1a3, 0xaa , 0x7a6, 0x6af, 0x5a5, 0x4ac,
-        0xbac, 0xaa5, 0x9af, 0x8a6, 0xfaa, 0xea3, 0xda9, 0xca0,
-        0x460, 0x569, 0x663, 0x76a, 0x66 , 0x16f, 0x265, 0x36c,
-        0xc6c, 0xd65, 0xe6f, 0xf66, 0x86a, 0x963, 0xa69, 0xb60,
-        0x5f0, 0x4f9, 0x7f3, 0x6fa, 0x1f6, 0xff , 0x3f5, 0x2fc,
-        0xdfc, 0xcf5, 0xfff, 0xef6, 0x9fa, 0x8f3, 0xbf9, 0xaf0,
-        0x650, 0x759, 0x453, 0x55a, 0x256, 0x35f, 0x55 , 0x15c,
-        0xe5c, 0xf55, 0xc5f, 0xd56, 0xa5a, 0xb53, 0x859, 0x950,
-        0x7c0, 0x6c9, 0x5c3, 0x4ca, 0x3c6, 0x2cf, 0x1c5, 0xcc ,
-        0xfcc, 0xec5, 0xdcf, 0xcc6, 0xbca, 0xac3, 0x9c9, 0x8c0,
-        0x8c0, 0x9c9, 0xac3, 0xbca, 0xcc6, 0xdcf, 0xec5, 0xfcc,
-        0xcc , 0x1c5, 0x2cf, 0x3c6, 0x4ca, 0x5c3, 0x6c9, 0x7c0,
-        0x950, 0x859, 0xb53, 0xa5a, 0xd56, 0xc5f, 0xf55, 0xe5c,
-        0x15c, 0x55 , 0x35f, 0x256, 0x55a, 0x453, 0x759, 0x650,
-        0xaf0, 0xbf9, 0x8f3, 0x9fa, 0xef6, 0xfff, 0xcf5, 0xdfc,
-        0x2fc, 0x3f5, 0xff , 0x1f6, 0x6fa, 0x7f3, 0x4f9, 0x5f0,
-        0xb60, 0xa69, 0x963, 0x86a, 0xf66, 0xe6f, 0xd65, 0xc6c,
-        0x36c, 0x265, 0x16f, 0x66 , 0x76a, 0x663, 0x569, 0x460,
-        0xca0, 0xda9, 0xea3, 0xfaa, 0x8a6, 0x9af, 0xaa5, 0xbac,
-        0x4ac, 0x5a5, 0x6af, 0x7a6, 0xaa , 0x1a3, 0x2a9, 0x3a0,
-        0xd30, 0xc39, 0xf33, 0xe3a, 0x936, 0x83f, 0xb35, 0xa3c,
-        0x53c, 0x435, 0x73f, 0x636, 0x13a, 0x33 , 0x339, 0x230,
-        0xe90, 0xf99, 0xc93, 0xd9a, 0xa96, 0xb9f, 0x895, 0x99c,
-        0x69c, 0x795, 0x49f, 0x596, 0x29a, 0x393, 0x99 , 0x190,
-        0xf00, 0xe09, 0xd03, 0xc0a, 0xb06, 0xa0f, 0x905, 0x80c,
-        0x70c, 0x605, 0x50f, 0x406, 0x30a, 0x203, 0x109, 0x0   };
-        int triTable[256][16] =
-        {{-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 1, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 8, 3, 9, 8, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 8, 3, 1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {9, 2, 10, 0, 2, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {2, 8, 3, 2, 10, 8, 10, 9, 8, -1, -1, -1, -1, -1, -1, -1},
-        {3, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 11, 2, 8, 11, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 9, 0, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 11, 2, 1, 9, 11, 9, 8, 11, -1, -1, -1, -1, -1, -1, -1},
-        {3, 10, 1, 11, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 10, 1, 0, 8, 10, 8, 11, 10, -1, -1, -1, -1, -1, -1, -1},
-        {3, 9, 0, 3, 11, 9, 11, 10, 9, -1, -1, -1, -1, -1, -1, -1},
-        {9, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {4, 3, 0, 7, 3, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 1, 9, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {4, 1, 9, 4, 7, 1, 7, 3, 1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 2, 10, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {3, 4, 7, 3, 0, 4, 1, 2, 10, -1, -1, -1, -1, -1, -1, -1},
-        {9, 2, 10, 9, 0, 2, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
-        {2, 10, 9, 2, 9, 7, 2, 7, 3, 7, 9, 4, -1, -1, -1, -1},
-        {8, 4, 7, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {11, 4, 7, 11, 2, 4, 2, 0, 4, -1, -1, -1, -1, -1, -1, -1},
-        {9, 0, 1, 8, 4, 7, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
-        {4, 7, 11, 9, 4, 11, 9, 11, 2, 9, 2, 1, -1, -1, -1, -1},
-        {3, 10, 1, 3, 11, 10, 7, 8, 4, -1, -1, -1, -1, -1, -1, -1},
-        {1, 11, 10, 1, 4, 11, 1, 0, 4, 7, 11, 4, -1, -1, -1, -1},
-        {4, 7, 8, 9, 0, 11, 9, 11, 10, 11, 0, 3, -1, -1, -1, -1},
-        {4, 7, 11, 4, 11, 9, 9, 11, 10, -1, -1, -1, -1, -1, -1, -1},
-        {9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {9, 5, 4, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 5, 4, 1, 5, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {8, 5, 4, 8, 3, 5, 3, 1, 5, -1, -1, -1, -1, -1, -1, -1},
-        {1, 2, 10, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {3, 0, 8, 1, 2, 10, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
-        {5, 2, 10, 5, 4, 2, 4, 0, 2, -1, -1, -1, -1, -1, -1, -1},
-        {2, 10, 5, 3, 2, 5, 3, 5, 4, 3, 4, 8, -1, -1, -1, -1},
-        {9, 5, 4, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 11, 2, 0, 8, 11, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
-        {0, 5, 4, 0, 1, 5, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
-        {2, 1, 5, 2, 5, 8, 2, 8, 11, 4, 8, 5, -1, -1, -1, -1},
-        {10, 3, 11, 10, 1, 3, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1},
-        {4, 9, 5, 0, 8, 1, 8, 10, 1, 8, 11, 10, -1, -1, -1, -1},
-        {5, 4, 0, 5, 0, 11, 5, 11, 10, 11, 0, 3, -1, -1, -1, -1},
-        {5, 4, 8, 5, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1},
-        {9, 7, 8, 5, 7, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {9, 3, 0, 9, 5, 3, 5, 7, 3, -1, -1, -1, -1, -1, -1, -1},
-        {0, 7, 8, 0, 1, 7, 1, 5, 7, -1, -1, -1, -1, -1, -1, -1},
-        {1, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {9, 7, 8, 9, 5, 7, 10, 1, 2, -1, -1, -1, -1, -1, -1, -1},
-        {10, 1, 2, 9, 5, 0, 5, 3, 0, 5, 7, 3, -1, -1, -1, -1},
-        {8, 0, 2, 8, 2, 5, 8, 5, 7, 10, 5, 2, -1, -1, -1, -1},
-        {2, 10, 5, 2, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1},
-        {7, 9, 5, 7, 8, 9, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1},
-        {9, 5, 7, 9, 7, 2, 9, 2, 0, 2, 7, 11, -1, -1, -1, -1},
-        {2, 3, 11, 0, 1, 8, 1, 7, 8, 1, 5, 7, -1, -1, -1, -1},
-        {11, 2, 1, 11, 1, 7, 7, 1, 5, -1, -1, -1, -1, -1, -1, -1},
-        {9, 5, 8, 8, 5, 7, 10, 1, 3, 10, 3, 11, -1, -1, -1, -1},
-        {5, 7, 0, 5, 0, 9, 7, 11, 0, 1, 0, 10, 11, 10, 0, -1},
-        {11, 10, 0, 11, 0, 3, 10, 5, 0, 8, 0, 7, 5, 7, 0, -1},
-        {11, 10, 5, 7, 11, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 8, 3, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {9, 0, 1, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 8, 3, 1, 9, 8, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
-        {1, 6, 5, 2, 6, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 6, 5, 1, 2, 6, 3, 0, 8, -1, -1, -1, -1, -1, -1, -1},
-        {9, 6, 5, 9, 0, 6, 0, 2, 6, -1, -1, -1, -1, -1, -1, -1},
-        {5, 9, 8, 5, 8, 2, 5, 2, 6, 3, 2, 8, -1, -1, -1, -1},
-        {2, 3, 11, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {11, 0, 8, 11, 2, 0, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
-        {0, 1, 9, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
-        {5, 10, 6, 1, 9, 2, 9, 11, 2, 9, 8, 11, -1, -1, -1, -1},
-        {6, 3, 11, 6, 5, 3, 5, 1, 3, -1, -1, -1, -1, -1, -1, -1},
-        {0, 8, 11, 0, 11, 5, 0, 5, 1, 5, 11, 6, -1, -1, -1, -1},
-        {3, 11, 6, 0, 3, 6, 0, 6, 5, 0, 5, 9, -1, -1, -1, -1},
-        {6, 5, 9, 6, 9, 11, 11, 9, 8, -1, -1, -1, -1, -1, -1, -1},
-        {5, 10, 6, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {4, 3, 0, 4, 7, 3, 6, 5, 10, -1, -1, -1, -1, -1, -1, -1},
-        {1, 9, 0, 5, 10, 6, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
-        {10, 6, 5, 1, 9, 7, 1, 7, 3, 7, 9, 4, -1, -1, -1, -1},
-        {6, 1, 2, 6, 5, 1, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1},
-        {1, 2, 5, 5, 2, 6, 3, 0, 4, 3, 4, 7, -1, -1, -1, -1},
-        {8, 4, 7, 9, 0, 5, 0, 6, 5, 0, 2, 6, -1, -1, -1, -1},
-        {7, 3, 9, 7, 9, 4, 3, 2, 9, 5, 9, 6, 2, 6, 9, -1},
-        {3, 11, 2, 7, 8, 4, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
-        {5, 10, 6, 4, 7, 2, 4, 2, 0, 2, 7, 11, -1, -1, -1, -1},
-        {0, 1, 9, 4, 7, 8, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1},
-        {9, 2, 1, 9, 11, 2, 9, 4, 11, 7, 11, 4, 5, 10, 6, -1},
-        {8, 4, 7, 3, 11, 5, 3, 5, 1, 5, 11, 6, -1, -1, -1, -1},
-        {5, 1, 11, 5, 11, 6, 1, 0, 11, 7, 11, 4, 0, 4, 11, -1},
-        {0, 5, 9, 0, 6, 5, 0, 3, 6, 11, 6, 3, 8, 4, 7, -1},
-        {6, 5, 9, 6, 9, 11, 4, 7, 9, 7, 11, 9, -1, -1, -1, -1},
-        {10, 4, 9, 6, 4, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {4, 10, 6, 4, 9, 10, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1},
-        {10, 0, 1, 10, 6, 0, 6, 4, 0, -1, -1, -1, -1, -1, -1, -1},
-        {8, 3, 1, 8, 1, 6, 8, 6, 4, 6, 1, 10, -1, -1, -1, -1},
-        {1, 4, 9, 1, 2, 4, 2, 6, 4, -1, -1, -1, -1, -1, -1, -1},
-        {3, 0, 8, 1, 2, 9, 2, 4, 9, 2, 6, 4, -1, -1, -1, -1},
-        {0, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {8, 3, 2, 8, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1},
-        {10, 4, 9, 10, 6, 4, 11, 2, 3, -1, -1, -1, -1, -1, -1, -1},
-        {0, 8, 2, 2, 8, 11, 4, 9, 10, 4, 10, 6, -1, -1, -1, -1},
-        {3, 11, 2, 0, 1, 6, 0, 6, 4, 6, 1, 10, -1, -1, -1, -1},
-        {6, 4, 1, 6, 1, 10, 4, 8, 1, 2, 1, 11, 8, 11, 1, -1},
-        {9, 6, 4, 9, 3, 6, 9, 1, 3, 11, 6, 3, -1, -1, -1, -1},
-        {8, 11, 1, 8, 1, 0, 11, 6, 1, 9, 1, 4, 6, 4, 1, -1},
-        {3, 11, 6, 3, 6, 0, 0, 6, 4, -1, -1, -1, -1, -1, -1, -1},
-        {6, 4, 8, 11, 6, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {7, 10, 6, 7, 8, 10, 8, 9, 10, -1, -1, -1, -1, -1, -1, -1},
-        {0, 7, 3, 0, 10, 7, 0, 9, 10, 6, 7, 10, -1, -1, -1, -1},
-        {10, 6, 7, 1, 10, 7, 1, 7, 8, 1, 8, 0, -1, -1, -1, -1},
-        {10, 6, 7, 10, 7, 1, 1, 7, 3, -1, -1, -1, -1, -1, -1, -1},
-        {1, 2, 6, 1, 6, 8, 1, 8, 9, 8, 6, 7, -1, -1, -1, -1},
-        {2, 6, 9, 2, 9, 1, 6, 7, 9, 0, 9, 3, 7, 3, 9, -1},
-        {7, 8, 0, 7, 0, 6, 6, 0, 2, -1, -1, -1, -1, -1, -1, -1},
-        {7, 3, 2, 6, 7, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {2, 3, 11, 10, 6, 8, 10, 8, 9, 8, 6, 7, -1, -1, -1, -1},
-        {2, 0, 7, 2, 7, 11, 0, 9, 7, 6, 7, 10, 9, 10, 7, -1},
-        {1, 8, 0, 1, 7, 8, 1, 10, 7, 6, 7, 10, 2, 3, 11, -1},
-        {11, 2, 1, 11, 1, 7, 10, 6, 1, 6, 7, 1, -1, -1, -1, -1},
-        {8, 9, 6, 8, 6, 7, 9, 1, 6, 11, 6, 3, 1, 3, 6, -1},
-        {0, 9, 1, 11, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {7, 8, 0, 7, 0, 6, 3, 11, 0, 11, 6, 0, -1, -1, -1, -1},
-        {7, 11, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {3, 0, 8, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 1, 9, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {8, 1, 9, 8, 3, 1, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
-        {10, 1, 2, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 2, 10, 3, 0, 8, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
-        {2, 9, 0, 2, 10, 9, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
-        {6, 11, 7, 2, 10, 3, 10, 8, 3, 10, 9, 8, -1, -1, -1, -1},
-        {7, 2, 3, 6, 2, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {7, 0, 8, 7, 6, 0, 6, 2, 0, -1, -1, -1, -1, -1, -1, -1},
-        {2, 7, 6, 2, 3, 7, 0, 1, 9, -1, -1, -1, -1, -1, -1, -1},
-        {1, 6, 2, 1, 8, 6, 1, 9, 8, 8, 7, 6, -1, -1, -1, -1},
-        {10, 7, 6, 10, 1, 7, 1, 3, 7, -1, -1, -1, -1, -1, -1, -1},
-        {10, 7, 6, 1, 7, 10, 1, 8, 7, 1, 0, 8, -1, -1, -1, -1},
-        {0, 3, 7, 0, 7, 10, 0, 10, 9, 6, 10, 7, -1, -1, -1, -1},
-        {7, 6, 10, 7, 10, 8, 8, 10, 9, -1, -1, -1, -1, -1, -1, -1},
-        {6, 8, 4, 11, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {3, 6, 11, 3, 0, 6, 0, 4, 6, -1, -1, -1, -1, -1, -1, -1},
-        {8, 6, 11, 8, 4, 6, 9, 0, 1, -1, -1, -1, -1, -1, -1, -1},
-        {9, 4, 6, 9, 6, 3, 9, 3, 1, 11, 3, 6, -1, -1, -1, -1},
-        {6, 8, 4, 6, 11, 8, 2, 10, 1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 2, 10, 3, 0, 11, 0, 6, 11, 0, 4, 6, -1, -1, -1, -1},
-        {4, 11, 8, 4, 6, 11, 0, 2, 9, 2, 10, 9, -1, -1, -1, -1},
-        {10, 9, 3, 10, 3, 2, 9, 4, 3, 11, 3, 6, 4, 6, 3, -1},
-        {8, 2, 3, 8, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1},
-        {0, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 9, 0, 2, 3, 4, 2, 4, 6, 4, 3, 8, -1, -1, -1, -1},
-        {1, 9, 4, 1, 4, 2, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1},
-        {8, 1, 3, 8, 6, 1, 8, 4, 6, 6, 10, 1, -1, -1, -1, -1},
-        {10, 1, 0, 10, 0, 6, 6, 0, 4, -1, -1, -1, -1, -1, -1, -1},
-        {4, 6, 3, 4, 3, 8, 6, 10, 3, 0, 3, 9, 10, 9, 3, -1},
-        {10, 9, 4, 6, 10, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {4, 9, 5, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 8, 3, 4, 9, 5, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
-        {5, 0, 1, 5, 4, 0, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
-        {11, 7, 6, 8, 3, 4, 3, 5, 4, 3, 1, 5, -1, -1, -1, -1},
-        {9, 5, 4, 10, 1, 2, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
-        {6, 11, 7, 1, 2, 10, 0, 8, 3, 4, 9, 5, -1, -1, -1, -1},
-        {7, 6, 11, 5, 4, 10, 4, 2, 10, 4, 0, 2, -1, -1, -1, -1},
-        {3, 4, 8, 3, 5, 4, 3, 2, 5, 10, 5, 2, 11, 7, 6, -1},
-        {7, 2, 3, 7, 6, 2, 5, 4, 9, -1, -1, -1, -1, -1, -1, -1},
-        {9, 5, 4, 0, 8, 6, 0, 6, 2, 6, 8, 7, -1, -1, -1, -1},
-        {3, 6, 2, 3, 7, 6, 1, 5, 0, 5, 4, 0, -1, -1, -1, -1},
-        {6, 2, 8, 6, 8, 7, 2, 1, 8, 4, 8, 5, 1, 5, 8, -1},
-        {9, 5, 4, 10, 1, 6, 1, 7, 6, 1, 3, 7, -1, -1, -1, -1},
-        {1, 6, 10, 1, 7, 6, 1, 0, 7, 8, 7, 0, 9, 5, 4, -1},
-        {4, 0, 10, 4, 10, 5, 0, 3, 10, 6, 10, 7, 3, 7, 10, -1},
-        {7, 6, 10, 7, 10, 8, 5, 4, 10, 4, 8, 10, -1, -1, -1, -1},
-        {6, 9, 5, 6, 11, 9, 11, 8, 9, -1, -1, -1, -1, -1, -1, -1},
-        {3, 6, 11, 0, 6, 3, 0, 5, 6, 0, 9, 5, -1, -1, -1, -1},
-        {0, 11, 8, 0, 5, 11, 0, 1, 5, 5, 6, 11, -1, -1, -1, -1},
-        {6, 11, 3, 6, 3, 5, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 2, 10, 9, 5, 11, 9, 11, 8, 11, 5, 6, -1, -1, -1, -1},
-        {0, 11, 3, 0, 6, 11, 0, 9, 6, 5, 6, 9, 1, 2, 10, -1},
-        {11, 8, 5, 11, 5, 6, 8, 0, 5, 10, 5, 2, 0, 2, 5, -1},
-        {6, 11, 3, 6, 3, 5, 2, 10, 3, 10, 5, 3, -1, -1, -1, -1},
-        {5, 8, 9, 5, 2, 8, 5, 6, 2, 3, 8, 2, -1, -1, -1, -1},
-        {9, 5, 6, 9, 6, 0, 0, 6, 2, -1, -1, -1, -1, -1, -1, -1},
-        {1, 5, 8, 1, 8, 0, 5, 6, 8, 3, 8, 2, 6, 2, 8, -1},
-        {1, 5, 6, 2, 1, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 3, 6, 1, 6, 10, 3, 8, 6, 5, 6, 9, 8, 9, 6, -1},
-        {10, 1, 0, 10, 0, 6, 9, 5, 0, 5, 6, 0, -1, -1, -1, -1},
-        {0, 3, 8, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {10, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {11, 5, 10, 7, 5, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {11, 5, 10, 11, 7, 5, 8, 3, 0, -1, -1, -1, -1, -1, -1, -1},
-        {5, 11, 7, 5, 10, 11, 1, 9, 0, -1, -1, -1, -1, -1, -1, -1},
-        {10, 7, 5, 10, 11, 7, 9, 8, 1, 8, 3, 1, -1, -1, -1, -1},
-        {11, 1, 2, 11, 7, 1, 7, 5, 1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 8, 3, 1, 2, 7, 1, 7, 5, 7, 2, 11, -1, -1, -1, -1},
-        {9, 7, 5, 9, 2, 7, 9, 0, 2, 2, 11, 7, -1, -1, -1, -1},
-        {7, 5, 2, 7, 2, 11, 5, 9, 2, 3, 2, 8, 9, 8, 2, -1},
-        {2, 5, 10, 2, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1},
-        {8, 2, 0, 8, 5, 2, 8, 7, 5, 10, 2, 5, -1, -1, -1, -1},
-        {9, 0, 1, 5, 10, 3, 5, 3, 7, 3, 10, 2, -1, -1, -1, -1},
-        {9, 8, 2, 9, 2, 1, 8, 7, 2, 10, 2, 5, 7, 5, 2, -1},
-        {1, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 8, 7, 0, 7, 1, 1, 7, 5, -1, -1, -1, -1, -1, -1, -1},
-        {9, 0, 3, 9, 3, 5, 5, 3, 7, -1, -1, -1, -1, -1, -1, -1},
-        {9, 8, 7, 5, 9, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {5, 8, 4, 5, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1},
-        {5, 0, 4, 5, 11, 0, 5, 10, 11, 11, 3, 0, -1, -1, -1, -1},
-        {0, 1, 9, 8, 4, 10, 8, 10, 11, 10, 4, 5, -1, -1, -1, -1},
-        {10, 11, 4, 10, 4, 5, 11, 3, 4, 9, 4, 1, 3, 1, 4, -1},
-        {2, 5, 1, 2, 8, 5, 2, 11, 8, 4, 5, 8, -1, -1, -1, -1},
-        {0, 4, 11, 0, 11, 3, 4, 5, 11, 2, 11, 1, 5, 1, 11, -1},
-        {0, 2, 5, 0, 5, 9, 2, 11, 5, 4, 5, 8, 11, 8, 5, -1},
-        {9, 4, 5, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {2, 5, 10, 3, 5, 2, 3, 4, 5, 3, 8, 4, -1, -1, -1, -1},
-        {5, 10, 2, 5, 2, 4, 4, 2, 0, -1, -1, -1, -1, -1, -1, -1},
-        {3, 10, 2, 3, 5, 10, 3, 8, 5, 4, 5, 8, 0, 1, 9, -1},
-        {5, 10, 2, 5, 2, 4, 1, 9, 2, 9, 4, 2, -1, -1, -1, -1},
-        {8, 4, 5, 8, 5, 3, 3, 5, 1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 4, 5, 1, 0, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {8, 4, 5, 8, 5, 3, 9, 0, 5, 0, 3, 5, -1, -1, -1, -1},
-        {9, 4, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {4, 11, 7, 4, 9, 11, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1},
-        {0, 8, 3, 4, 9, 7, 9, 11, 7, 9, 10, 11, -1, -1, -1, -1},
-        {1, 10, 11, 1, 11, 4, 1, 4, 0, 7, 4, 11, -1, -1, -1, -1},
-        {3, 1, 4, 3, 4, 8, 1, 10, 4, 7, 4, 11, 10, 11, 4, -1},
-        {4, 11, 7, 9, 11, 4, 9, 2, 11, 9, 1, 2, -1, -1, -1, -1},
-        {9, 7, 4, 9, 11, 7, 9, 1, 11, 2, 11, 1, 0, 8, 3, -1},
-        {11, 7, 4, 11, 4, 2, 2, 4, 0, -1, -1, -1, -1, -1, -1, -1},
-        {11, 7, 4, 11, 4, 2, 8, 3, 4, 3, 2, 4, -1, -1, -1, -1},
-        {2, 9, 10, 2, 7, 9, 2, 3, 7, 7, 4, 9, -1, -1, -1, -1},
-        {9, 10, 7, 9, 7, 4, 10, 2, 7, 8, 7, 0, 2, 0, 7, -1},
-        {3, 7, 10, 3, 10, 2, 7, 4, 10, 1, 10, 0, 4, 0, 10, -1},
-        {1, 10, 2, 8, 7, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {4, 9, 1, 4, 1, 7, 7, 1, 3, -1, -1, -1, -1, -1, -1, -1},
-        {4, 9, 1, 4, 1, 7, 0, 8, 1, 8, 7, 1, -1, -1, -1, -1},
-        {4, 0, 3, 7, 4, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {9, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {3, 0, 9, 3, 9, 11, 11, 9, 10, -1, -1, -1, -1, -1, -1, -1},
-        {0, 1, 10, 0, 10, 8, 8, 10, 11, -1, -1, -1, -1, -1, -1, -1},
-        {3, 1, 10, 11, 3, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 2, 11, 1, 11, 9, 9, 11, 8, -1, -1, -1, -1, -1, -1, -1},
-        {3, 0, 9, 3, 9, 11, 1, 2, 9, 2, 11, 9, -1, -1, -1, -1},
-        {0, 2, 11, 8, 0, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {3, 2, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {2, 3, 8, 2, 8, 10, 10, 8, 9, -1, -1, -1, -1, -1, -1, -1},
-        {9, 10, 2, 0, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {2, 3, 8, 2, 8, 10, 0, 1, 8, 1, 10, 8, -1, -1, -1, -1},
-        {1, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {1, 3, 8, 9, 1, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 9, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-        {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}};
- 
- 
-    if (edgeTable[config] == 0) return {};
- 
-    int edges[12][2] = {{0,1},{1,2},{2,3},{3,0},{4,5},{5,6},{6,7},{7,4},{0,4},{1,5},{2,6},{3,7}};
-    Point3D edge_points[12];
- 
-    if (edgeTable[config] & 1) edge_points[0] = interpolate_3d(vertices[0], vertices[1], values[0], values[1]);
-    if (edgeTable[config] & 2) edge_points[1] = interpolate_3d(vertices[1], vertices[2], values[1], values[2]);
-    if (edgeTable[config] & 4) edge_points[2] = interpolate_3d(vertices[2], vertices[3], values[2], values[3]);
-    if (edgeTable[config] & 8) edge_points[3] = interpolate_3d(vertices[3], vertices[0], values[3], values[0]);
-    if (edgeTable[config] & 16) edge_points[4] = interpolate_3d(vertices[4], vertices[5], values[4], values[5]);
-    if (edgeTable[config] & 32) edge_points[5] = interpolate_3d(vertices[5], vertices[6], values[5], values[6]);
-    if (edgeTable[config] & 64) edge_points[6] = interpolate_3d(vertices[6], vertices[7], values[6], values[7]);
-    if (edgeTable[config] & 128) edge_points[7] = interpolate_3d(vertices[7], vertices[4], values[7], values[4]);
-    if (edgeTable[config] & 256) edge_points[8] = interpolate_3d(vertices[0], vertices[4], values[0], values[4]);
-    if (edgeTable[config] & 512) edge_points[9] = interpolate_3d(vertices[1], vertices[5], values[1], values[5]);
-    if (edgeTable[config] & 1024) edge_points[10] = interpolate_3d(vertices[2], vertices[6], values[2], values[6]);
-    if (edgeTable[config] & 2048) edge_points[11] = interpolate_3d(vertices[3], vertices[7], values[3], values[7]);
- 
-    vector<Triangle> triangles;
-    for (int i = 0; triTable[config][i] != -1; i += 3) {
-        triangles.push_back(Triangle(
-            edge_points[triTable[config][i]],
-            edge_points[triTable[config][i+1]],
-            edge_points[triTable[config][i+2]]
-        ));
-    }
- 
-    return triangles;
+// --memory-budget: la sopa se junta en un SpillingSink. Si entró en el
+// presupuesto se suelda y sigue el camino de siempre; si parte fue a disco se
+// escribe sin soldar leyendo los trozos, y el post-proceso no se aplica.
+void draw_budgeted_surface(const Extractor& extractor, const vector<string>& filenames, const PostOptions& post,
+                           const NarrowBandRecorder* recorder, const string& volume_filename, size_t memory_budget,
+                           const string& spill_directory) {
+    const vector<double>& isovalues = extractor.config.isovalues;
+    bool multi = isovalues.size() > 1;
+    TaskTracer* tracer = extractor.config.tracer;
+    double t0 = omp_get_wtime();
+    SpillingSink sink(isovalues.size(), memory_budget, spill_directory);
+    ExtractionStats stats = extractor.extract(sink);
+    if (tracer) tracer->span("extract", t0, omp_get_wtime());
+    if (!sink.ok()) {
+        cerr << "Error writing the spill file" << endl;
+        return;
+    }
+    if (sink.spilled()) {
+        cout << "Memory budget of " << format_bytes(memory_budget) << " exceeded: " << sink.spilled_triangles() << " triangles ("
+             << format_bytes(sink.disk_bytes()) << ") spilled to disk, writing the unwelded soup" << endl;
+        if (post.needs_indexed_mesh()) cerr << "Post-processing skipped: it needs the welded mesh in memory" << endl;
+    }
+    if (recorder) save_narrow_band(*recorder, volume_filename);
+
+    for (size_t k = 0; k < isovalues.size(); k++) {
+        t0 = omp_get_wtime();
+        IndexedMesh mesh;
+        if (multi) cout << "Isovalue " << isovalues[k] << ": ";
+        else cout << "Generated ";
+        if (sink.spilled()) {
+            cout << sink.triangle_count(k) << " triangles, " << sink.spilled_triangles(k) << " from disk";
+        } else {
+            mesh = weld_soup(sink.take_soup(k), extractor.attribute_name_list());
+            cout << mesh.triangle_count() << " triangles, " << mesh.vertices.size() << " vertices";
+        }
+        if (multi) cout << " -> " << filenames[k];
+        cout << endl;
+
+        bool written;
+        if (sink.spilled()) {
+            written = write_spilled(filenames[k], sink, k, extractor.attribute_name_list());
+        } else {
+            post_process(mesh, post, extractor.field(), isovalues[k]);
+            written = write_mesh(filenames[k], mesh);
+        }
+        if (!written) {
+            cerr << "Error writing file: " << filenames[k] << endl;
+            return;
+        }
+        if (tracer) tracer->span("write", t0, omp_get_wtime());
+    }
+    if (stats.expired) write_fallback(stats, extractor.fallback_meshes(stats), filenames);
 }
 
-vector<Triangle> surface_to_triangles(double (*f)(double, double, double), Point3D start, Point3D end, double precision) {
-    vector<Triangle> triangles;
+void draw_surface(const Extractor& extractor, const string& output_filename, const PostOptions& post = PostOptions(),
+                  const NarrowBandRecorder* recorder = nullptr, const string& volume_filename = "", int preview_depth = -1,
+                  size_t memory_budget = 0, const string& spill_directory = "") {
+    const vector<double>& isovalues = extractor.config.isovalues;
+    bool multi = isovalues.size() > 1;
+    vector<string> filenames;
+    for (size_t k = 0; k < isovalues.size(); k++) filenames.push_back(multi ? isovalue_filename(output_filename, k) : output_filename);
 
-    if (end.x - start.x < precision || end.y - start.y < precision || end.z - start.z < precision) {
-        return marching_cubes(start, end, f);
+    if (memory_budget > 0) {
+        draw_budgeted_surface(extractor, filenames, post, recorder, volume_filename, memory_budget, spill_directory);
+        return;
     }
 
-    if (!cube_contains_surface(f, start, end)) {
-        return triangles;
-    }
+    // Los motores duales, los atributos y los formatos distintos de OBJ necesitan la malla soldada
+    bool indexed = is_dual(extractor.config.engine) || post.needs_indexed_mesh() || !extractor.attribute_name_list().empty() ||
+                   mesh_format(output_filename) != MeshFormat::Obj || preview_depth >= 0;
 
-    double mid_x = (start.x + end.x) / 2;
-    double mid_y = (start.y + end.y) / 2;
-    double mid_z = (start.z + end.z) / 2;
+    if (!indexed) {
+        ObjStreamSink sink(filenames);
+        if (!sink.is_open()) {
+            cerr << "Error opening file: " << output_filename << endl;
+            return;
+        }
+        double t0 = omp_get_wtime();
+        ExtractionStats stats = extractor.extract(sink);
+        if (extractor.config.tracer) extractor.config.tracer->span("extract and write", t0, omp_get_wtime());
+        for (size_t k = 0; k < isovalues.size(); k++) {
+            if (multi) cout << "Isovalue " << isovalues[k] << ": " << stats.triangles[k] << " triangles -> " << filenames[k] << endl;
+            else cout << "Generated " << stats.triangles[k] << " triangles" << endl;
+        }
+        if (recorder) save_narrow_band(*recorder, volume_filename);
+        if (stats.expired) write_fallback(stats, extractor.fallback_meshes(stats), filenames);
+        return;
+    }
 
-    Point3D mid(mid_x, mid_y, mid_z);
+    TaskTracer* tracer = extractor.config.tracer;
+    double t0 = omp_get_wtime();
+    ExtractionStats stats;
+    vector<IndexedMesh> meshes;
+    if (preview_depth >= 0) {
+        // Con plazo, el nivel en curso al vencer sale como final: no hace falta respaldo
+        PreviewWriter writer(filenames, extractor.attribute_name_list());
+        stats = extractor.extract_progressive(writer, preview_depth);
+        meshes.swap(writer.meshes);
+    } else {
+        vector<IndexedMesh> fallback;
+        meshes = extractor.extract_meshes(&stats, &fallback);
+        if (stats.expired) write_fallback(stats, fallback, filenames);
+    }
+    if (tracer) tracer->span("extract", t0, omp_get_wtime());
+    for (size_t k = 0; k < meshes.size(); k++) {
+        IndexedMesh& mesh = meshes[k];
+        if (multi) cout << "Isovalue " << isovalues[k] << ": ";
+        else cout << "Generated ";
+        cout << mesh.triangle_count() << " triangles, " << mesh.vertices.size() << " vertices";
+        if (mesh.has_attributes()) cout << ", " << mesh.attribute_count() << " attributes per vertex";
+        if (multi) cout << " -> " << filenames[k];
+        cout << endl;
+    }
+    if (recorder) save_narrow_band(*recorder, volume_filename);
+    for (size_t k = 0; k < meshes.size(); k++) {
+        t0 = omp_get_wtime();
+        post_process(meshes[k], post, extractor.field(), isovalues[k]);
+        if (tracer) tracer->span("post-process", t0, omp_get_wtime());
+        t0 = omp_get_wtime();
+        if (!write_mesh(filenames[k], meshes[k])) {
+            cerr << "Error opening file: " << filenames[k] << endl;
+            return;
+        }
+        if (tracer) tracer->span("write", t0, omp_get_wtime());
+        meshes[k] = IndexedMesh();
+    }
+}
 
-    vector<vector<Triangle>> sub_results(8);
+// Atributos de ejemplo para --attribute
+double radius_attribute(double x, double y, double z) { return sqrt(x * x + y * y + z * z); }
+double height_attribute(double, double, double z) { return z; }
+
+// |grad f| por diferencias centrales; data es el campo principal
+double gradient_attribute(const void* data, double x, double y, double z) {
+    const ScalarField& f = *(const ScalarField*)data;
+    const double h = 1e-5;
+    double gx = f(x + h, y, z) - f(x - h, y, z);
+    double gy = f(x, y + h, z) - f(x, y - h, z);
+    double gz = f(x, y, z + h) - f(x, y, z - h);
+    return sqrt(gx * gx + gy * gy + gz * gz) / (2 * h);
+}
 
-   #pragma omp parallel
-    {
-        #pragma omp single nowait
-        {
-            #pragma omp task shared(sub_results)
-            sub_results[0] = surface_to_triangles(f, start, mid, precision);
+// Throughput del kernel de celda con cada tabla sobre una grilla densa, sin el
+// descarte del octree para medir sólo la clasificación y la triangulación.
+void benchmark_cell_tables(const ScalarField& f, Point3D start, Point3D end, double precision, double snap = 0,
+                           double isovalue = 0) {
+    int n = max(1, (int)((end.x - start.x) / precision));
+    double hx = (end.x - start.x) / n, hy = (end.y - start.y) / n, hz = (end.z - start.z) / n;
+    long cells = (long)n * n * n;
+
+    CellTable tables[2] = {CellTable::Classic, CellTable::AsymptoticDecider};
+    const char* names[2] = {"classic", "mc33"};
+    for (int t = 0; t < 2; t++) {
+        long triangle_count = 0;
+        double t0 = omp_get_wtime();
+        #pragma omp parallel for collapse(2) schedule(dynamic, 16) reduction(+:triangle_count)
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                for (int k = 0; k < n; k++) {
+                    Point3D s(start.x + i * hx, start.y + j * hy, start.z + k * hz);
+                    Point3D e(start.x + (i + 1) * hx, start.y + (j + 1) * hy, start.z + (k + 1) * hz);
+                    triangle_count += cell_triangles(s, e, f, CellOptions(tables[t], snap, isovalue)).size();
+                }
+            }
+        }
+        double elapsed = omp_get_wtime() - t0;
+        cout << "Kernel " << names[t] << ": " << cells << " cells, " << triangle_count << " triangles, "
+             << elapsed << " s, " << cells / elapsed / 1e6 << " Mcells/s" << endl;
+    }
+}
 
-            #pragma omp task shared(sub_results)
-            sub_results[1] = surface_to_triangles(f, Point3D(mid_x, start.y, start.z), Point3D(end.x, mid_y, mid_z), precision);
+// "1,2,4" -> {"1", "2", "4"}
+vector<string> split_list(const string& text) {
+    vector<string> items;
+    stringstream stream(text);
+    string item;
+    while (getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
 
-            #pragma omp task shared(sub_results)
-            sub_results[2] = surface_to_triangles(f, Point3D(start.x, mid_y, start.z), Point3D(mid_x, end.y, mid_z), precision);
+// Barrido de escalabilidad (scaling.h): prefix.csv y prefix.json
+int run_scaling_sweep(const Extractor& model, const ScalingOptions& options, const string& prefix) {
+    vector<ScalingResult> results = run_scaling(model, options, [](const ScalingResult& r) {
+        const PhaseSamples* total = r.phase("total");
+        cout << scaling_mode_name(r.mode) << " " << r.surface << " " << engine_name(r.engine) << " precision " << r.precision
+             << " (" << r.grid << "^3";
+        if (r.tiles > 1) cout << ", " << r.tiles << "^3 copies";
+        cout << "), " << r.threads << " threads: " << r.triangles << " triangles, median " << total->median << " s ["
+             << total->ci_low << ", " << total->ci_high << "], efficiency " << total->efficiency;
+        // Dónde se pierde: el exceso sobre el ideal de cada fase
+        if (total->efficiency < 1) {
+            cout << " (excess";
+            for (const auto& p : r.phases) {
+                if (p.phase != "total") cout << " " << p.phase << " " << p.excess << " s";
+            }
+            cout << ")";
+        }
+        cout << endl;
+    });
+    if (results.empty()) return 1;
+    if (!write_scaling_csv(prefix + ".csv", results, options) || !write_scaling_json(prefix + ".json", results, options)) {
+        cerr << "Error opening file: " << prefix << ".csv/.json" << endl;
+        return 1;
+    }
+    cout << "Scaling results written to " << prefix << ".csv and " << prefix << ".json" << endl;
+    return 0;
+}
 
-            #pragma omp task shared(sub_results)
-            sub_results[3] = surface_to_triangles(f, Point3D(mid_x, mid_y, start.z), Point3D(end.x, end.y, mid_z), precision);
+// Corpus de referencia (corpus.h): 0 si todo coincide con lo esperado, 2 si no
+int run_corpus_check(int warmup, int repetitions) {
+    bool ok = true;
+    run_corpus(warmup, repetitions, [&](const CorpusResult& r) {
+        char hash[32];
+        snprintf(hash, sizeof(hash), "%016" PRIx64, r.hash);
+        cout << left << setw(11) << r.entry.surface << setw(4) << engine_name(r.entry.engine) << right << " precision "
+             << r.entry.precision << " (" << r.grid << "^3): " << r.triangles << " triangles, hash " << hash << ", median "
+             << r.time.median << " s [" << r.time.ci_low << ", " << r.time.ci_high << "]";
+        if (!r.stable) cout << "  UNSTABLE (the mesh changed between repetitions)";
+        else if (r.matches()) cout << "  ok";
+        else {
+            snprintf(hash, sizeof(hash), "%016" PRIx64, r.entry.hash);
+            cout << "  MISMATCH (expected " << r.entry.triangles << " triangles, hash " << hash << ")";
+        }
+        cout << endl;
+        ok = ok && r.matches();
+    });
+    return ok ? 0 : 2;
+}
 
-            #pragma omp task shared(sub_results)
-            sub_results[4] = surface_to_triangles(f, Point3D(start.x, start.y, mid_z), Point3D(mid_x, mid_y, end.z), precision);
+// Techos de la máquina y posición de cada kernel (roofline.h)
+int run_roofline_report(const ScalarField& f, const FieldCost& cost, Point3D start, Point3D end, double precision,
+                        double isovalue, int warmup, int repetitions) {
+    RooflineReport report;
+    if (!run_roofline(f, cost, start, end, precision, isovalue, warmup, repetitions, report)) return 1;
+    const RooflinePeaks& peaks = report.peaks;
+    cout << "Roofline, " << omp_get_max_threads() << " threads, grid " << report.grid << "^3 (precision " << precision << "), "
+         << report.triangles << " triangles" << endl;
+    cout << "Compute peak (multiply-add probe): " << peaks.flops / 1e9 << " GFLOP/s" << endl;
+    cout << "Bandwidth (STREAM): copy " << peaks.copy / 1e9 << ", scale " << peaks.scale / 1e9 << ", add " << peaks.add / 1e9
+         << ", triad " << peaks.triad / 1e9 << " GB/s; peak " << peaks.bandwidth / 1e9 << " GB/s" << endl;
+    cout << "Ridge point: " << peaks.ridge() << " FLOP/byte" << endl;
+    for (const auto& k : report.kernels) {
+        cout << left << setw(10) << k.name << right << " " << k.seconds << " s, " << k.flop_rate() / 1e9 << " GFLOP/s, "
+             << k.byte_rate() / 1e9 << " GB/s, intensity " << k.intensity() << " FLOP/byte, "
+             << (k.memory_bound(peaks) ? "memory" : "compute") << "-bound, " << 100 * k.roof_fraction(peaks) << "% of "
+             << (k.flops > 0 ? "roof" : "bandwidth") << endl;
+    }
+    return 0;
+}
 
-            #pragma omp task shared(sub_results)
-            sub_results[5] = surface_to_triangles(f, Point3D(mid_x, start.y, mid_z), Point3D(end.x, mid_y, end.z), precision);
+// Uso: ./paralelo [threads] [precision] [--engine mc|mc33|surfacenets|dc] [--output archivo.obj] [--kernel-bench]
+//                 [--snap fracción] [--sdf-volume archivo.sdfv]
+//                 [--volume archivo.raw --volume-dims NX NY NZ] [--volume-type u8|u16|f32]
+//                 [--volume-threshold T] [--tricubic] [--isovalue v]...
+//                 [--attribute radius|height|gradient]... [--attribute-volume nombre archivo.raw]...
+//                 [--surface barth|sphere|torus|gyroid|mandelbulb|terrain|csg] [--field "expresión en x,y,z"] [--bounds xmin ymin zmin xmax ymax zmax]
+//                 [--serve socket [--serve-workers N] [--job-memory MB]]
+//                 [--time-limit segundos] [--fallback-share fracción] [--progressive [--preview-depth N]]
+//                 [--memory-budget MB [--spill-dir directorio]]
+//                 [--progress segundos] [--trace archivo.json [--trace-events N]]
+//                 [--decimate triángulos] [--decimate-error error]
+//                 [--smooth N] [--taubin N] [--normals area|angle]
+//                 [--components] [--min-component-triangles N] [--min-component-area A]
+//                 [--validate] [--validate-obj archivo.obj]
+//                 [--corpus [--repetitions N] [--warmup N]] [--roofline [--repetitions N] [--warmup N]]
+//                 [--scaling prefijo [--scaling-mode strong,weak] [--sweep-threads 1,2,4] [--sweep-precisions 0.1,0.05]
+//                  [--sweep-surfaces barth,sphere] [--sweep-engines mc,dc] [--repetitions N] [--warmup N]]
+int main(int argc, char* argv[]) {
+    int threads = 8;  // o la cantidad que tenga tu procesador
+    double precision = 0.1;
+    Engine engine = Engine::MarchingCubes;
+    string output_filename = "surface.obj";
+    bool kernel_bench = false;
+    double snap = 0;
+    string volume_filename;
+    string input_volume;
+    int volume_dims[3] = {0, 0, 0};
+    VoxelType voxel_type = VoxelType::Float32;
+    double volume_threshold = 0;
+    Reconstruction reconstruction = Reconstruction::Trilinear;
+    vector<double> isovalues;
+    vector<string> attribute_names;
+    vector<pair<string, string>> attribute_volumes;  // nombre, archivo
+    string validate_obj;
+    PostOptions post;
+    string field_expression;
+    double bounds[6] = {-6, -6, -6, 6, 6, 6};
+    bool bounds_given = false;
+    string surface_name = "barth";
+    ServerOptions server;
+    double time_limit = 0, fallback_share = 0.25;
+    bool progressive = false;
+    int preview_depth = 2;
+    double memory_budget = 0;  // MB
+    string spill_directory;
+    double progress_interval = 0;
+    string trace_filename;
+    size_t trace_events = size_t(1) << 16;
+    string scaling_prefix;
+    ScalingOptions scaling;
+    vector<string> sweep_surfaces;
+    bool sweep_precisions = false;
+    bool output_given = false;
+    bool corpus = false;
+    bool roofline = false;
+
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--engine" && i + 1 < argc) {
+            if (!parse_engine(argv[++i], engine)) {
+                cerr << "Unknown engine: " << argv[i] << " (mc, mc33, surfacenets, dc)" << endl;
+                return 1;
+            }
+        } else if (arg == "--output" && i + 1 < argc) {
+            output_filename = argv[++i];
+            output_given = true;
+        } else if (arg == "--kernel-bench") {
+            kernel_bench = true;
+        } else if (arg == "--snap" && i + 1 < argc) {
+            snap = atof(argv[++i]);
+        } else if (arg == "--sdf-volume" && i + 1 < argc) {
+            volume_filename = argv[++i];
+        } else if (arg == "--volume" && i + 1 < argc) {
+            input_volume = argv[++i];
+        } else if (arg == "--volume-dims" && i + 3 < argc) {
+            for (int a = 0; a < 3; a++) volume_dims[a] = atoi(argv[++i]);
+        } else if (arg == "--volume-type" && i + 1 < argc) {
+            string type = argv[++i];
+            if (type == "u8") voxel_type = VoxelType::UInt8;
+            else if (type == "u16") voxel_type = VoxelType::UInt16;
+            else if (type == "f32") voxel_type = VoxelType::Float32;
+            else {
+                cerr << "Unknown voxel type: " << type << " (u8, u16, f32)" << endl;
+                return 1;
+            }
+        } else if (arg == "--volume-threshold" && i + 1 < argc) {
+            volume_threshold = atof(argv[++i]);
+        } else if (arg == "--tricubic") {
+            reconstruction = Reconstruction::Tricubic;
+        } else if (arg == "--isovalue" && i + 1 < argc) {
+            isovalues.push_back(atof(argv[++i]));
+        } else if (arg == "--attribute" && i + 1 < argc) {
+            string name = argv[++i];
+            if (name != "radius" && name != "height" && name != "gradient") {
+                cerr << "Unknown attribute: " << name << " (radius, height, gradient)" << endl;
+                return 1;
+            }
+            attribute_names.push_back(name);
+        } else if (arg == "--field" && i + 1 < argc) {
+            field_expression = argv[++i];
+        } else if (arg == "--bounds" && i + 6 < argc) {
+            for (double& b : bounds) b = atof(argv[++i]);
+            bounds_given = true;
+        } else if (arg == "--surface" && i + 1 < argc) {
+            surface_name = argv[++i];
+        } else if (arg == "--time-limit" && i + 1 < argc) {
+            time_limit = atof(argv[++i]);
+        } else if (arg == "--fallback-share" && i + 1 < argc) {
+            fallback_share = atof(argv[++i]);
+        } else if (arg == "--progress" && i + 1 < argc) {
+            progress_interval = atof(argv[++i]);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_filename = argv[++i];
+        } else if (arg == "--trace-events" && i + 1 < argc) {
+            trace_events = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--memory-budget" && i + 1 < argc) {
+            memory_budget = atof(argv[++i]);
+        } else if (arg == "--spill-dir" && i + 1 < argc) {
+            spill_directory = argv[++i];
+        } else if (arg == "--roofline") {
+            roofline = true;
+        } else if (arg == "--corpus") {
+            corpus = true;
+        } else if (arg == "--scaling" && i + 1 < argc) {
+            scaling_prefix = argv[++i];
+        } else if (arg == "--scaling-mode" && i + 1 < argc) {
+            scaling.modes.clear();
+            for (const string& item : split_list(argv[++i])) {
+                scaling.modes.push_back(ScalingMode::Strong);
+                if (!parse_scaling_mode(item, scaling.modes.back())) {
+                    cerr << "Unknown scaling mode: " << item << " (strong, weak)" << endl;
+                    return 1;
+                }
+            }
+        } else if (arg == "--sweep-threads" && i + 1 < argc) {
+            scaling.threads.clear();
+            for (const string& item : split_list(argv[++i])) scaling.threads.push_back(atoi(item.c_str()));
+        } else if (arg == "--sweep-precisions" && i + 1 < argc) {
+            scaling.precisions.clear();
+            sweep_precisions = true;
+            for (const string& item : split_list(argv[++i])) scaling.precisions.push_back(atof(item.c_str()));
+        } else if (arg == "--sweep-surfaces" && i + 1 < argc) {
+            sweep_surfaces = split_list(argv[++i]);
+        } else if (arg == "--sweep-engines" && i + 1 < argc) {
+            scaling.engines.clear();
+            for (const string& item : split_list(argv[++i])) {
+                scaling.engines.push_back(Engine::MarchingCubes);
+                if (!parse_engine(item, scaling.engines.back())) {
+                    cerr << "Unknown engine: " << item << " (mc, mc33, surfacenets, dc)" << endl;
+                    return 1;
+                }
+            }
+        } else if (arg == "--repetitions" && i + 1 < argc) {
+            scaling.repetitions = atoi(argv[++i]);
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            scaling.warmup = atoi(argv[++i]);
+        } else if (arg == "--progressive") {
+            progressive = true;
+        } else if (arg == "--preview-depth" && i + 1 < argc) {
+            preview_depth = atoi(argv[++i]);
+        } else if (arg == "--serve" && i + 1 < argc) {
+            server.socket_path = argv[++i];
+        } else if (arg == "--serve-workers" && i + 1 < argc) {
+            server.workers = atoi(argv[++i]);
+        } else if (arg == "--job-memory" && i + 1 < argc) {
+            server.job_memory = (size_t)(atof(argv[++i]) * (1 << 20));
+        } else if (arg == "--attribute-volume" && i + 2 < argc) {
+            string name = argv[++i];
+            attribute_volumes.push_back({name, argv[++i]});
+        } else if (arg == "--decimate" && i + 1 < argc) {
+            post.decimate = true;
+            post.decimation.target_triangles = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--decimate-error" && i + 1 < argc) {
+            post.decimate = true;
+            post.decimation.max_error = atof(argv[++i]);
+        } else if (arg == "--validate") {
+            post.validate = true;
+        } else if (arg == "--validate-obj" && i + 1 < argc) {
+            validate_obj = argv[++i];
+        } else if (arg == "--components") {
+            post.components = true;
+        } else if (arg == "--min-component-triangles" && i + 1 < argc) {
+            post.components = true;
+            post.component_filter.min_triangles = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--min-component-area" && i + 1 < argc) {
+            post.components = true;
+            post.component_filter.min_area = atof(argv[++i]);
+        } else if ((arg == "--smooth" || arg == "--taubin") && i + 1 < argc) {
+            post.smooth_iterations = atoi(argv[++i]);
+            post.taubin = (arg == "--taubin");
+        } else if (arg == "--normals" && i + 1 < argc) {
+            string weighting = argv[++i];
+            if (weighting != "area" && weighting != "angle") {
+                cerr << "Unknown normal weighting: " << weighting << " (area, angle)" << endl;
+                return 1;
+            }
+            post.normals = true;
+            post.normal_weighting = (weighting == "angle") ? NormalWeighting::Angle : NormalWeighting::Area;
+        } else if (positional == 0) {
+            threads = atoi(arg.c_str());
+            positional++;
+        } else if (positional == 1) {
+            precision = atof(arg.c_str());
+            positional++;
+        } else {
+            cerr << "Unexpected argument: " << arg << endl;
+            return 1;
+        }
+    }
+    if (threads < 1 || precision <= 0 || snap < 0 || snap >= 0.5 || server.workers < 1 || time_limit < 0 || fallback_share < 0 || preview_depth < 0 || progress_interval < 0 ||
+        memory_budget < 0 || bounds[0] >= bounds[3] || bounds[1] >= bounds[4] || bounds[2] >= bounds[5] ||
+        scaling.repetitions < 1 || scaling.warmup < 0 || scaling.modes.empty() || scaling.threads.empty() || scaling.precisions.empty() || scaling.engines.empty() ||
+        *min_element(scaling.threads.begin(), scaling.threads.end()) < 1 ||
+        *min_element(scaling.precisions.begin(), scaling.precisions.end()) <= 0) {
+        cerr << "Usage: " << argv[0] << " [threads] [precision] [--engine mc|mc33|surfacenets|dc] [--output file.obj] [--kernel-bench]"
+             << " [--snap fraction] [--sdf-volume file.sdfv]"
+             << " [--volume file.raw --volume-dims NX NY NZ] [--volume-type u8|u16|f32] [--volume-threshold T] [--tricubic] [--isovalue v]..."
+             << " [--attribute radius|height|gradient]... [--attribute-volume name file.raw]..."
+             << " [--surface " << surface_names() << "] [--field \"expression in x,y,z\"] [--bounds xmin ymin zmin xmax ymax zmax]"
+             << " [--serve socket [--serve-workers N] [--job-memory MB]]"
+             << " [--time-limit seconds] [--fallback-share fraction] [--progressive [--preview-depth N]]"
+             << " [--memory-budget MB [--spill-dir directory]]"
+             << " [--progress seconds] [--trace file.json [--trace-events N]]"
+             << " [--decimate triangles] [--decimate-error error]"
+             << " [--smooth N] [--taubin N] [--normals area|angle]"
+             << " [--components] [--min-component-triangles N] [--min-component-area A]"
+             << " [--validate] [--validate-obj file.obj]"
+             << " [--corpus [--repetitions N] [--warmup N]] [--roofline [--repetitions N] [--warmup N]]"
+             << " [--scaling prefix [--scaling-mode strong,weak] [--sweep-threads 1,2,4] [--sweep-precisions 0.1,0.05] [--sweep-surfaces " << surface_names() << "]"
+             << " [--sweep-engines mc,dc] [--repetitions N] [--warmup N]]" << endl;
+        return 1;
+    }
+    if (isovalues.empty()) isovalues.push_back(0);
+    if (memory_budget > 0 && (progressive || !spill_format_supported(output_filename))) {
+        cerr << "--memory-budget needs an .obj or .ply output and does not combine with --progressive" << endl;
+        return 1;
+    }
+    omp_set_num_threads(threads);
 
-            #pragma omp task shared(sub_results)
-            sub_results[6] = surface_to_triangles(f, Point3D(start.x, mid_y, mid_z), Point3D(mid_x, end.y, end.z), precision);
+    // Modo servidor: los trabajos traen su propio campo y parámetros
+    if (!server.socket_path.empty()) {
+        server.threads = threads;
+        return ExtractionServer(server).run();
+    }
 
-            #pragma omp task shared(sub_results)
-            sub_results[7] = surface_to_triangles(f, mid, end, precision);
+    if (corpus) return run_corpus_check(scaling.warmup, scaling.repetitions);
 
-            #pragma omp taskwait
+    // Superficie analítica por defecto, o el volumen de entrada
+    const BuiltinSurface* builtin = find_surface(surface_name);
+    if (!builtin) {
+        cerr << "Unknown surface: " << surface_name << " (" << surface_names() << ")" << endl;
+        return 1;
+    }
+    Extractor extractor(builtin->field);
+    extractor.config.start = bounds_given ? Point3D(bounds[0], bounds[1], bounds[2]) : builtin->start;
+    extractor.config.end = bounds_given ? Point3D(bounds[3], bounds[4], bounds[5]) : builtin->end;
+    Expression expression;
+    if (!field_expression.empty()) {
+        string error;
+        if (!expression.compile(field_expression, error)) {
+            cerr << "Invalid --field: " << error << endl;
+            return 1;
         }
+        extractor.set_field(expression.field());
     }
-
-
-    for (auto& sub : sub_results) {
-        triangles.insert(triangles.end(), sub.begin(), sub.end());
+    Volume volume;
+    if (!input_volume.empty()) {
+        if (!load_raw_volume(input_volume, volume_dims[0], volume_dims[1], volume_dims[2], voxel_type, volume)) {
+            cerr << "Error reading volume: " << input_volume << " (check --volume-dims and --volume-type)" << endl;
+            return 1;
+        }
+        double t0 = omp_get_wtime();
+        extractor.set_volume(volume, reconstruction, volume_threshold);
+        cout << "Volume " << volume.nx << "x" << volume.ny << "x" << volume.nz << ", min/max pyramid with "
+             << extractor.volume()->pyramid.depth + 1 << " levels (" << omp_get_wtime() - t0 << " s)" << endl;
+    }
+    const ScalarField& surface = extractor.field();
+    Point3D domain_start = extractor.config.start, domain_end = extractor.config.end;
+
+    // Campos auxiliares por vértice. Un volumen de atributos tiene las mismas
+    // dimensiones y tipo que --volume-dims/--volume-type y cubre el dominio.
+    for (const string& name : attribute_names) {
+        if (name == "radius") extractor.add_attribute(name, radius_attribute);
+        else if (name == "height") extractor.add_attribute(name, height_attribute);
+        else extractor.add_attribute(name, ScalarField(gradient_attribute, &surface));
+    }
+    vector<unique_ptr<Volume>> attribute_data;
+    for (const auto& entry : attribute_volumes) {
+        attribute_data.emplace_back(new Volume());
+        Volume& data = *attribute_data.back();
+        if (!load_raw_volume(entry.second, volume_dims[0], volume_dims[1], volume_dims[2], voxel_type, data)) {
+            cerr << "Error reading attribute volume: " << entry.second << " (check --volume-dims and --volume-type)" << endl;
+            return 1;
+        }
+        data.origin = domain_start;
+        data.spacing = Point3D((domain_end.x - domain_start.x) / (data.nx - 1), (domain_end.y - domain_start.y) / (data.ny - 1),
+                               (domain_end.z - domain_start.z) / (data.nz - 1));
+        extractor.add_attribute(entry.first, volume_sampler(data));
     }
 
-    return triangles;
-}
-
-void draw_surface(double (*f)(double, double, double), const string& output_filename,
-                 double xmin, double ymin, double zmin, double xmax, double ymax, double zmax, double precision) {
-    ofstream file(output_filename);
-    if (!file.is_open()) {
-        cerr << "Error opening file: " << output_filename << endl;
-        return;
+    if (!validate_obj.empty()) {
+        IndexedMesh mesh;
+        if (!load_obj(validate_obj, mesh)) {
+            cerr << "Error opening file: " << validate_obj << endl;
+            return 1;
+        }
+        ValidationReport report = validate_mesh(mesh, surface, 10000, 1e-6, isovalues[0]);
+        if (report.invalid_indices == 0) {
+            // La salida de marching cubes no comparte vértices: soldar para ver la topología
+            vector<Triangle> soup;
+            for (size_t t = 0; t < mesh.triangle_count(); t++) {
+                soup.push_back(Triangle(mesh.vertices[mesh.indices[3 * t]], mesh.vertices[mesh.indices[3 * t + 1]], mesh.vertices[mesh.indices[3 * t + 2]]));
+            }
+            report = validate_mesh(weld_triangles(soup), surface, 10000, 1e-6, isovalues[0]);
+        }
+        print_validation_report(report);
+        return report.ok() ? 0 : 2;
     }
-    
-    Point3D start(xmin, ymin, zmin);
-    Point3D end(xmax, ymax, zmax);
-    vector<Triangle> triangles = surface_to_triangles(f, start, end, precision);
-    cout << "Generated " << triangles.size() << " triangles (will be doubled)" << endl;
-    
-    file << "# Marching Cubes Output - Double-sided\n";
-    file << "# " << triangles.size() << " triangles\n\n";
-    
-    // Escribir vértices (cada triángulo duplicado)
-    for (const auto& triangle : triangles) {
-        // Triángulo original
-        file << "v " << triangle.p1.x << " " << triangle.p1.y << " " << triangle.p1.z << "\n";
-        file << "v " << triangle.p2.x << " " << triangle.p2.y << " " << triangle.p2.z << "\n";
-        file << "v " << triangle.p3.x << " " << triangle.p3.y << " " << triangle.p3.z << "\n";
-    }
-    
-    // Escribir caras
-    for (int i = 0; i < triangles.size(); i++) {
-        int base = i * 6 + 1; // Cada triángulo usa 6 vértices ahora
-        
-        // Cara frontal
-        file << "f " << base << " " << (base + 1) << " " << (base + 2) << "\n";
-    }
-    
-    file.close();
-}
 
-int main() {
-    omp_set_num_threads(8);  // o la cantidad que tenga tu procesador
-
-    auto mandelbulb = [](double x, double y, double z) {
-        double power = 8.0;
-        double cx = x, cy = y, cz = z;
-        double zx = x, zy = y, zz = z;
-        
-        for (int i = 0; i < 10; i++) {
-            double r = sqrt(zx*zx + zy*zy + zz*zz);
-            if (r > 2.0) return r - 2.0;
-            
-            double theta = atan2(sqrt(zx*zx + zy*zy), zz);
-            double phi = atan2(zy, zx);
-            
-            double rp = pow(r, power);
-            theta *= power;
-            phi *= power;
-            
-            zx = rp * sin(theta) * cos(phi) + cx;
-            zy = rp * sin(theta) * sin(phi) + cy;
-            zz = rp * cos(theta) + cz;
+    // Sin --sweep-surfaces se barre la superficie elegida (o --field/--volume) con
+    // su dominio, y sin --sweep-precisions la precisión de la línea de comandos
+    if (!scaling_prefix.empty()) {
+        for (const string& name : sweep_surfaces) {
+            const BuiltinSurface* sweep = find_surface(name);
+            if (!sweep) {
+                cerr << "Unknown surface: " << name << " (" << surface_names() << ")" << endl;
+                return 1;
+            }
+            scaling.surfaces.push_back(*sweep);
         }
-        
-        return sqrt(zx*zx + zy*zy + zz*zz) - 2.0;
-    }; //este se ve chevere pero necesita mucha resolucion XD
+        if (scaling.surfaces.empty()) {
+            string name = !input_volume.empty() ? "volume" : !field_expression.empty() ? "field" : builtin->name;
+            scaling.surfaces.push_back({name, surface, domain_start, domain_end});
+        }
+        if (!sweep_precisions) scaling.precisions.assign(1, precision);
+        if (output_given) scaling.output = output_filename;
+        extractor.config.snap = snap;
+        extractor.config.isovalues = isovalues;
+        return run_scaling_sweep(extractor, scaling, scaling_prefix);
+    }
+
+    if (roofline) {
+        FieldCost cost = extractor.volume() ? volume_field_cost(*extractor.volume())
+                       : !field_expression.empty() ? expression_field_cost(expression)
+                       : builtin_field_cost(builtin->name);
+        return run_roofline_report(surface, cost, domain_start, domain_end, precision, isovalues[0], scaling.warmup, scaling.repetitions);
+    }
 
-    auto barth_sextic = [](double x, double y, double z) {
-        double phi = (1 + sqrt(5)) / 2; // Golden ratio
-        double x2 = x * x, y2 = y * y, z2 = z * z;
-        return 4*(phi*phi*x2 - y2)*(phi*phi*y2 - z2)*(phi*phi*z2 - x2) - 
-               (1 + 2*phi)*(x2 + y2 + z2 - 1)*(x2 + y2 + z2 - 1);
-    };
+    if (kernel_bench) {
+        benchmark_cell_tables(surface, domain_start, domain_end, precision, snap, isovalues[0]);
+        return 0;
+    }
 
     // Generar la superficie
     double start_time = omp_get_wtime();
-    draw_surface(barth_sextic, "surface.obj", -6, -6, -6, 6, 6, 6, 0.1);
+    extractor.config.engine = engine;
+    extractor.config.precision = precision;
+    extractor.config.isovalues = isovalues;
+    extractor.config.snap = snap;
+    extractor.config.time_limit = time_limit;
+    extractor.config.fallback_share = fallback_share;
+    string config_error;
+    if (!extractor.config.check(config_error)) {
+        cerr << "Error: " << config_error << endl;
+        return 1;
+    }
+    unique_ptr<NarrowBandRecorder> recorder;
+    if (!volume_filename.empty()) {
+        recorder.reset(new NarrowBandRecorder(domain_start, domain_end, precision));
+        extractor.config.samples = recorder.get();
+    }
+    // Avance y ETA a stderr: el recorrido suma en contadores por hilo y el monitor los lee
+    TraversalCounters counters;
+    unique_ptr<ProgressMonitor> monitor;
+    if (progress_interval > 0) {
+        extractor.config.counters = &counters;
+        monitor.reset(new ProgressMonitor(counters, progress_interval,
+                                          [](const ProgressReport& report) { cerr << format_progress(report) << endl; }));
+    }
+    unique_ptr<TaskTracer> tracer;
+    if (!trace_filename.empty()) {
+        tracer.reset(new TaskTracer(trace_events));
+        extractor.config.tracer = tracer.get();
+    }
+    draw_surface(extractor, output_filename, post, recorder.get(), volume_filename, progressive ? preview_depth : -1,
+                 (size_t)(memory_budget * (1 << 20)), spill_directory);
+    monitor.reset();
+    if (tracer) {
+        if (!write_chrome_trace(trace_filename, *tracer)) {
+            cerr << "Error opening file: " << trace_filename << endl;
+            return 1;
+        }
+        cout << "Trace written to " << trace_filename << endl;
+    }
     double end_time = omp_get_wtime();
     double elapsed_time = end_time - start_time;
-    cout << "Surface drawn to surface.obj" << endl;
+    cout << "Engine: " << engine_name(engine) << endl;
+    cout << "Surface drawn to " << output_filename << endl;
     cout << "Elapsed time: " << elapsed_time << " seconds" << endl;
+    print_memory_report(cout);
 
     return 0;
 }
\ No newline at end of file
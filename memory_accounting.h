@@ -0,0 +1,151 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#include <iomanip>
+#include <new>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Contabilidad de memoria por subsistema. Los contenedores grandes de cada
+// parte usan TrackedAllocator con su categoría, que suma y resta los bytes
+// reservados en contadores globales; el pico se actualiza al reservar. Los
+// contenedores crecen duplicando, así que son pocas reservas por hilo y el
+// costo de los atómicos no se nota. Los temporales por celda del núcleo no se
+// cuentan: viven lo que dura una celda.
+
+enum class MemoryCategory {
+    Triangles,  // sopas de triángulos y sus atributos
+    Octree,     // claves de nodos y celdas activas de los recorridos
+    Caches,     // pirámides de mínimos/máximos, ladrillos de banda estrecha, soldado
+    Writer,     // búferes de los escritores (PLY, glTF, OBJ por lotes)
+    Count
+};
+
+inline const char* memory_category_name(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::Triangles: return "triangles";
+        case MemoryCategory::Octree: return "octree";
+        case MemoryCategory::Caches: return "caches";
+        case MemoryCategory::Writer: return "writer";
+        default: return "total";
+    }
+}
+
+class MemoryUsage {
+public:
+    int64_t current = 0;  // bytes reservados ahora
+    int64_t peak = 0;     // máximo desde el último reset_peaks
+};
+
+class MemoryAccounting {
+public:
+    static const int categories = (int)MemoryCategory::Count;
+
+    void allocate(MemoryCategory category, size_t bytes) {
+        Counter& c = counters[(int)category];
+        raise_peak(c.peak, c.current.fetch_add((int64_t)bytes, memory_order_relaxed) + (int64_t)bytes);
+        raise_peak(all.peak, all.current.fetch_add((int64_t)bytes, memory_order_relaxed) + (int64_t)bytes);
+    }
+
+    void release(MemoryCategory category, size_t bytes) {
+        counters[(int)category].current.fetch_sub((int64_t)bytes, memory_order_relaxed);
+        all.current.fetch_sub((int64_t)bytes, memory_order_relaxed);
+    }
+
+    // MemoryCategory::Count da el total de todas las categorías
+    MemoryUsage usage(MemoryCategory category) const {
+        const Counter& c = category == MemoryCategory::Count ? all : counters[(int)category];
+        MemoryUsage u;
+        u.current = c.current.load(memory_order_relaxed);
+        u.peak = c.peak.load(memory_order_relaxed);
+        return u;
+    }
+
+    // Los picos vuelven al uso actual, para medir una extracción aislada
+    void reset_peaks() {
+        for (auto& c : counters) c.peak.store(c.current.load(memory_order_relaxed), memory_order_relaxed);
+        all.peak.store(all.current.load(memory_order_relaxed), memory_order_relaxed);
+    }
+
+private:
+    class alignas(64) Counter {
+    public:
+        atomic<int64_t> current{0};
+        atomic<int64_t> peak{0};
+    };
+    Counter counters[categories];
+    Counter all;
+
+    static void raise_peak(atomic<int64_t>& peak, int64_t value) {
+        int64_t seen = peak.load(memory_order_relaxed);
+        while (value > seen && !peak.compare_exchange_weak(seen, value, memory_order_relaxed)) {
+        }
+    }
+};
+
+inline MemoryAccounting& memory_accounting() {
+    static MemoryAccounting accounting;
+    return accounting;
+}
+
+template <class T, MemoryCategory C>
+class TrackedAllocator {
+public:
+    typedef T value_type;
+
+    TrackedAllocator() noexcept {}
+    template <class U> TrackedAllocator(const TrackedAllocator<U, C>&) noexcept {}
+    template <class U> struct rebind { typedef TrackedAllocator<U, C> other; };
+
+    T* allocate(size_t n) {
+        T* p = static_cast<T*>(::operator new(n * sizeof(T)));
+        memory_accounting().allocate(C, n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        memory_accounting().release(C, n * sizeof(T));
+        ::operator delete(p);
+    }
+};
+
+template <class T, class U, MemoryCategory C>
+bool operator==(const TrackedAllocator<T, C>&, const TrackedAllocator<U, C>&) { return true; }
+template <class T, class U, MemoryCategory C>
+bool operator!=(const TrackedAllocator<T, C>&, const TrackedAllocator<U, C>&) { return false; }
+
+template <class T, MemoryCategory C> using tracked_vector = vector<T, TrackedAllocator<T, C>>;
+template <MemoryCategory C> using tracked_string = basic_string<char, char_traits<char>, TrackedAllocator<char, C>>;
+
+// 1536 -> "1.5 KB"
+inline string format_bytes(int64_t bytes) {
+    static const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    double value = (double)bytes;
+    int unit = 0;
+    while (value >= 1024 && unit < 4) {
+        value /= 1024;
+        unit++;
+    }
+    char text[32];
+    snprintf(text, sizeof(text), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+    return text;
+}
+
+// Tabla de uso actual y pico por subsistema, para el final de una corrida
+inline void print_memory_report(ostream& out) {
+    out << "Memory (current / peak):\n";
+    for (int c = 0; c <= MemoryAccounting::categories; c++) {
+        MemoryUsage usage = memory_accounting().usage((MemoryCategory)c);
+        out << "  " << left << setw(10) << memory_category_name((MemoryCategory)c) << right << setw(10)
+            << format_bytes(usage.current) << " / " << format_bytes(usage.peak) << "\n";
+    }
+}
+
+#endif // MEMORY_ACCOUNTING_H
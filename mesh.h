@@ -0,0 +1,152 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include "marching_cubes.h"
+#include <cstdint>
+
+// Malla indexada compartida por los motores duales y los pasos de post-proceso.
+class IndexedMesh {
+public:
+    vector<Point3D> vertices;
+    vector<int> indices;  // 3 índices por triángulo
+    vector<Point3D> normals;  // por vértice; vacío si no se calcularon
+    vector<string> attribute_names;  // propiedades extra por vértice
+    vector<float> attributes;         // attribute_names.size() valores por vértice
+
+    size_t triangle_count() const { return indices.size() / 3; }
+    size_t attribute_count() const { return attribute_names.size(); }
+    bool has_attributes() const { return !attribute_names.empty() && attributes.size() == vertices.size() * attribute_count(); }
+};
+
+inline double squared_distance(const Point3D& a, const Point3D& b) {
+    return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z);
+}
+
+// Producto cruz sin normalizar: su largo es el doble del área del triángulo
+inline Point3D face_normal(const Point3D& a, const Point3D& b, const Point3D& c) {
+    double ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+    double vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+    return Point3D(uy * vz - uz * vy, uz * vx - ux * vz, ux * vy - uy * vx);
+}
+
+
+// Une los vértices repetidos de la sopa de triángulos de marching_cubes.
+// Dos celdas vecinas interpolan la arista compartida en sentidos opuestos, así
+// que los puntos se comparan cuantizados a múltiplos de tolerance, una
+// distancia absoluta en las unidades del dominio (no se escala con la malla).
+// sources, si se pide, recibe para cada vértice la esquina de la sopa
+// (3 * triángulo + esquina) de la que se tomó. triangles puede ser cualquier
+// vector de Triangle (los de TriangleSoup usan TrackedAllocator).
+template <class Triangles>
+inline IndexedMesh weld_triangles(const Triangles& triangles, double tolerance = 1e-9, vector<size_t>* sources = nullptr) {
+    IndexedMesh mesh;
+    size_t n = triangles.size() * 3;
+    if (n == 0) return mesh;
+
+    tracked_vector<Point3D, MemoryCategory::Caches> points(n);
+    #pragma omp parallel for schedule(static)
+    for (long t = 0; t < (long)triangles.size(); t++) {
+        points[3 * t] = triangles[t].p1;
+        points[3 * t + 1] = triangles[t].p2;
+        points[3 * t + 2] = triangles[t].p3;
+    }
+
+    class QuantizedPoint {
+    public:
+        int64_t x, y, z;
+        size_t index;
+        bool operator<(const QuantizedPoint& o) const {
+            if (x != o.x) return x < o.x;
+            if (y != o.y) return y < o.y;
+            if (z != o.z) return z < o.z;
+            return index < o.index;
+        }
+        bool same_position(const QuantizedPoint& o) const { return x == o.x && y == o.y && z == o.z; }
+    };
+
+    tracked_vector<QuantizedPoint, MemoryCategory::Caches> keys(n);
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < (long)n; i++) {
+        keys[i] = {llround(points[i].x / tolerance), llround(points[i].y / tolerance), llround(points[i].z / tolerance), (size_t)i};
+    }
+    sort(keys.begin(), keys.end());
+
+    mesh.indices.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        if (i == 0 || !keys[i].same_position(keys[i - 1])) {
+            mesh.vertices.push_back(points[keys[i].index]);
+            if (sources) sources->push_back(keys[i].index);
+        }
+        mesh.indices[keys[i].index] = (int)mesh.vertices.size() - 1;
+    }
+    return mesh;
+}
+
+// Memoria que ocupa cada triángulo de una sopa hasta escribir la malla: el
+// triángulo y, al soldar, los puntos, las claves de orden y los índices por esquina.
+const size_t weld_bytes_per_triangle = sizeof(Triangle) + 3 * (sizeof(Point3D) + 4 * sizeof(int64_t) + sizeof(int));
+
+// Igual, conservando los atributos de la sopa. Las dos celdas que comparten
+// una arista interpolan el mismo cruce, así que basta con la primera copia.
+inline IndexedMesh weld_soup(const TriangleSoup& soup, const vector<string>& attribute_names, double tolerance = 1e-9) {
+    vector<size_t> sources;
+    IndexedMesh mesh = weld_triangles(soup.triangles, tolerance, &sources);
+    size_t count = soup.attribute_count;
+    if (count == 0 || count != attribute_names.size() || soup.attributes.size() != soup.triangles.size() * 3 * count) return mesh;
+
+    mesh.attribute_names = attribute_names;
+    mesh.attributes.resize(sources.size() * count);
+    #pragma omp parallel for schedule(static)
+    for (long v = 0; v < (long)sources.size(); v++) {
+        for (size_t a = 0; a < count; a++) mesh.attributes[v * count + a] = soup.attributes[sources[v] * count + a];
+    }
+    return mesh;
+}
+
+// Evalúa los campos auxiliares en los vértices de una malla que no sale de
+// aristas (los motores duales colocan el vértice dentro de la celda).
+inline void sample_attributes(IndexedMesh& mesh, const vector<ScalarField>& fields, const vector<string>& names) {
+    size_t count = fields.size();
+    mesh.attribute_names = names;
+    mesh.attributes.resize(mesh.vertices.size() * count);
+    #pragma omp parallel for schedule(static)
+    for (long v = 0; v < (long)mesh.vertices.size(); v++) {
+        const Point3D& p = mesh.vertices[v];
+        for (size_t a = 0; a < count; a++) mesh.attributes[v * count + a] = (float)fields[a](p.x, p.y, p.z);
+    }
+}
+
+// Quita triángulos con índices repetidos y vértices sin referencias.
+inline void compact_mesh(IndexedMesh& mesh) {
+    vector<int> indices;
+    indices.reserve(mesh.indices.size());
+    for (size_t t = 0; t < mesh.triangle_count(); t++) {
+        int a = mesh.indices[3 * t], b = mesh.indices[3 * t + 1], c = mesh.indices[3 * t + 2];
+        if (a < 0 || a == b || b == c || a == c) continue;
+        indices.insert(indices.end(), {a, b, c});
+    }
+
+    vector<int> remap(mesh.vertices.size(), -1);
+    vector<Point3D> vertices, normals;
+    vector<float> attributes;
+    bool has_normals = mesh.normals.size() == mesh.vertices.size();
+    bool has_attributes = mesh.has_attributes();
+    size_t count = mesh.attribute_count();
+    for (int& index : indices) {
+        if (remap[index] < 0) {
+            remap[index] = (int)vertices.size();
+            vertices.push_back(mesh.vertices[index]);
+            if (has_normals) normals.push_back(mesh.normals[index]);
+            if (has_attributes) {
+                attributes.insert(attributes.end(), mesh.attributes.begin() + index * count, mesh.attributes.begin() + (index + 1) * count);
+            }
+        }
+        index = remap[index];
+    }
+    mesh.vertices.swap(vertices);
+    mesh.normals.swap(normals);
+    if (has_attributes) mesh.attributes.swap(attributes);
+    mesh.indices.swap(indices);
+}
+
+#endif // MESH_H
@@ -0,0 +1,257 @@
+#ifndef MESH_IO_H
+#define MESH_IO_H
+
+#include "mesh.h"
+#include <cstring>
+#include <sstream>
+
+// Escritura de la malla indexada en formatos que guardan propiedades por
+// vértice: PLY binario y glTF 2.0 (.gltf con el buffer embebido en base64, o
+// .glb). Los atributos auxiliares van como propiedades float con su nombre.
+
+enum class MeshFormat { Obj, Ply, Gltf, Glb };
+
+// Búferes de los escritores, contados en MemoryCategory::Writer
+template <class T> using WriterBuffer = tracked_vector<T, MemoryCategory::Writer>;
+typedef basic_ostringstream<char, char_traits<char>, TrackedAllocator<char, MemoryCategory::Writer>> WriterText;
+
+inline MeshFormat mesh_format(const string& filename) {
+    size_t dot = filename.rfind('.');
+    if (dot == string::npos) return MeshFormat::Obj;
+    string ext = filename.substr(dot + 1);
+    for (char& c : ext) c = (char)tolower(c);
+    if (ext == "ply") return MeshFormat::Ply;
+    if (ext == "gltf") return MeshFormat::Gltf;
+    if (ext == "glb") return MeshFormat::Glb;
+    return MeshFormat::Obj;
+}
+
+// Nombre válido como propiedad: letras, dígitos y '_'
+inline string property_name(const string& name) {
+    string out = name;
+    for (char& c : out) {
+        if (!isalnum((unsigned char)c)) c = '_';
+    }
+    return out.empty() ? string("attribute") : out;
+}
+
+inline bool host_is_little_endian() {
+    uint16_t probe = 1;
+    unsigned char first;
+    memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+// Cabecera de PLY binario: x, y, z, normales opcionales y un float por atributo
+inline void write_ply_header(ofstream& file, size_t vertices, size_t faces, bool has_normals, const vector<string>& attribute_names) {
+    file << "ply\n";
+    file << "format " << (host_is_little_endian() ? "binary_little_endian" : "binary_big_endian") << " 1.0\n";
+    file << "element vertex " << vertices << "\n";
+    file << "property float x\nproperty float y\nproperty float z\n";
+    if (has_normals) file << "property float nx\nproperty float ny\nproperty float nz\n";
+    for (const auto& name : attribute_names) file << "property float " << property_name(name) << "\n";
+    file << "element face " << faces << "\n";
+    file << "property list uchar int vertex_indices\n";
+    file << "end_header\n";
+}
+
+inline bool write_ply(const string& filename, const IndexedMesh& mesh) {
+    ofstream file(filename, ios::binary);
+    if (!file.is_open()) return false;
+
+    bool has_normals = mesh.normals.size() == mesh.vertices.size();
+    bool has_attributes = mesh.has_attributes();
+    size_t count = has_attributes ? mesh.attribute_count() : 0;
+    write_ply_header(file, mesh.vertices.size(), mesh.triangle_count(), has_normals,
+                     has_attributes ? mesh.attribute_names : vector<string>());
+
+    // Un registro por vértice, armado en memoria para escribir en un bloque
+    size_t stride = 3 + (has_normals ? 3 : 0) + count;
+    WriterBuffer<float> record(mesh.vertices.size() * stride);
+    #pragma omp parallel for schedule(static)
+    for (long v = 0; v < (long)mesh.vertices.size(); v++) {
+        float* r = &record[v * stride];
+        *r++ = (float)mesh.vertices[v].x; *r++ = (float)mesh.vertices[v].y; *r++ = (float)mesh.vertices[v].z;
+        if (has_normals) { *r++ = (float)mesh.normals[v].x; *r++ = (float)mesh.normals[v].y; *r++ = (float)mesh.normals[v].z; }
+        for (size_t a = 0; a < count; a++) *r++ = mesh.attributes[v * count + a];
+    }
+    file.write((const char*)record.data(), record.size() * sizeof(float));
+
+    const size_t face_bytes = 1 + 3 * sizeof(int32_t);
+    WriterBuffer<char> faces(mesh.triangle_count() * face_bytes);
+    for (size_t t = 0; t < mesh.triangle_count(); t++) {
+        char* f = &faces[t * face_bytes];
+        f[0] = 3;
+        int32_t index[3] = {mesh.indices[3 * t], mesh.indices[3 * t + 1], mesh.indices[3 * t + 2]};
+        memcpy(f + 1, index, sizeof(index));
+    }
+    file.write(faces.data(), faces.size());
+    return (bool)file;
+}
+
+template <class Bytes>
+inline tracked_string<MemoryCategory::Writer> base64_encode(const Bytes& bytes) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    tracked_string<MemoryCategory::Writer> out;
+    out.reserve((bytes.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < bytes.size(); i += 3) {
+        uint32_t chunk = (uint32_t)bytes[i] << 16;
+        if (i + 1 < bytes.size()) chunk |= (uint32_t)bytes[i + 1] << 8;
+        if (i + 2 < bytes.size()) chunk |= bytes[i + 2];
+        out += alphabet[(chunk >> 18) & 63];
+        out += alphabet[(chunk >> 12) & 63];
+        out += (i + 1 < bytes.size()) ? alphabet[(chunk >> 6) & 63] : '=';
+        out += (i + 2 < bytes.size()) ? alphabet[chunk & 63] : '=';
+    }
+    return out;
+}
+
+// Buffer binario de glTF: índices, posiciones, normales y un bloque por
+// atributo, cada uno en su bufferView. Devuelve el JSON sin la uri del buffer.
+class GltfBuffer {
+public:
+    WriterBuffer<unsigned char> bytes;
+    ostringstream views, accessors, attributes;
+    int view_count = 0;
+
+    void append(const void* data, size_t size) {
+        const unsigned char* p = (const unsigned char*)data;
+        bytes.insert(bytes.end(), p, p + size);
+        while (bytes.size() % 4) bytes.push_back(0);
+    }
+
+    // Agrega un bufferView con su accessor y devuelve el índice del accessor
+    int add(const void* data, size_t size, int target, int component_type, size_t count, const char* type, const string& bounds = "") {
+        size_t offset = bytes.size();
+        append(data, size);
+        if (view_count > 0) { views << ","; accessors << ","; }
+        views << "{\"buffer\":0,\"byteOffset\":" << offset << ",\"byteLength\":" << size << ",\"target\":" << target << "}";
+        accessors << "{\"bufferView\":" << view_count << ",\"componentType\":" << component_type << ",\"count\":" << count
+                  << ",\"type\":\"" << type << "\"" << bounds << "}";
+        return view_count++;
+    }
+};
+
+inline string gltf_json(const IndexedMesh& mesh, GltfBuffer& buffer) {
+    const int array_buffer = 34962, element_array_buffer = 34963;
+    const int float_type = 5126, uint_type = 5125;
+    size_t nv = mesh.vertices.size();
+
+    WriterBuffer<uint32_t> indices(mesh.indices.begin(), mesh.indices.end());
+    int index_accessor = buffer.add(indices.data(), indices.size() * sizeof(uint32_t), element_array_buffer, uint_type, indices.size(), "SCALAR");
+
+    WriterBuffer<float> positions(3 * nv);
+    float lo[3] = {INFINITY, INFINITY, INFINITY}, hi[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (size_t v = 0; v < nv; v++) {
+        float p[3] = {(float)mesh.vertices[v].x, (float)mesh.vertices[v].y, (float)mesh.vertices[v].z};
+        for (int a = 0; a < 3; a++) {
+            positions[3 * v + a] = p[a];
+            lo[a] = min(lo[a], p[a]);
+            hi[a] = max(hi[a], p[a]);
+        }
+    }
+    // POSITION exige min y max
+    ostringstream bounds;
+    bounds << setprecision(9) << ",\"min\":[" << lo[0] << "," << lo[1] << "," << lo[2] << "],\"max\":[" << hi[0] << "," << hi[1] << "," << hi[2] << "]";
+    int position_accessor = buffer.add(positions.data(), positions.size() * sizeof(float), array_buffer, float_type, nv, "VEC3",
+                                       nv > 0 ? bounds.str() : "");
+    buffer.attributes << "\"POSITION\":" << position_accessor;
+
+    if (mesh.normals.size() == nv && nv > 0) {
+        WriterBuffer<float> normals(3 * nv);
+        for (size_t v = 0; v < nv; v++) {
+            normals[3 * v] = (float)mesh.normals[v].x; normals[3 * v + 1] = (float)mesh.normals[v].y; normals[3 * v + 2] = (float)mesh.normals[v].z;
+        }
+        buffer.attributes << ",\"NORMAL\":" << buffer.add(normals.data(), normals.size() * sizeof(float), array_buffer, float_type, nv, "VEC3");
+    }
+
+    // Atributos propios: la especificación pide el prefijo '_'
+    if (mesh.has_attributes()) {
+        size_t count = mesh.attribute_count();
+        WriterBuffer<float> column(nv);
+        for (size_t a = 0; a < count; a++) {
+            for (size_t v = 0; v < nv; v++) column[v] = mesh.attributes[v * count + a];
+            string name = "_" + property_name(mesh.attribute_names[a]);
+            for (char& c : name) c = (char)toupper(c);
+            buffer.attributes << ",\"" << name << "\":" << buffer.add(column.data(), column.size() * sizeof(float), array_buffer, float_type, nv, "SCALAR");
+        }
+    }
+
+    ostringstream json;
+    json << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"marching_cubes_paralelo\"},"
+         << "\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+         << "\"meshes\":[{\"primitives\":[{\"attributes\":{" << buffer.attributes.str() << "},\"indices\":" << index_accessor << ",\"mode\":4}]}],"
+         << "\"bufferViews\":[" << buffer.views.str() << "],"
+         << "\"accessors\":[" << buffer.accessors.str() << "],"
+         << "\"buffers\":[{\"byteLength\":" << buffer.bytes.size();
+    return json.str();
+}
+
+inline bool write_gltf(const string& filename, const IndexedMesh& mesh) {
+    GltfBuffer buffer;
+    string json = gltf_json(mesh, buffer);
+    ofstream file(filename);
+    if (!file.is_open()) return false;
+    file << json << ",\"uri\":\"data:application/octet-stream;base64," << base64_encode(buffer.bytes) << "\"}]}\n";
+    return (bool)file;
+}
+
+// Contenedor binario: cabecera, trozo JSON y trozo BIN (little-endian)
+inline bool write_glb(const string& filename, const IndexedMesh& mesh) {
+    GltfBuffer buffer;
+    string json = gltf_json(mesh, buffer) + "}]}";
+    while (json.size() % 4) json += ' ';
+
+    ofstream file(filename, ios::binary);
+    if (!file.is_open()) return false;
+    uint32_t json_length = (uint32_t)json.size(), bin_length = (uint32_t)buffer.bytes.size();
+    uint32_t header[3] = {0x46546C67, 2, 12 + 8 + json_length + 8 + bin_length};
+    uint32_t json_chunk[2] = {json_length, 0x4E4F534A};
+    uint32_t bin_chunk[2] = {bin_length, 0x004E4942};
+    file.write((const char*)header, sizeof(header));
+    file.write((const char*)json_chunk, sizeof(json_chunk));
+    file.write(json.data(), json.size());
+    file.write((const char*)bin_chunk, sizeof(bin_chunk));
+    file.write((const char*)buffer.bytes.data(), buffer.bytes.size());
+    return (bool)file;
+}
+
+inline void write_indexed_obj(ofstream& file, const IndexedMesh& mesh) {
+    file << "# Indexed Mesh Output\n";
+    file << "# " << mesh.triangle_count() << " triangles\n\n";
+
+    for (const auto& v : mesh.vertices) {
+        file << "v " << v.x << " " << v.y << " " << v.z << "\n";
+    }
+    bool has_normals = mesh.normals.size() == mesh.vertices.size();
+    if (has_normals) {
+        for (const auto& n : mesh.normals) {
+            file << "vn " << n.x << " " << n.y << " " << n.z << "\n";
+        }
+    }
+    for (size_t t = 0; t < mesh.triangle_count(); t++) {
+        int a = mesh.indices[3 * t] + 1, b = mesh.indices[3 * t + 1] + 1, c = mesh.indices[3 * t + 2] + 1;
+        if (has_normals) {
+            file << "f " << a << "//" << a << " " << b << "//" << b << " " << c << "//" << c << "\n";
+        } else {
+            file << "f " << a << " " << b << " " << c << "\n";
+        }
+    }
+}
+
+// Formato según la extensión: .ply, .gltf y .glb llevan normales y atributos
+inline bool write_mesh(const string& filename, const IndexedMesh& mesh) {
+    switch (mesh_format(filename)) {
+        case MeshFormat::Ply: return write_ply(filename, mesh);
+        case MeshFormat::Gltf: return write_gltf(filename, mesh);
+        case MeshFormat::Glb: return write_glb(filename, mesh);
+        default: {
+            ofstream file(filename);
+            if (!file.is_open()) return false;
+            write_indexed_obj(file, mesh);
+            return true;
+        }
+    }
+}
+
+#endif // MESH_IO_H
@@ -0,0 +1,147 @@
+#ifndef NORMALS_H
+#define NORMALS_H
+
+#include "mesh.h"
+
+// Normales por vértice y suavizado sobre la malla indexada.
+// Los vértices se reparten en rangos contiguos; cada parte recorre sólo las
+// caras que tocan su rango y acumula únicamente en sus propios vértices, así
+// que el scatter no necesita atómicos ni reducciones por hilo.
+
+class OwnershipPartition {
+public:
+    vector<int> range_begin;   // parte p es dueña de [range_begin[p], range_begin[p + 1])
+    vector<vector<int>> faces; // caras con al menos un vértice de cada parte
+
+    OwnershipPartition(const IndexedMesh& mesh, int parts) {
+        int nv = (int)mesh.vertices.size();
+        parts = max(1, min(parts, max(1, nv)));
+        range_begin.resize(parts + 1);
+        for (int p = 0; p <= parts; p++) range_begin[p] = (int)((long)nv * p / parts);
+
+        int threads = omp_get_max_threads();
+        vector<vector<vector<int>>> local(threads, vector<vector<int>>(parts));
+        #pragma omp parallel
+        {
+            vector<vector<int>>& mine = local[omp_get_thread_num()];
+            #pragma omp for schedule(static)
+            for (long f = 0; f < (long)mesh.triangle_count(); f++) {
+                int seen[3] = {-1, -1, -1};
+                for (int c = 0; c < 3; c++) {
+                    int p = owner(mesh.indices[3 * f + c]);
+                    if (p == seen[0] || p == seen[1]) continue;
+                    seen[c] = p;
+                    mine[p].push_back((int)f);
+                }
+            }
+        }
+
+        faces.assign(parts, vector<int>());
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int p = 0; p < parts; p++) {
+            for (int t = 0; t < threads; t++) faces[p].insert(faces[p].end(), local[t][p].begin(), local[t][p].end());
+        }
+    }
+
+    int parts() const { return (int)range_begin.size() - 1; }
+
+    int owner(int vertex) const {
+        return int(upper_bound(range_begin.begin(), range_begin.end(), vertex) - range_begin.begin()) - 1;
+    }
+
+    bool owns(int p, int vertex) const { return vertex >= range_begin[p] && vertex < range_begin[p + 1]; }
+};
+
+enum class NormalWeighting { Area, Angle };
+
+inline double vector_length(const Point3D& v) { return sqrt(v.x * v.x + v.y * v.y + v.z * v.z); }
+
+inline double corner_angle(const Point3D& at, const Point3D& a, const Point3D& b) {
+    Point3D u(a.x - at.x, a.y - at.y, a.z - at.z), v(b.x - at.x, b.y - at.y, b.z - at.z);
+    double lu = vector_length(u), lv = vector_length(v);
+    if (lu == 0 || lv == 0) return 0;
+    double c = (u.x * v.x + u.y * v.y + u.z * v.z) / (lu * lv);
+    return acos(max(-1.0, min(1.0, c)));
+}
+
+inline int default_partition_count() { return 4 * omp_get_max_threads(); }
+
+// Llena mesh.normals. Con peso por área el producto cruz sin normalizar ya
+// pondera cada cara; con peso por ángulo se usa la normal unitaria por el
+// ángulo interno en el vértice.
+inline void compute_vertex_normals(IndexedMesh& mesh, NormalWeighting weighting) {
+    OwnershipPartition partition(mesh, default_partition_count());
+    mesh.normals.assign(mesh.vertices.size(), Point3D(0, 0, 0));
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int p = 0; p < partition.parts(); p++) {
+        for (int f : partition.faces[p]) {
+            int idx[3] = {mesh.indices[3 * f], mesh.indices[3 * f + 1], mesh.indices[3 * f + 2]};
+            const Point3D& a = mesh.vertices[idx[0]];
+            const Point3D& b = mesh.vertices[idx[1]];
+            const Point3D& c = mesh.vertices[idx[2]];
+            Point3D n = face_normal(a, b, c);
+            double len = vector_length(n);
+            if (len == 0) continue;
+
+            for (int k = 0; k < 3; k++) {
+                if (!partition.owns(p, idx[k])) continue;
+                double w = 1.0;
+                if (weighting == NormalWeighting::Angle) {
+                    w = corner_angle(mesh.vertices[idx[k]], mesh.vertices[idx[(k + 1) % 3]], mesh.vertices[idx[(k + 2) % 3]]) / len;
+                }
+                Point3D& acc = mesh.normals[idx[k]];
+                acc.x += w * n.x; acc.y += w * n.y; acc.z += w * n.z;
+            }
+        }
+        for (int v = partition.range_begin[p]; v < partition.range_begin[p + 1]; v++) {
+            Point3D& acc = mesh.normals[v];
+            double len = vector_length(acc);
+            if (len > 0) { acc.x /= len; acc.y /= len; acc.z /= len; }
+        }
+    }
+}
+
+// Un paso de Laplaciano uniforme: p += factor * (promedio de vecinos - p).
+// Las aristas interiores aparecen en dos caras y pesan igual para todos.
+inline void laplacian_step(IndexedMesh& mesh, const OwnershipPartition& partition, double factor, vector<Point3D>& scratch) {
+    scratch.assign(mesh.vertices.size(), Point3D(0, 0, 0));
+    vector<int> counts(mesh.vertices.size(), 0);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int p = 0; p < partition.parts(); p++) {
+        for (int f : partition.faces[p]) {
+            for (int k = 0; k < 3; k++) {
+                int v = mesh.indices[3 * f + k];
+                if (!partition.owns(p, v)) continue;
+                for (int o = 1; o < 3; o++) {
+                    const Point3D& q = mesh.vertices[mesh.indices[3 * f + (k + o) % 3]];
+                    scratch[v].x += q.x; scratch[v].y += q.y; scratch[v].z += q.z;
+                }
+                counts[v] += 2;
+            }
+        }
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (long v = 0; v < (long)mesh.vertices.size(); v++) {
+        if (counts[v] == 0) continue;
+        Point3D& p = mesh.vertices[v];
+        p.x += factor * (scratch[v].x / counts[v] - p.x);
+        p.y += factor * (scratch[v].y / counts[v] - p.y);
+        p.z += factor * (scratch[v].z / counts[v] - p.z);
+    }
+}
+
+// Laplaciano (encoge la malla) o Taubin (lambda/mu alternados, sin encoger).
+inline void smooth_mesh(IndexedMesh& mesh, int iterations, bool taubin, double lambda = 0.5, double mu = -0.53) {
+    if (iterations <= 0 || mesh.vertices.empty()) return;
+    OwnershipPartition partition(mesh, default_partition_count());
+    vector<Point3D> scratch;
+    for (int it = 0; it < iterations; it++) {
+        laplacian_step(mesh, partition, lambda, scratch);
+        if (taubin) laplacian_step(mesh, partition, mu, scratch);
+    }
+}
+
+#endif // NORMALS_H
@@ -0,0 +1,131 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include "marching_cubes.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+// Avance estimado de un recorrido del octree a partir de TraversalCounters.
+// La fracción de nodos activos por profundidad (active / visited) predice
+// cuántos nodos tendrá el nivel siguiente: cada activo tiene 8 hijos. Los
+// niveles todavía sin visitar usan la fracción del más profundo ya visto.
+// Con el total estimado, la fracción hecha da el ETA al ritmo actual.
+
+class ProgressReport {
+public:
+    double seconds = 0;
+    double fraction = 0;             // nodos visitados / nodos estimados
+    double eta = 0;                  // segundos restantes estimados
+    uint64_t nodes = 0;              // visitados
+    uint64_t estimated_nodes = 0;
+    uint64_t triangles = 0;
+    double nodes_per_second = 0;
+    double triangles_per_second = 0;
+    vector<uint64_t> visited;        // por profundidad
+    vector<uint64_t> estimated;      // por profundidad
+    bool final = false;              // el recorrido terminó
+};
+
+inline ProgressReport estimate_progress(const TraversalCounters& counters, double seconds) {
+    int levels = counters.leaf_depth + 1;
+    ProgressReport report;
+    report.seconds = seconds;
+    report.visited.assign(levels, 0);
+    vector<uint64_t> active(levels, 0);
+    for (const auto& slot : counters.slots) {
+        for (int d = 0; d < levels; d++) {
+            report.visited[d] += slot.visited[d].load(memory_order_relaxed);
+            active[d] += slot.active[d].load(memory_order_relaxed);
+        }
+        report.triangles += slot.triangles.load(memory_order_relaxed);
+    }
+
+    // Nodos por nivel: 8 hijos por cada activo estimado del nivel anterior
+    report.estimated.assign(levels, 0);
+    double expected = 1, ratio = 0.5;
+    for (int d = 0; d < levels; d++) {
+        expected = max(expected, (double)report.visited[d]);
+        report.estimated[d] = (uint64_t)expected;
+        if (report.visited[d] > 0) ratio = (double)active[d] / (double)report.visited[d];
+        expected = 8 * expected * ratio;
+    }
+
+    for (int d = 0; d < levels; d++) {
+        report.nodes += report.visited[d];
+        report.estimated_nodes += report.estimated[d];
+    }
+    report.fraction = report.estimated_nodes ? min(1.0, (double)report.nodes / (double)report.estimated_nodes) : 0;
+    if (seconds > 0) {
+        report.nodes_per_second = report.nodes / seconds;
+        report.triangles_per_second = report.triangles / seconds;
+    }
+    report.eta = report.fraction > 0 ? seconds * (1 - report.fraction) / report.fraction : 0;
+    return report;
+}
+
+// Hilo que lee los contadores cada interval segundos y llama a callback con la
+// estimación; al destruirse llama una última vez con final = true. El
+// recorrido sólo suma en sus contadores.
+class ProgressMonitor {
+public:
+    ProgressMonitor(const TraversalCounters& counters, double interval, function<void(const ProgressReport&)> callback)
+        : counters(counters), interval(interval), callback(callback), t0(omp_get_wtime()) {
+        worker = thread([this]() { run(); });
+    }
+
+    ~ProgressMonitor() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+        ProgressReport report = estimate_progress(counters, omp_get_wtime() - t0);
+        report.final = true;
+        callback(report);
+    }
+
+private:
+    const TraversalCounters& counters;
+    double interval;
+    function<void(const ProgressReport&)> callback;
+    double t0;
+    mutex lock;
+    condition_variable wake;
+    bool stopping = false;
+    thread worker;
+
+    void run() {
+        unique_lock<mutex> guard(lock);
+        while (!wake.wait_for(guard, chrono::duration<double>(interval), [this]() { return stopping; })) {
+            guard.unlock();
+            callback(estimate_progress(counters, omp_get_wtime() - t0));
+            guard.lock();
+        }
+    }
+};
+
+// 1234567 -> "1.23M"
+inline string format_rate(double value) {
+    ostringstream text;
+    text << fixed << setprecision(value >= 1e3 ? 2 : 0);
+    if (value >= 1e6) text << value / 1e6 << "M";
+    else if (value >= 1e3) text << value / 1e3 << "k";
+    else text << value;
+    return text.str();
+}
+
+// Línea de avance para la terminal
+inline string format_progress(const ProgressReport& report) {
+    ostringstream line;
+    line << fixed << setprecision(1) << "Progress " << 100 * report.fraction << "% after " << report.seconds << " s";
+    if (!report.final) line << ", ETA " << report.eta << " s";
+    line << " | " << format_rate(report.nodes_per_second) << " nodes/s, " << format_rate(report.triangles_per_second) << " triangles/s";
+    return line.str();
+}
+
+#endif // PROGRESS_H
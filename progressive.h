@@ -0,0 +1,176 @@
+#ifndef PROGRESSIVE_H
+#define PROGRESSIVE_H
+
+#include "marching_cubes.h"
+#include "dual_contouring.h"
+
+// Extracción progresiva: el mismo octree que surface_to_triangles, recorrido
+// por niveles en lugar de en profundidad. Al terminar cada nivel, sus nodos
+// activos (los que pasaron el descarte) se usan como celdas de una malla
+// gruesa que sale enseguida como vista previa; el nivel siguiente subdivide
+// sólo esos nodos. Cada nodo se descarta una sola vez, igual que en el
+// recorrido recursivo, así que el costo extra son las celdas de las vistas
+// previas: cada nivel tiene ~1/4 de las celdas del siguiente, ~1/3 del último
+// en total. La vista previa del nivel d es la malla que daría una extracción
+// con celdas de tamaño dominio / 2^d.
+
+class PreviewLevel {
+public:
+    int depth = 0;               // celdas de tamaño dominio / 2^depth
+    Point3D cell_size;
+    bool final = false;          // la malla completa, igual a la de surface_to_soups
+    double seconds = 0;          // desde el inicio de la extracción
+    size_t active_nodes = 0;     // celdas evaluadas en este nivel
+    vector<TriangleSoup> soups;  // una por isovalor; el receptor puede quedárselas
+};
+
+// Receptor de los niveles, del más grueso al final, desde el hilo que llamó
+class PreviewSink {
+public:
+    virtual ~PreviewSink() {}
+    virtual void preview(PreviewLevel& level) = 0;
+};
+
+// Nodo (i, j, k) de profundidad depth en la grilla de 2^depth celdas por eje.
+// Se baja desde la raíz partiendo al medio como el recorrido recursivo, no
+// con start + i * h: en dominios que no son potencia de 2 esas cuentas
+// difieren en el último bit y cambiarían las muestras y la semilla del nodo.
+inline void node_bounds(Point3D start, Point3D end, int depth, uint64_t key, Point3D& s, Point3D& e) {
+    int index[3];
+    cell_coords(key, index[0], index[1], index[2]);
+    double lo[3] = {start.x, start.y, start.z};
+    double hi[3] = {end.x, end.y, end.z};
+    for (int level = depth - 1; level >= 0; level--) {
+        for (int axis = 0; axis < 3; axis++) {
+            double mid = (lo[axis] + hi[axis]) / 2;
+            if ((index[axis] >> level) & 1) lo[axis] = mid;
+            else hi[axis] = mid;
+        }
+    }
+    s = Point3D(lo[0], lo[1], lo[2]);
+    e = Point3D(hi[0], hi[1], hi[2]);
+}
+
+// Celdas de los nodos de un nivel, juntas en una sopa por isovalor
+inline vector<TriangleSoup> level_soups(const ScalarField& f, Point3D start, Point3D end, int depth, const NodeKeys& nodes,
+                                        const vector<double>& isovalues, const CellOptions& options) {
+    size_t attribute_count = options.attributes ? options.attributes->size() : 0;
+    vector<vector<TriangleSoup>> per_thread(omp_get_max_threads(), vector<TriangleSoup>(isovalues.size()));
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (long n = 0; n < (long)nodes.size(); n++) {
+        Point3D s, e;
+        node_bounds(start, end, depth, nodes[n], s, e);
+        cell_soups(f, s, e, isovalues, options, per_thread[omp_get_thread_num()]);
+    }
+
+    return merge_thread_soups(per_thread, isovalues.size(), attribute_count);
+}
+
+// Recorre el octree por niveles y entrega una vista previa por nivel desde
+// first_preview y la malla final. Las vistas previas no pasan por
+// options.samples. La cancelación corta entre nodos: los que no llegaron a
+// descartarse se toman como activos y la malla de ese nivel, completa pero
+// gruesa, sale como final.
+inline void progressive_surface(const ScalarField& f, Point3D start, Point3D end, double precision, const vector<double>& isovalues,
+                                const CellOptions& options, PreviewSink& sink, int first_preview = 2) {
+    double t0 = omp_get_wtime();
+    TraversalControl* control = options.control;
+    CellOptions preview_options = options;
+    preview_options.samples = nullptr;
+
+    // Profundidad de las hojas: la misma condición de corte que surface_to_triangles
+    CellGrid grid(start, end, precision);
+    int leaf_depth = 0;
+    while ((1 << leaf_depth) < grid.n) leaf_depth++;
+
+    double level_start = t0;
+    auto deliver = [&](int depth, bool final, size_t active, vector<TriangleSoup>&& soups) {
+        if (options.tracer) options.tracer->span(final ? "final level" : "preview level", level_start, omp_get_wtime());
+        PreviewLevel level;
+        level.depth = depth;
+        double n = double(uint64_t(1) << depth);
+        level.cell_size = Point3D((end.x - start.x) / n, (end.y - start.y) / n, (end.z - start.z) / n);
+        level.final = final;
+        level.seconds = omp_get_wtime() - t0;
+        level.active_nodes = active;
+        level.soups = move(soups);
+        sink.preview(level);
+        level_start = omp_get_wtime();
+    };
+
+    NodeKeys active(1, cell_key(0, 0, 0));
+    if (leaf_depth == 0) {
+        deliver(0, true, 1, level_soups(f, start, end, 0, active, isovalues, options));
+        if (control) control->complete(0);
+        return;
+    }
+    bool root_active = cube_contains_any(f, start, end, isovalues);
+    if (options.counters) options.counters->node(0, root_active);
+    if (!root_active) {
+        if (control) control->complete(0);
+        deliver(0, true, 0, vector<TriangleSoup>(isovalues.size()));
+        return;
+    }
+
+    for (int depth = 1; depth <= leaf_depth; depth++) {
+        // Hijos de los nodos activos del nivel anterior
+        NodeKeys children(8 * active.size());
+        #pragma omp parallel for schedule(static)
+        for (long n = 0; n < (long)active.size(); n++) {
+            int i, j, k;
+            cell_coords(active[n], i, j, k);
+            for (int octant = 0; octant < 8; octant++) {
+                int dx = octant & 1, dy = (octant >> 1) & 1, dz = (octant >> 2) & 1;
+                children[8 * n + octant] = cell_key(2 * i + dx, 2 * j + dy, 2 * k + dz);
+            }
+        }
+        active.clear();
+        active.shrink_to_fit();
+
+        if (depth == leaf_depth) {
+            // Hojas: sin descarte, como en el recorrido recursivo
+            size_t leaves = children.size();
+            vector<TriangleSoup> soups = level_soups(f, start, end, depth, children, isovalues, options);
+            if (control) control->complete(depth, leaves);
+            if (options.counters) {
+                size_t triangles = 0;
+                for (const auto& soup : soups) triangles += soup.triangles.size();
+                options.counters->leaf(depth, triangles, leaves);
+            }
+            deliver(depth, true, leaves, move(soups));
+            return;
+        }
+
+        vector<NodeKeys> next(omp_get_max_threads());
+        #pragma omp parallel for schedule(dynamic, 4)
+        for (long n = 0; n < (long)children.size(); n++) {
+            Point3D s, e;
+            node_bounds(start, end, depth, children[n], s, e);
+            TraceScope trace(options.tracer, s, e, depth);
+            bool active = (control && control->is_cancelled()) || cube_contains_any(f, s, e, isovalues);
+            if (!active) trace.culled();
+            if (active) {
+                next[omp_get_thread_num()].push_back(children[n]);
+            } else if (control) {
+                control->complete(depth);
+            }
+            if (options.counters) options.counters->node(depth, active);
+        }
+        for (auto& part : next) {
+            active.insert(active.end(), part.begin(), part.end());
+            NodeKeys().swap(part);
+        }
+        bool cancelled = control && control->cancelled;
+
+        if (cancelled || depth >= first_preview) {
+            deliver(depth, cancelled, active.size(), level_soups(f, start, end, depth, active, isovalues, preview_options));
+        }
+        if (cancelled || active.empty()) {
+            if (!cancelled) deliver(leaf_depth, true, 0, vector<TriangleSoup>(isovalues.size()));
+            return;
+        }
+    }
+}
+
+#endif // PROGRESSIVE_H
@@ -0,0 +1,314 @@
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+#include "dual_contouring.h"
+#include "expression_field.h"
+#include "mesh_io.h"
+#include "volume_field.h"
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+// Informe tipo roofline. Dos sondas miden los techos de la máquina con los
+// hilos de la corrida: el ancho de banda a memoria con los cuatro kernels de
+// STREAM y el cómputo con cadenas independientes de multiplicación y suma.
+// Después se miden tres kernels del programa sobre la grilla densa de hojas
+// (sin el descarte del octree): la evaluación del campo en las esquinas, el
+// kernel de celda de marching cubes con los valores ya evaluados y los
+// escritores OBJ y PLY. De cada uno se cuentan las FLOP y los bytes que lee y
+// escribe con un modelo fijo (no hay contadores de hardware), así que la
+// intensidad aritmética es una estimación; lo medido es el tiempo.
+
+// Una llamada a libm (sin, cos, atan2, pow...) cuenta como 20 FLOP; sqrt,
+// división, fabs, floor, min y max como 1, igual que una suma o un producto.
+const double libm_call_flops = 20;
+
+// Costo de una evaluación del campo: FLOP y bytes leídos de memoria (los
+// vóxeles de un volumen; 0 en las superficies analíticas)
+class FieldCost {
+public:
+    double flops = 0;
+    double bytes = 0;
+};
+
+// Contadas a mano sobre surfaces.h. El Mandelbulb sale del lazo en 2.8
+// pasadas en promedio sobre su dominio (1.8 completas, de unas 155 FLOP).
+inline FieldCost builtin_field_cost(const string& name) {
+    static const vector<pair<string, double>> flops = {
+        {"barth", 18}, {"sphere", 6}, {"torus", 9}, {"gyroid", 6 * libm_call_flops + 5},
+        {"mandelbulb", 300}, {"terrain", 195}, {"csg", 690},
+    };
+    FieldCost cost;
+    for (const auto& entry : flops) {
+        if (entry.first == name) cost.flops = entry.second;
+    }
+    return cost;
+}
+
+// Una FLOP por operación de la expresión compilada; las potencias enteras
+// chicas (exponente constante 2, 3 o 4) no pasan por pow
+inline FieldCost expression_field_cost(const Expression& expression) {
+    FieldCost cost;
+    for (size_t i = 0; i < expression.code.size(); i++) {
+        switch (expression.code[i].op) {
+            case Expression::Constant: case Expression::X: case Expression::Y: case Expression::Z: break;
+            case Expression::Sin: case Expression::Cos: case Expression::Tan: case Expression::Asin: case Expression::Acos:
+            case Expression::Atan: case Expression::Exp: case Expression::Log: case Expression::Atan2:
+                cost.flops += libm_call_flops;
+                break;
+            case Expression::Pow: {
+                const Expression::Instruction& exponent = expression.code[i - 1];
+                bool small = exponent.op == Expression::Constant && (exponent.value == 2 || exponent.value == 3 || exponent.value == 4);
+                cost.flops += small ? (exponent.value == 2 ? 1 : 2) : libm_call_flops;
+                break;
+            }
+            default: cost.flops += 1; break;
+        }
+    }
+    return cost;
+}
+
+// Trilineal: coordenadas de grilla, recorte y 8 pesos de 2 productos (63 FLOP,
+// 8 vóxeles). Tricúbica: 3 juegos de pesos de Catmull-Rom y 64 productos
+// acumulados (243 FLOP, 64 vóxeles).
+inline FieldCost volume_field_cost(const VolumeField& field) {
+    FieldCost cost;
+    bool trilinear = field.reconstruction == Reconstruction::Trilinear;
+    cost.flops = trilinear ? 63 : 243;
+    cost.bytes = (trilinear ? 8 : 64) * voxel_bytes(field.volume.type);
+    return cost;
+}
+
+class RooflinePeaks {
+public:
+    double flops = 0;      // FLOP/s de la sonda de cómputo
+    double bandwidth = 0;  // bytes/s, el mejor de los kernels STREAM
+    double copy = 0, scale = 0, add = 0, triad = 0;
+
+    // Intensidad (FLOP/byte) donde se cruzan los dos techos
+    double ridge() const { return flops / bandwidth; }
+    double roof(double intensity) const { return min(flops, intensity * bandwidth); }
+};
+
+class RooflineKernel {
+public:
+    string name;
+    double seconds = 0;  // la mejor repetición
+    double flops = 0;    // por corrida
+    double bytes = 0;    // leídos y escritos por corrida
+
+    double flop_rate() const { return flops / seconds; }
+    double byte_rate() const { return bytes / seconds; }
+    double intensity() const { return bytes > 0 ? flops / bytes : 0; }
+    bool memory_bound(const RooflinePeaks& peaks) const { return intensity() < peaks.ridge(); }
+    // Fracción del techo en su intensidad; sin FLOP, del ancho de banda
+    double roof_fraction(const RooflinePeaks& peaks) const {
+        return flops > 0 ? flop_rate() / peaks.roof(intensity()) : byte_rate() / peaks.bandwidth;
+    }
+};
+
+class RooflineReport {
+public:
+    int grid = 0;  // celdas por eje
+    size_t triangles = 0;
+    RooflinePeaks peaks;
+    vector<RooflineKernel> kernels;
+};
+
+// El menor tiempo de repetitions corridas después de warmup descartadas
+template <class Run>
+inline double best_seconds(int warmup, int repetitions, Run run) {
+    double best = INFINITY;
+    for (int r = 0; r < warmup + repetitions; r++) {
+        double t0 = omp_get_wtime();
+        run();
+        double elapsed = omp_get_wtime() - t0;
+        if (r >= warmup) best = min(best, elapsed);
+    }
+    return best;
+}
+
+// Tres arreglos de 2^23 doubles (64 MiB cada uno), bastante más que la caché.
+// Como en STREAM, los bytes son los que el kernel lee y escribe, sin la
+// lectura de cada línea antes de escribirla (write-allocate).
+const size_t stream_elements = size_t(1) << 23;
+
+inline void stream_probe(RooflinePeaks& peaks, int warmup, int repetitions) {
+    const size_t n = stream_elements;
+    unique_ptr<double[]> a(new double[n]), b(new double[n]), c(new double[n]);
+    // Primer toque desde los hilos que después recorren cada tramo
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; i++) {
+        a[i] = 1;
+        b[i] = 2;
+        c[i] = 0;
+    }
+    const double s = 3;
+    double* pa = a.get();
+    double* pb = b.get();
+    double* pc = c.get();
+    peaks.copy = 16.0 * n / best_seconds(warmup, repetitions, [&] {
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; i++) pc[i] = pa[i];
+    });
+    peaks.scale = 16.0 * n / best_seconds(warmup, repetitions, [&] {
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; i++) pb[i] = s * pc[i];
+    });
+    peaks.add = 24.0 * n / best_seconds(warmup, repetitions, [&] {
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; i++) pc[i] = pa[i] + pb[i];
+    });
+    peaks.triad = 24.0 * n / best_seconds(warmup, repetitions, [&] {
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; i++) pa[i] = pb[i] + s * pc[i];
+    });
+    peaks.bandwidth = max(max(peaks.copy, peaks.scale), max(peaks.add, peaks.triad));
+}
+
+// Destino de los acumuladores, para que el compilador no descarte la sonda
+inline volatile double probe_sink = 0;
+
+// Cada hilo hace acc = acc * m + a sobre 16 acumuladores independientes, que
+// el compilador vectoriza (y funde en FMA si -march lo permite); 2 FLOP por
+// paso. Es el pico que alcanza este binario, no el de la hoja de datos.
+inline void fma_probe(RooflinePeaks& peaks, int warmup, int repetitions) {
+    const long steps = 1 << 24;
+    const int lanes = 16;
+    int threads = 1;
+    double seconds = best_seconds(warmup, repetitions, [&] {
+        double total = 0;
+        int count = 0;
+        #pragma omp parallel reduction(+:total, count)
+        {
+            double acc[lanes];
+            for (int j = 0; j < lanes; j++) acc[j] = 1 + j * 1e-3;
+            const double m = 0.999999, a = 1e-6;  // punto fijo en 1: sin desborde ni subnormales
+            for (long step = 0; step < steps; step++) {
+                for (int j = 0; j < lanes; j++) acc[j] = acc[j] * m + a;
+            }
+            for (int j = 0; j < lanes; j++) total += acc[j];
+            count += 1;
+        }
+        probe_sink = total;
+        threads = count;
+    });
+    peaks.flops = 2.0 * lanes * steps * threads / seconds;
+}
+
+// FLOP del kernel de celda por arista cortada: el parámetro (2 restas y una
+// división) y el punto sobre la arista (3 restas, 3 productos y 3 sumas)
+const double cell_edge_flops = 12;
+
+// Sondas y kernels sobre la grilla densa de hojas de [start, end] con la
+// precisión dada. cost es el de una evaluación del campo. Los escritores van a
+// archivos temporales en directory (vacío = $TMPDIR o /tmp) que se borran.
+inline bool run_roofline(const ScalarField& f, const FieldCost& cost, Point3D start, Point3D end, double precision, double isovalue,
+                         int warmup, int repetitions, RooflineReport& report, const string& directory = "") {
+    stream_probe(report.peaks, warmup, repetitions);
+    fma_probe(report.peaks, warmup, repetitions);
+
+    CellGrid grid(start, end, precision);
+    const int n = grid.n, m = n + 1;
+    report.grid = n;
+    auto corner = [&](int i, int j, int k) { return ((size_t)k * m + j) * m + i; };
+
+    // Campo en las esquinas, por filas en x como las esquinas de las hojas
+    vector<double> values((size_t)m * m * m);
+    RooflineKernel field;
+    field.name = "field";
+    field.seconds = best_seconds(warmup, repetitions, [&] {
+        #pragma omp parallel
+        {
+            vector<Point3D> row(m);
+            #pragma omp for collapse(2) schedule(dynamic, 16)
+            for (int k = 0; k < m; k++) {
+                for (int j = 0; j < m; j++) {
+                    for (int i = 0; i < m; i++) row[i] = grid.corner(i, j, k);
+                    f.evaluate(row.data(), &values[corner(0, j, k)], m);
+                }
+            }
+        }
+    });
+    field.flops = (double)values.size() * cost.flops;
+    field.bytes = (double)values.size() * (sizeof(double) + cost.bytes);
+    report.kernels.push_back(field);
+
+    // Kernel de celda con los valores ya evaluados: lee 8 valores por celda y
+    // escribe los triángulos en la sopa de su hilo
+    vector<vector<Triangle>> soups(omp_get_max_threads());
+    RooflineKernel cell;
+    cell.name = "cell";
+    cell.seconds = best_seconds(warmup, repetitions, [&] {
+        #pragma omp parallel
+        {
+            vector<Triangle>& soup = soups[omp_get_thread_num()];
+            soup.clear();
+            #pragma omp for collapse(2) schedule(dynamic, 16)
+            for (int k = 0; k < n; k++) {
+                for (int j = 0; j < n; j++) {
+                    for (int i = 0; i < n; i++) {
+                        Point3D vertices[8];
+                        cell_corners(grid.corner(i, j, k), grid.corner(i + 1, j + 1, k + 1), vertices);
+                        double v[8] = {values[corner(i, j, k)], values[corner(i + 1, j, k)], values[corner(i + 1, j + 1, k)],
+                                       values[corner(i, j + 1, k)], values[corner(i, j, k + 1)], values[corner(i + 1, j, k + 1)],
+                                       values[corner(i + 1, j + 1, k + 1)], values[corner(i, j + 1, k + 1)]};
+                        vector<Triangle> triangles = marching_cubes_cell(vertices, v, isovalue);
+                        soup.insert(soup.end(), triangles.begin(), triangles.end());
+                    }
+                }
+            }
+        }
+    });
+    // Aristas cortadas, fuera de la medición: cada arista de cada celda
+    const int edges[12][2] = {{0,1},{1,2},{2,3},{3,0},{4,5},{5,6},{6,7},{7,4},{0,4},{1,5},{2,6},{3,7}};
+    const int offset[8][3] = {{0,0,0},{1,0,0},{1,1,0},{0,1,0},{0,0,1},{1,0,1},{1,1,1},{0,1,1}};
+    long cut_edges = 0;
+    #pragma omp parallel for collapse(2) reduction(+:cut_edges)
+    for (int k = 0; k < n; k++) {
+        for (int j = 0; j < n; j++) {
+            for (int i = 0; i < n; i++) {
+                bool inside[8];
+                for (int c = 0; c < 8; c++) inside[c] = values[corner(i + offset[c][0], j + offset[c][1], k + offset[c][2])] < isovalue;
+                for (int e = 0; e < 12; e++) cut_edges += inside[edges[e][0]] != inside[edges[e][1]];
+            }
+        }
+    }
+    vector<Triangle> triangles;
+    for (auto& soup : soups) {
+        triangles.insert(triangles.end(), soup.begin(), soup.end());
+        vector<Triangle>().swap(soup);
+    }
+    report.triangles = triangles.size();
+    cell.flops = cut_edges * cell_edge_flops;
+    cell.bytes = (double)n * n * n * 8 * sizeof(double) + (double)triangles.size() * sizeof(Triangle);
+    report.kernels.push_back(cell);
+
+    // Escritores sobre la malla soldada: leen vértices e índices y escriben el
+    // archivo. El formato es trabajo de enteros y de texto: 0 FLOP.
+    IndexedMesh mesh = weld_triangles(triangles);
+    vector<Triangle>().swap(triangles);
+    const char* tmpdir = getenv("TMPDIR");
+    string dir = !directory.empty() ? directory : (tmpdir && *tmpdir ? tmpdir : "/tmp");
+    double mesh_bytes = (double)mesh.vertices.size() * sizeof(Point3D) + (double)mesh.indices.size() * sizeof(int);
+    for (const char* format : {"obj", "ply"}) {
+        string filename = dir + "/marching_cubes_roofline_" + to_string(getpid()) + "." + format;
+        bool written = true;
+        RooflineKernel writer;
+        writer.name = string("write ") + format;
+        writer.seconds = best_seconds(warmup, repetitions, [&] { written = written && write_mesh(filename, mesh); });
+        ifstream file(filename, ios::binary | ios::ate);
+        double file_bytes = file.is_open() ? (double)file.tellg() : 0;
+        file.close();
+        remove(filename.c_str());
+        if (!written) {
+            cerr << "Error opening file: " << filename << endl;
+            return false;
+        }
+        writer.bytes = mesh_bytes + file_bytes;
+        report.kernels.push_back(writer);
+    }
+    return true;
+}
+
+#endif // ROOFLINE_H
@@ -0,0 +1,433 @@
+#ifndef SCALING_H
+#define SCALING_H
+
+#include "extractor.h"
+#include "mesh_io.h"
+#include "surfaces.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+// Arnés de escalabilidad dentro del proceso: recorre hilos × precisión ×
+// superficie × motor, con corridas de calentamiento descartadas y varias
+// repeticiones medidas por caso. Cada repetición separa las fases de marching
+// cubes (recorrido del octree, unión de las sopas por hilo, soldado y
+// escritura); los motores duales sólo separan la extracción de la escritura.
+// Por fase se informa la mediana con su intervalo de confianza del 95 % por
+// estadísticos de orden, y el speedup y la eficiencia contra el caso con menos
+// hilos de la misma superficie, motor y precisión. Las salidas son un CSV
+// ordenado (una fila por caso y fase) y un JSON con las muestras, que leen
+// graficas.py y graficasEscalabilidad.py.
+//
+// En modo débil el problema crece con los hilos para que el trabajo por hilo
+// quede constante (ver weak_plan). El trabajo de cada caso se mide en
+// evaluaciones del campo, contadas en una corrida aparte sin cronometrar (ver
+// CountingField): un nodo descartado cuesta hasta 10000 muestras y una celda
+// 8, así que contar nodos mezclaría costos muy distintos. La eficiencia es el
+// rendimiento (evaluaciones por segundo) por hilo relativo al caso base, que
+// en modo fuerte se reduce al speedup / hilos.
+// excess_s es el tiempo de cada fase por encima del ideal, y dice qué fase se
+// come la eficiencia (descarte y celdas, unión, soldado o escritura).
+
+enum class ScalingMode {
+    Strong,  // el mismo problema con más hilos
+    Weak     // el problema crece con los hilos: trabajo por hilo constante
+};
+
+inline const char* scaling_mode_name(ScalingMode mode) { return mode == ScalingMode::Weak ? "weak" : "strong"; }
+
+inline bool parse_scaling_mode(const string& name, ScalingMode& mode) {
+    if (name == "strong") mode = ScalingMode::Strong;
+    else if (name == "weak") mode = ScalingMode::Weak;
+    else return false;
+    return true;
+}
+
+class ScalingOptions {
+public:
+    vector<ScalingMode> modes = vector<ScalingMode>(1, ScalingMode::Strong);
+    vector<int> threads = {1, 2, 4, 8};
+    vector<double> precisions = {0.1};  // en modo débil, la del caso con menos hilos
+    vector<BuiltinSurface> surfaces;    // vacío = la superficie por defecto (barth)
+    vector<Engine> engines = vector<Engine>(1, Engine::MarchingCubes);
+    int warmup = 1;                     // corridas descartadas por caso
+    int repetitions = 5;                // corridas medidas por caso
+    string output = "/dev/null";        // destino de la fase de escritura (el formato sale de la extensión)
+};
+
+class PhaseSamples {
+public:
+    string phase;
+    vector<double> seconds;  // una por repetición, en orden
+    double median = 0, ci_low = 0, ci_high = 0, mean = 0, min = 0, max = 0;
+    double speedup = 1, efficiency = 1;
+    double excess = 0;       // mediana menos el tiempo ideal escalado desde el caso base
+
+    // Mediana e intervalo del 95 % por rangos de la binomial(n, 1/2) con la
+    // aproximación normal; con menos de 6 muestras queda [mínimo, máximo].
+    void summarize() {
+        if (seconds.empty()) return;
+        vector<double> sorted = seconds;
+        sort(sorted.begin(), sorted.end());
+        size_t n = sorted.size();
+        median = (n % 2) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+        double half = 1.96 * sqrt((double)n) / 2;
+        long low = (long)floor(n / 2.0 - half), high = (long)ceil(1 + n / 2.0 + half);  // rangos desde 1
+        ci_low = sorted[(size_t)std::max(1L, low) - 1];
+        ci_high = sorted[(size_t)std::min((long)n, high) - 1];
+        mean = 0;
+        for (double s : sorted) mean += s;
+        mean /= n;
+        min = sorted.front();
+        max = sorted.back();
+    }
+};
+
+class ScalingResult {
+public:
+    ScalingMode mode = ScalingMode::Strong;
+    string surface;
+    Engine engine = Engine::MarchingCubes;
+    double precision = 0;  // la usada en este caso
+    int grid = 0;          // celdas por eje de la grilla de hojas
+    int tiles = 1;         // copias de la superficie por eje (modo débil)
+    int threads = 1;
+    size_t triangles = 0;  // de la última repetición
+    uint64_t evaluations = 0;  // evaluaciones del campo por corrida
+    double work = 1;           // evaluaciones relativas al caso base; 1 en modo fuerte
+    vector<PhaseSamples> phases;
+
+    const PhaseSamples* phase(const string& name) const {
+        for (const auto& p : phases) {
+            if (p.phase == name) return &p;
+        }
+        return nullptr;
+    }
+};
+
+// Superficie repetida en tiles³ copias contiguas de su dominio. Las
+// superficies incluidas son simétricas en cada eje, periódicas con su dominio
+// o no tocan el borde, así que las copias empalman sin paredes nuevas en las
+// caras compartidas.
+class TiledField {
+public:
+    ScalarField base;
+    Point3D start, size;  // dominio de una copia
+    int tiles = 1;
+
+    ScalarField field() const { return ScalarField(evaluate, this, base.contains_surface ? contains_surface : nullptr); }
+
+private:
+    // Coordenada dentro de la copia que contiene v
+    static double local(double v, double start, double size, int tiles) {
+        double copy = max(0.0, min((double)(tiles - 1), floor((v - start) / size)));
+        return v - copy * size;
+    }
+
+    static double evaluate(const void* data, double x, double y, double z) {
+        const TiledField& t = *(const TiledField*)data;
+        return t.base(local(x, t.start.x, t.size.x, t.tiles), local(y, t.start.y, t.size.y, t.tiles),
+                      local(z, t.start.z, t.size.z, t.tiles));
+    }
+
+    // El nodo puede cruzar copias: se consulta cada pedazo en su copia
+    static bool contains_surface(const void* data, Point3D start, Point3D end, double isovalue) {
+        const TiledField& t = *(const TiledField*)data;
+        int first[3], last[3];
+        const double s[3] = {start.x, start.y, start.z}, e[3] = {end.x, end.y, end.z};
+        const double origin[3] = {t.start.x, t.start.y, t.start.z}, size[3] = {t.size.x, t.size.y, t.size.z};
+        for (int a = 0; a < 3; a++) {
+            first[a] = max(0, min(t.tiles - 1, (int)floor((s[a] - origin[a]) / size[a])));
+            last[a] = max(0, min(t.tiles - 1, (int)ceil((e[a] - origin[a]) / size[a]) - 1));
+        }
+        for (int i = first[0]; i <= last[0]; i++) {
+            for (int j = first[1]; j <= last[1]; j++) {
+                for (int k = first[2]; k <= last[2]; k++) {
+                    const int copy[3] = {i, j, k};
+                    double a[3], b[3];
+                    for (int d = 0; d < 3; d++) {
+                        a[d] = max(s[d], origin[d] + copy[d] * size[d]) - copy[d] * size[d];
+                        b[d] = min(e[d], origin[d] + (copy[d] + 1) * size[d]) - copy[d] * size[d];
+                    }
+                    if (t.base.contains_surface(t.base.data, Point3D(a[0], a[1], a[2]), Point3D(b[0], b[1], b[2]), isovalue)) return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+// Campo que cuenta sus evaluaciones; una consulta de rango cuenta como una.
+// Conserva la forma del campo base (por lotes o punto a punto) para que el
+// muestreo de los nodos pida los mismos puntos.
+class CountingField {
+public:
+    ScalarField base;
+    mutable atomic<uint64_t> evaluations{0};
+
+    CountingField(const ScalarField& base) : base(base) {}
+
+    ScalarField field() const {
+        RangeQuery range = base.contains_surface ? contains_surface : nullptr;
+        return base.batch ? ScalarField::batched(evaluate_batch, this, range) : ScalarField(evaluate, this, range);
+    }
+
+private:
+    typedef ScalarField::RangeQuery RangeQuery;
+
+    static double evaluate(const void* data, double x, double y, double z) {
+        const CountingField& c = *(const CountingField*)data;
+        c.evaluations.fetch_add(1, memory_order_relaxed);
+        return c.base(x, y, z);
+    }
+
+    static void evaluate_batch(const void* data, const double* xyz, double* values, size_t count) {
+        const CountingField& c = *(const CountingField*)data;
+        c.evaluations.fetch_add(count, memory_order_relaxed);
+        c.base.batch(c.base.data, xyz, values, count);
+    }
+
+    static bool contains_surface(const void* data, Point3D start, Point3D end, double isovalue) {
+        const CountingField& c = *(const CountingField*)data;
+        c.evaluations.fetch_add(1, memory_order_relaxed);
+        return c.base.contains_surface(c.base.data, start, end, isovalue);
+    }
+};
+
+// Cómo crece el problema en modo débil para factor = hilos / hilos base. Con
+// el descarte del octree el trabajo va con el área de la superficie sobre el
+// tamaño de celda al cuadrado: refinar la grilla al doble lo multiplica por 4
+// y repetir la superficie 2 veces por eje (con la misma celda) por 8. La
+// grilla sólo se refina por potencias de 2, así que se combina: con 2^k, una
+// repetición por eje si k es impar y el resto en refinamiento. La grilla nunca
+// queda más gruesa que la del caso base (cambiaría la mezcla de descartes y
+// celdas), así que k = 1 refina al doble (4 en lugar de 2). Los factores que
+// no son potencias de 2 se redondean y la diferencia la corrige el trabajo medido.
+class WeakPlan {
+public:
+    int tiles = 1;        // copias por eje
+    double refine = 1;    // celdas por eje de cada copia, relativas al caso base
+};
+
+inline WeakPlan weak_plan(double factor) {
+    int k = max(0, (int)lround(log2(factor)));
+    WeakPlan plan;
+    if (k == 1) {
+        plan.refine = 2;
+        return plan;
+    }
+    plan.tiles = 1 << (k % 2);
+    plan.refine = pow(2.0, (k - 3 * (k % 2)) / 2);
+    return plan;
+}
+
+// Una repetición: tiempos por fase y triángulos. Las fases se crean en la
+// primera llamada y las siguientes sólo agregan muestras.
+inline bool run_scaling_case(const Extractor& extractor, const string& output, ScalingResult& result, bool record) {
+    vector<pair<string, double>> times;
+    double t0 = omp_get_wtime(), t = t0;
+    auto lap = [&](const char* phase) {
+        double now = omp_get_wtime();
+        times.push_back({phase, now - t});
+        t = now;
+    };
+
+    IndexedMesh mesh;
+    const ExtractionConfig& config = extractor.config;
+    if (is_dual(config.engine)) {
+        vector<IndexedMesh> meshes = extractor.extract_meshes();
+        mesh = move(meshes[0]);
+        lap("traverse");
+    } else {
+        CellOptions options = extractor.cell_options();
+        vector<vector<TriangleSoup>> per_thread =
+            surface_to_thread_soups(extractor.field(), config.start, config.end, config.precision, config.isovalues, options);
+        lap("traverse");
+        vector<TriangleSoup> soups = merge_thread_soups(per_thread, config.isovalues.size(), 0);
+        lap("merge");
+        mesh = weld_soup(soups[0], extractor.attribute_name_list());
+        soups.clear();
+        lap("weld");
+    }
+    if (!write_mesh(output, mesh)) {
+        cerr << "Error opening file: " << output << endl;
+        return false;
+    }
+    lap("write");
+    times.push_back({"total", t - t0});
+
+    if (!record) return true;
+    result.triangles = mesh.triangle_count();
+    if (result.phases.empty()) {
+        for (const auto& time : times) {
+            result.phases.emplace_back();
+            result.phases.back().phase = time.first;
+        }
+    }
+    for (size_t p = 0; p < times.size(); p++) result.phases[p].seconds.push_back(times[p].second);
+    return true;
+}
+
+// Speedup, eficiencia y exceso de cada fase contra el caso base (el primero,
+// con menos hilos). En modo débil el speedup es el escalado: eficiencia × hilos.
+inline void compute_speedups(ScalingResult& r, const ScalingResult& base) {
+    double scale = (double)base.threads / r.threads;
+    if (r.mode == ScalingMode::Weak) r.work = base.evaluations ? (double)r.evaluations / base.evaluations : 0;
+    for (auto& p : r.phases) {
+        const PhaseSamples* bp = base.phase(p.phase);
+        if (!bp) continue;
+        double ideal = bp->median * r.work * scale;
+        p.efficiency = p.median > 0 ? ideal / p.median : 0;
+        p.speedup = p.efficiency / scale;
+        p.excess = p.median - ideal;
+    }
+}
+
+// Extractor de un caso: la superficie tal cual o repetida según el plan débil.
+// La precisión queda a 1.5 celdas buscadas: CellGrid da exactamente esa grilla.
+inline void configure_scaling_case(Extractor& extractor, const BuiltinSurface& surface, double precision, const WeakPlan& plan,
+                                   TiledField& tiled, ScalingResult& result) {
+    extractor.config.start = surface.start;
+    extractor.config.end = surface.end;
+    extractor.config.precision = precision;
+    if (plan.tiles > 1 || plan.refine != 1) {
+        Point3D size(surface.end.x - surface.start.x, surface.end.y - surface.start.y, surface.end.z - surface.start.z);
+        double extent = min(size.x, min(size.y, size.z));
+        double cells = max(1.0, CellGrid(surface.start, surface.end, precision).n * plan.refine);  // por copia y eje
+        tiled.base = surface.field;
+        tiled.start = surface.start;
+        tiled.size = size;
+        tiled.tiles = plan.tiles;
+        extractor.set_field(tiled.field());
+        extractor.config.end = Point3D(surface.start.x + size.x * plan.tiles, surface.start.y + size.y * plan.tiles,
+                                       surface.start.z + size.z * plan.tiles);
+        extractor.config.precision = 1.5 * extent / cells;
+    }
+    result.surface = surface.name;
+    result.precision = extractor.config.precision;
+    result.grid = CellGrid(extractor.config.start, extractor.config.end, extractor.config.precision).n;
+    result.tiles = plan.tiles;
+}
+
+// Corre el barrido. Del extractor modelo se toman el primer isovalor y el
+// snap; sin atributos, recolector, traza ni plazo. report recibe cada caso terminado.
+// Si falla la escritura devuelve un resultado vacío.
+inline vector<ScalingResult> run_scaling(const Extractor& model, const ScalingOptions& options,
+                                         const function<void(const ScalingResult&)>& report = nullptr) {
+    vector<BuiltinSurface> surfaces = options.surfaces;
+    if (surfaces.empty()) surfaces.push_back(*find_surface("barth"));
+    vector<int> threads = options.threads;
+    sort(threads.begin(), threads.end());  // el caso base va primero
+    int restore = omp_get_max_threads();
+
+    vector<ScalingResult> results;
+    for (ScalingMode mode : options.modes) {
+        for (const auto& surface : surfaces) {
+            for (Engine engine : options.engines) {
+                for (double precision : options.precisions) {
+                    size_t base = results.size();
+                    for (int t : threads) {
+                        Extractor extractor(surface.field, model.config);
+                        extractor.config.engine = engine;
+                        extractor.config.isovalues.resize(1);
+                        extractor.config.samples = nullptr;
+                        extractor.config.control = nullptr;
+                        extractor.config.tracer = nullptr;
+                        extractor.config.time_limit = 0;
+                        omp_set_num_threads(t);
+                        extractor.config.counters = nullptr;
+                        ScalingResult result;
+                        result.mode = mode;
+                        result.engine = engine;
+                        result.threads = t;
+                        TiledField tiled;
+                        WeakPlan plan = mode == ScalingMode::Weak ? weak_plan((double)t / threads[0]) : WeakPlan();
+                        configure_scaling_case(extractor, surface, precision, plan, tiled, result);
+
+                        // Trabajo del caso: una corrida sin cronometrar con el campo contado
+                        CountingField counting(extractor.field());
+                        Extractor counted(counting.field(), extractor.config);
+                        bool ok = run_scaling_case(counted, options.output, result, false);
+                        result.evaluations = counting.evaluations.load();
+                        for (int r = 0; ok && r < options.warmup + options.repetitions; r++) {
+                            ok = run_scaling_case(extractor, options.output, result, r >= options.warmup);
+                        }
+                        if (!ok) {
+                            omp_set_num_threads(restore);
+                            return vector<ScalingResult>();
+                        }
+                        for (auto& p : result.phases) p.summarize();
+                        compute_speedups(result, results.size() > base ? results[base] : result);
+                        results.push_back(result);
+                        if (report) report(results.back());
+                    }
+                }
+            }
+        }
+    }
+    omp_set_num_threads(restore);
+    return results;
+}
+
+inline bool write_scaling_csv(const string& filename, const vector<ScalingResult>& results, const ScalingOptions& options) {
+    ofstream file(filename);
+    if (!file.is_open()) return false;
+    file << "mode,surface,engine,precision,grid,tiles,threads,repetitions,triangles,evaluations,work,phase,median_s,ci_low_s,ci_high_s,mean_s,"
+            "min_s,max_s,speedup,efficiency,excess_s\n";
+    char line[512];
+    for (const auto& r : results) {
+        for (const auto& p : r.phases) {
+            snprintf(line, sizeof(line), "%s,%s,%s,%g,%d,%d,%d,%d,%zu,%llu,%.4f,%s,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.4f,%.4f,%.6f\n",
+                     scaling_mode_name(r.mode), r.surface.c_str(), engine_name(r.engine), r.precision, r.grid, r.tiles, r.threads,
+                     options.repetitions, r.triangles, (unsigned long long)r.evaluations, r.work, p.phase.c_str(), p.median, p.ci_low, p.ci_high, p.mean, p.min, p.max,
+                     p.speedup, p.efficiency, p.excess);
+            file << line;
+        }
+    }
+    return (bool)file;
+}
+
+// Mismos datos con las muestras de cada fase y la configuración del barrido
+inline bool write_scaling_json(const string& filename, const vector<ScalingResult>& results, const ScalingOptions& options) {
+    ofstream file(filename);
+    if (!file.is_open()) return false;
+    file << "{\"schema\":\"marching-cubes-scaling/3\",\n\"config\":{\"modes\":[";
+    for (size_t i = 0; i < options.modes.size(); i++) file << (i ? "," : "") << "\"" << scaling_mode_name(options.modes[i]) << "\"";
+    file << "],\"warmup\":" << options.warmup
+         << ",\"repetitions\":" << options.repetitions << ",\"processors\":" << omp_get_num_procs() << ",\"threads\":[";
+    for (size_t i = 0; i < options.threads.size(); i++) file << (i ? "," : "") << options.threads[i];
+    file << "],\"precisions\":[";
+    for (size_t i = 0; i < options.precisions.size(); i++) file << (i ? "," : "") << options.precisions[i];
+    file << "],\"engines\":[";
+    for (size_t i = 0; i < options.engines.size(); i++) file << (i ? "," : "") << "\"" << engine_name(options.engines[i]) << "\"";
+    file << "]},\n\"results\":[";
+    char line[512];
+    for (size_t i = 0; i < results.size(); i++) {
+        const ScalingResult& r = results[i];
+        snprintf(line, sizeof(line),
+                 "%s\n{\"mode\":\"%s\",\"surface\":\"%s\",\"engine\":\"%s\",\"precision\":%g,\"grid\":%d,\"tiles\":%d,\"threads\":%d,"
+                 "\"triangles\":%zu,\"evaluations\":%llu,\"work\":%.4f,\"phases\":{",
+                 i ? "," : "", scaling_mode_name(r.mode), r.surface.c_str(), engine_name(r.engine), r.precision, r.grid, r.tiles,
+                 r.threads, r.triangles, (unsigned long long)r.evaluations, r.work);
+        file << line;
+        for (size_t p = 0; p < r.phases.size(); p++) {
+            const PhaseSamples& s = r.phases[p];
+            snprintf(line, sizeof(line),
+                     "%s\"%s\":{\"median_s\":%.6f,\"ci_low_s\":%.6f,\"ci_high_s\":%.6f,\"mean_s\":%.6f,\"min_s\":%.6f,\"max_s\":%.6f,"
+                     "\"speedup\":%.4f,\"efficiency\":%.4f,\"excess_s\":%.6f,\"samples_s\":[",
+                     p ? "," : "", s.phase.c_str(), s.median, s.ci_low, s.ci_high, s.mean, s.min, s.max, s.speedup, s.efficiency,
+                     s.excess);
+            file << line;
+            for (size_t k = 0; k < s.seconds.size(); k++) {
+                snprintf(line, sizeof(line), "%s%.6f", k ? "," : "", s.seconds[k]);
+                file << line;
+            }
+            file << "]}";
+        }
+        file << "}}";
+    }
+    file << "\n]}\n";
+    return (bool)file;
+}
+
+#endif // SCALING_H
@@ -0,0 +1,283 @@
+#ifndef SDF_VOLUME_H
+#define SDF_VOLUME_H
+
+#include "marching_cubes.h"
+#include "dual_contouring.h"
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <atomic>
+
+// Volumen de distancia con signo en banda estrecha, armado con los valores de
+// esquina que la extracción ya evaluó (sin otra pasada sobre f).
+//
+// Los valores se guardan por ladrillos de 8x8x8 muestras de la grilla de hojas:
+// sólo los ladrillos que tocan la banda, una máscara de 512 bits con las
+// muestras presentes y cada muestra cuantizada a 16 bits. La distancia se
+// aproxima como f / |∇f| con el gradiente por diferencias sobre la misma grilla;
+// toda muestra de la banda es esquina de una hoja, así que en cada eje tiene al
+// menos un vecino guardado. Las muestras fuera de la banda no se guardan.
+
+// Junta (muestra, valor) por hilo. Las claves son índices de la grilla de hojas.
+// El recolector se arma antes de saber quién lo va a llamar: el recorrido por
+// tareas, los niveles de la extracción progresiva o hilos propios de quien usa
+// la biblioteca, con equipos de cualquier tamaño. En lugar de indexar por
+// omp_get_thread_num() cada hilo registra su propio búfer la primera vez que
+// graba en este recolector.
+typedef tracked_vector<pair<uint64_t, float>, MemoryCategory::Caches> BandSamples;
+
+class NarrowBandRecorder : public CornerSink {
+public:
+    CellGrid grid;
+    deque<BandSamples> per_thread;  // deque: referencias estables
+
+    NarrowBandRecorder(Point3D start, Point3D end, double precision) : grid(start, end, precision), id(next_id()) {}
+
+    void record(const Point3D corners[8], const double values[8]) override {
+        int i = (int)lround((corners[0].x - grid.origin.x) / grid.hx);
+        int j = (int)lround((corners[0].y - grid.origin.y) / grid.hy);
+        int k = (int)lround((corners[0].z - grid.origin.z) / grid.hz);
+        auto& out = thread_buffer();
+        for (int c = 0; c < 8; c++) {
+            out.push_back({cell_key(i + cube_corner_offsets[c][0], j + cube_corner_offsets[c][1], k + cube_corner_offsets[c][2]),
+                           (float)values[c]});
+        }
+    }
+
+private:
+    uint64_t id;
+    mutex buffers_lock;
+
+    static uint64_t next_id() {
+        static atomic<uint64_t> counter(0);
+        return ++counter;
+    }
+
+    BandSamples& thread_buffer() {
+        thread_local uint64_t owner = 0;
+        thread_local BandSamples* buffer = nullptr;
+        if (owner != id) {
+            lock_guard<mutex> guard(buffers_lock);
+            per_thread.emplace_back();
+            buffer = &per_thread.back();
+            owner = id;
+        }
+        return *buffer;
+    }
+};
+
+// 18 bits por eje: los ladrillos de una grilla de hasta 2^21 celdas, con lugar
+// para los 9 bits de la muestra local en brick_sample_key.
+inline uint64_t brick_key(int i, int j, int k) {
+    return (uint64_t(i) << 36) | (uint64_t(j) << 18) | uint64_t(k);
+}
+
+inline void brick_coords(uint64_t key, int& i, int& j, int& k) {
+    i = int((key >> 36) & 0x3FFFF);
+    j = int((key >> 18) & 0x3FFFF);
+    k = int(key & 0x3FFFF);
+}
+
+class SparseVolume {
+public:
+    static const int brick = 8;  // muestras por eje de cada ladrillo
+
+    Point3D origin;
+    double hx = 0, hy = 0, hz = 0;
+    int samples_per_axis = 0;    // n + 1
+    float scale = 1;             // distancia = valor cuantizado * scale
+
+    // Los ladrillos se cuentan en MemoryCategory::Caches
+    tracked_vector<uint64_t, MemoryCategory::Caches> brick_keys;  // brick_key de cada ladrillo, ordenadas
+    tracked_vector<uint64_t, MemoryCategory::Caches> masks;       // 8 palabras por ladrillo
+    tracked_vector<size_t, MemoryCategory::Caches> offsets;       // primer valor de cada ladrillo en values
+    tracked_vector<int16_t, MemoryCategory::Caches> values;
+
+    size_t sample_count() const { return values.size(); }
+
+    size_t stored_bytes() const {
+        return brick_keys.size() * (3 * sizeof(uint32_t) + 8 * sizeof(uint64_t)) + values.size() * sizeof(int16_t);
+    }
+
+    // Distancia en la muestra (i, j, k); false si queda fuera de la banda.
+    bool sample(int i, int j, int k, double& distance) const {
+        if (i < 0 || j < 0 || k < 0) return false;
+        uint64_t key = brick_key(i / brick, j / brick, k / brick);
+        auto it = lower_bound(brick_keys.begin(), brick_keys.end(), key);
+        if (it == brick_keys.end() || *it != key) return false;
+        size_t b = it - brick_keys.begin();
+        int local = ((i % brick) * brick + (j % brick)) * brick + (k % brick);
+        const uint64_t* mask = &masks[8 * b];
+        if (!((mask[local >> 6] >> (local & 63)) & 1)) return false;
+        size_t rank = 0;
+        for (int w = 0; w < (local >> 6); w++) rank += __builtin_popcountll(mask[w]);
+        rank += __builtin_popcountll(mask[local >> 6] & ((uint64_t(1) << (local & 63)) - 1));
+        distance = values[offsets[b] + rank] * (double)scale;
+        return true;
+    }
+};
+
+// Clave ordenada por ladrillo y, dentro de él, por muestra local
+inline uint64_t brick_sample_key(int i, int j, int k) {
+    int b = SparseVolume::brick;
+    uint64_t local = uint64_t(((i % b) * b + (j % b)) * b + (k % b));
+    return (brick_key(i / b, j / b, k / b) << 9) | local;
+}
+
+inline SparseVolume build_sparse_volume(const NarrowBandRecorder& recorder) {
+    const CellGrid& grid = recorder.grid;
+    BandSamples samples;
+    for (const auto& part : recorder.per_thread) samples.insert(samples.end(), part.begin(), part.end());
+
+    // Reordenar por ladrillo; las esquinas compartidas traen el mismo valor
+    #pragma omp parallel for schedule(static)
+    for (long s = 0; s < (long)samples.size(); s++) {
+        int i, j, k;
+        cell_coords(samples[s].first, i, j, k);
+        samples[s].first = brick_sample_key(i, j, k);
+    }
+    sort(samples.begin(), samples.end(), [](const pair<uint64_t, float>& a, const pair<uint64_t, float>& b) { return a.first < b.first; });
+    samples.erase(unique(samples.begin(), samples.end(),
+                         [](const pair<uint64_t, float>& a, const pair<uint64_t, float>& b) { return a.first == b.first; }),
+                  samples.end());
+
+    auto find_value = [&](int i, int j, int k, float& value) {
+        if (i < 0 || j < 0 || k < 0 || i > grid.n || j > grid.n || k > grid.n) return false;
+        uint64_t key = brick_sample_key(i, j, k);
+        auto it = lower_bound(samples.begin(), samples.end(), key,
+                              [](const pair<uint64_t, float>& a, uint64_t key) { return a.first < key; });
+        if (it == samples.end() || it->first != key) return false;
+        value = it->second;
+        return true;
+    };
+
+    // Las hojas visitadas están a menos de dos celdas padre de la superficie,
+    // así que la banda se acota a cuatro diagonales de hoja; fuera de eso
+    // f / |∇f| sólo puede venir de un gradiente casi nulo y se recorta.
+    double spacing[3] = {grid.hx, grid.hy, grid.hz};
+    double band = 4 * sqrt(grid.hx * grid.hx + grid.hy * grid.hy + grid.hz * grid.hz);
+
+    // f / |∇f| con diferencias centradas donde hay vecinos a ambos lados
+    tracked_vector<double, MemoryCategory::Caches> distances(samples.size());
+    #pragma omp parallel for schedule(static)
+    for (long s = 0; s < (long)samples.size(); s++) {
+        uint64_t b = samples[s].first >> 9;
+        int local = int(samples[s].first & 511);
+        int bi, bj, bk;
+        brick_coords(b, bi, bj, bk);
+        int ijk[3] = {bi * SparseVolume::brick + local / (SparseVolume::brick * SparseVolume::brick),
+                      bj * SparseVolume::brick + (local / SparseVolume::brick) % SparseVolume::brick,
+                      bk * SparseVolume::brick + local % SparseVolume::brick};
+        double value = samples[s].second, gradient2 = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            int lo[3] = {ijk[0], ijk[1], ijk[2]}, hi[3] = {ijk[0], ijk[1], ijk[2]};
+            lo[axis]--; hi[axis]++;
+            float below, above;
+            bool has_below = find_value(lo[0], lo[1], lo[2], below);
+            bool has_above = find_value(hi[0], hi[1], hi[2], above);
+            double g = 0;
+            if (has_below && has_above) g = (above - below) / (2 * spacing[axis]);
+            else if (has_above) g = (above - value) / spacing[axis];
+            else if (has_below) g = (value - below) / spacing[axis];
+            gradient2 += g * g;
+        }
+        double distance = gradient2 > 1e-24 ? value / sqrt(gradient2) : (value < 0 ? -band : band);
+        distances[s] = max(-band, min(band, distance));
+    }
+
+    SparseVolume volume;
+    volume.origin = grid.origin;
+    volume.hx = grid.hx; volume.hy = grid.hy; volume.hz = grid.hz;
+    volume.samples_per_axis = grid.n + 1;
+    volume.scale = float(band / 32767);
+    volume.values.resize(samples.size());
+    for (size_t s = 0; s < samples.size(); s++) {
+        uint64_t b = samples[s].first >> 9;
+        int local = int(samples[s].first & 511);
+        if (volume.brick_keys.empty() || volume.brick_keys.back() != b) {
+            volume.brick_keys.push_back(b);
+            volume.masks.insert(volume.masks.end(), 8, 0);
+            volume.offsets.push_back(s);
+        }
+        volume.masks[volume.masks.size() - 8 + (local >> 6)] |= uint64_t(1) << (local & 63);
+        volume.values[s] = (int16_t)lround(max(-32767.0, min(32767.0, distances[s] / volume.scale)));
+    }
+    return volume;
+}
+
+// Formato binario (endianness del host):
+//   "SDFV" u32 versión, u32 muestras por eje, f64 origen[3], f64 paso[3],
+//   f32 escala, u32 tamaño de ladrillo, u64 ladrillos;
+//   por ladrillo: u32 coordenadas[3], u64 máscara[8], i16 valores presentes.
+inline bool write_sparse_volume(const string& filename, const SparseVolume& volume) {
+    ofstream file(filename, ios::binary);
+    if (!file.is_open()) return false;
+
+    uint32_t version = 1, samples_per_axis = volume.samples_per_axis, brick = SparseVolume::brick;
+    double origin[3] = {volume.origin.x, volume.origin.y, volume.origin.z};
+    double spacing[3] = {volume.hx, volume.hy, volume.hz};
+    uint64_t bricks = volume.brick_keys.size();
+    file.write("SDFV", 4);
+    file.write((const char*)&version, sizeof(version));
+    file.write((const char*)&samples_per_axis, sizeof(samples_per_axis));
+    file.write((const char*)origin, sizeof(origin));
+    file.write((const char*)spacing, sizeof(spacing));
+    file.write((const char*)&volume.scale, sizeof(volume.scale));
+    file.write((const char*)&brick, sizeof(brick));
+    file.write((const char*)&bricks, sizeof(bricks));
+
+    for (size_t b = 0; b < bricks; b++) {
+        int i, j, k;
+        brick_coords(volume.brick_keys[b], i, j, k);
+        uint32_t coords[3] = {(uint32_t)i, (uint32_t)j, (uint32_t)k};
+        size_t end = (b + 1 < bricks) ? volume.offsets[b + 1] : volume.values.size();
+        file.write((const char*)coords, sizeof(coords));
+        file.write((const char*)&volume.masks[8 * b], 8 * sizeof(uint64_t));
+        file.write((const char*)&volume.values[volume.offsets[b]], (end - volume.offsets[b]) * sizeof(int16_t));
+    }
+    return file.good();
+}
+
+inline bool read_sparse_volume(const string& filename, SparseVolume& volume) {
+    ifstream file(filename, ios::binary);
+    if (!file.is_open()) return false;
+
+    char magic[4];
+    uint32_t version = 0, samples_per_axis = 0, brick = 0;
+    double origin[3], spacing[3];
+    uint64_t bricks = 0;
+    file.read(magic, 4);
+    file.read((char*)&version, sizeof(version));
+    if (!file || memcmp(magic, "SDFV", 4) != 0 || version != 1) return false;
+    file.read((char*)&samples_per_axis, sizeof(samples_per_axis));
+    file.read((char*)origin, sizeof(origin));
+    file.read((char*)spacing, sizeof(spacing));
+    file.read((char*)&volume.scale, sizeof(volume.scale));
+    file.read((char*)&brick, sizeof(brick));
+    file.read((char*)&bricks, sizeof(bricks));
+    if (!file || brick != (uint32_t)SparseVolume::brick) return false;
+
+    volume.origin = Point3D(origin[0], origin[1], origin[2]);
+    volume.hx = spacing[0]; volume.hy = spacing[1]; volume.hz = spacing[2];
+    volume.samples_per_axis = samples_per_axis;
+    volume.brick_keys.assign(bricks, 0);
+    volume.masks.assign(8 * bricks, 0);
+    volume.offsets.assign(bricks, 0);
+    volume.values.clear();
+    for (size_t b = 0; b < bricks; b++) {
+        uint32_t coords[3];
+        file.read((char*)coords, sizeof(coords));
+        file.read((char*)&volume.masks[8 * b], 8 * sizeof(uint64_t));
+        if (!file) return false;
+        size_t count = 0;
+        for (int w = 0; w < 8; w++) count += __builtin_popcountll(volume.masks[8 * b + w]);
+        volume.brick_keys[b] = brick_key(coords[0], coords[1], coords[2]);
+        volume.offsets[b] = volume.values.size();
+        volume.values.resize(volume.values.size() + count);
+        file.read((char*)&volume.values[volume.offsets[b]], count * sizeof(int16_t));
+    }
+    return bool(file);
+}
+
+#endif // SDF_VOLUME_H
@@ -0,0 +1,483 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "extractor.h"
+#include "expression_field.h"
+#include "mesh_io.h"
+#include "spill.h"
+#include <condition_variable>
+#include <limits>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Modo servidor: un proceso de larga vida que recibe trabajos de extracción
+// por un socket Unix local. Los hilos trabajadores viven todo el proceso, así
+// que su equipo de OpenMP y sus arenas de memoria quedan calientes entre
+// trabajos. La cola es por cliente y se atiende en ronda, de modo que un
+// cliente con muchos trabajos no deja esperando a los demás. El cliente es el
+// proceso del otro lado del socket (SO_PEERCRED): abrir más conexiones no le
+// da más turnos.
+//
+// Protocolo de texto: cada pedido son líneas "clave: valor" terminadas en una
+// línea vacía. Una conexión puede mandar varios pedidos sin esperar: se
+// encolan enseguida y las respuestas salen a medida que terminan, cada una
+// con su línea "id".
+//   id: texto                          (opcional; por defecto el número de pedido en la conexión, desde 1)
+//   field: x^2 + y^2 + z^2 - 1        (ver Expression)
+//   bounds: xmin ymin zmin xmax ymax zmax
+//   precision: 0.05
+//   engine: mc | mc33 | surfacenets | dc
+//   isovalue: 0
+//   snap: 0
+//   format: obj | ply | gltf | glb     (con output "-")
+//   output: - | /ruta/archivo.ext      ("-" devuelve la malla por el socket)
+//   memory: MB                         (no puede superar el límite del servidor)
+//   spill: yes                         (al pasarse de memory, la sopa sigue en disco; obj o ply)
+//   time: segundos                     (plazo; al vencer se devuelve la malla parcial)
+// o bien "command: status" / "command: shutdown" (cancela los trabajos en
+// curso y descarta los encolados).
+// La respuesta empieza con "id: ..." y también son líneas "clave: valor" y
+// una línea vacía; con output "-" siguen "bytes" bytes con el archivo.
+
+class ServerOptions {
+public:
+    string socket_path;
+    int workers = 2;                    // trabajos simultáneos
+    int threads = 0;                    // hilos OpenMP repartidos entre trabajadores (0 = todos)
+    size_t job_memory = size_t(1) << 30;  // límite por trabajo, en bytes
+};
+
+// Una conexión abierta. Su lector la mantiene viva hasta que no quedan
+// trabajos suyos encolados ni en curso; los trabajadores escriben en ella.
+class ServerConnection {
+public:
+    int fd = -1;
+    int64_t client = 0;      // identidad para la ronda (ver client_identity)
+    size_t outstanding = 0;  // trabajos encolados o en curso, con el candado del servidor
+    mutex send_lock;         // una respuesta entera por vez
+};
+
+class ServerJob {
+public:
+    int64_t client = 0;
+    ServerConnection* connection = nullptr;
+    string id;  // etiqueta de la respuesta
+    Expression expression;
+    ExtractionConfig config;
+    string format = "obj";
+    string output = "-";
+    size_t memory_limit = 0;
+    bool spill = false;  // pasado el límite, derramar a disco en lugar de fallar
+
+    TraversalControl control;  // el cierre del servidor cancela por acá los trabajos en curso
+    string response;  // cabecera y, con output "-", el archivo
+};
+
+// Sopa de un trabajo con límite de memoria: al pasarse cancela el recorrido.
+// El límite cuenta la sopa y lo que cuesta soldarla después (puntos, claves de
+// orden e índices por esquina).
+class LimitedCollector : public TriangleSink {
+public:
+    static const size_t bytes_per_triangle = weld_bytes_per_triangle;
+
+    TriangleSoup soup;
+    size_t limit;
+    TraversalControl& control;
+    atomic<bool> exceeded{false};
+    mutex lock;
+
+    LimitedCollector(size_t limit, TraversalControl& control) : limit(limit), control(control) {}
+
+    size_t estimated_bytes() const { return soup.triangles.size() * bytes_per_triangle + soup.attributes.size() * sizeof(float); }
+
+    void deliver(size_t, const TriangleSoup& batch) override {
+        lock_guard<mutex> guard(lock);
+        if (exceeded) return;
+        if (estimated_bytes() + batch.triangles.size() * bytes_per_triangle > limit) {
+            exceeded = true;
+            control.cancel();
+            return;
+        }
+        soup.attribute_count = batch.attribute_count;
+        soup.triangles.insert(soup.triangles.end(), batch.triangles.begin(), batch.triangles.end());
+        soup.attributes.insert(soup.attributes.end(), batch.attributes.begin(), batch.attributes.end());
+    }
+};
+
+class ExtractionServer {
+public:
+    ServerOptions options;
+
+    ExtractionServer(const ServerOptions& options) : options(options) {}
+
+    // Atiende hasta recibir "command: shutdown". Devuelve el código de salida.
+    int run() {
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (listen_fd < 0 || options.socket_path.size() >= sizeof(address.sun_path)) {
+            cerr << "Error creating socket: " << options.socket_path << endl;
+            return 1;
+        }
+        strncpy(address.sun_path, options.socket_path.c_str(), sizeof(address.sun_path) - 1);
+        unlink(options.socket_path.c_str());
+        if (bind(listen_fd, (sockaddr*)&address, sizeof(address)) < 0 || listen(listen_fd, 16) < 0) {
+            cerr << "Error listening on " << options.socket_path << endl;
+            close(listen_fd);
+            return 1;
+        }
+
+        int total_threads = options.threads > 0 ? options.threads : omp_get_max_threads();
+        int workers = max(1, options.workers);
+        int threads_per_job = max(1, total_threads / workers);
+        for (int w = 0; w < workers; w++) {
+            worker_threads.emplace_back([this, threads_per_job]() { worker(threads_per_job); });
+        }
+        cout << "Serving on " << options.socket_path << ": " << workers << " workers x " << threads_per_job << " threads, "
+             << options.job_memory / (1 << 20) << " MB per job" << endl;
+
+        int next_client = 1;
+        while (!stopping) {
+            {
+                lock_guard<mutex> guard(lock);
+                reap_connections();
+            }
+            pollfd p = {listen_fd, POLLIN, 0};
+            if (poll(&p, 1, 200) <= 0) continue;
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) continue;
+            lock_guard<mutex> guard(lock);
+            clients.insert(fd);
+            connection_threads[next_client] = thread([this, fd, next_client]() { serve_client(fd, next_client); });
+            next_client++;
+        }
+
+        {
+            lock_guard<mutex> guard(lock);
+            for (int fd : clients) shutdown(fd, SHUT_RDWR);
+        }
+        queue_changed.notify_all();
+        for (auto& entry : connection_threads) entry.second.join();
+        for (auto& t : worker_threads) t.join();
+        close(listen_fd);
+        unlink(options.socket_path.c_str());
+        cout << "Server stopped after " << completed << " jobs" << endl;
+        return 0;
+    }
+
+private:
+    int listen_fd = -1;
+    atomic<bool> stopping{false};
+    mutex lock;
+    condition_variable queue_changed, job_finished;
+    map<int64_t, deque<ServerJob*>> pending;  // por cliente; los trabajos son del servidor hasta responderlos
+    int64_t last_client = numeric_limits<int64_t>::min();
+    size_t running = 0, completed = 0;
+    set<int> clients;
+    set<ServerJob*> active;  // en manos de un trabajador
+    vector<thread> worker_threads;
+    map<int, thread> connection_threads;  // por cliente, hasta que termine y se junte
+    vector<int> closed_connections;
+
+    // Junta los hilos de las conexiones que ya cerraron (con el candado tomado)
+    void reap_connections() {
+        for (int client : closed_connections) {
+            auto it = connection_threads.find(client);
+            it->second.join();
+            connection_threads.erase(it);
+        }
+        closed_connections.clear();
+    }
+
+    // Siguiente trabajo en ronda: el primer cliente con pendientes después del último atendido
+    ServerJob* next_job() {
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            if (stopping) return nullptr;
+            auto it = pending.upper_bound(last_client);
+            if (it == pending.end()) it = pending.begin();
+            if (it != pending.end()) {
+                ServerJob* job = it->second.front();
+                it->second.pop_front();
+                last_client = it->first;
+                if (it->second.empty()) pending.erase(it);
+                active.insert(job);
+                running++;
+                return job;
+            }
+            queue_changed.wait(guard);
+        }
+    }
+
+    void worker(int threads) {
+        omp_set_num_threads(threads);
+        while (ServerJob* job = next_job()) {
+            run_job(*job);
+            if (stopping && job->control.cancelled) job->response = error_response("server shutting down");
+            finish_job(job);
+        }
+    }
+
+    // Manda la respuesta por la conexión del trabajo y lo libera
+    void finish_job(ServerJob* job) {
+        ServerConnection& connection = *job->connection;
+        {
+            lock_guard<mutex> guard(connection.send_lock);
+            send_all(connection.fd, "id: " + job->id + "\n" + job->response);
+        }
+        lock_guard<mutex> guard(lock);
+        if (active.erase(job)) {
+            running--;
+            completed++;
+        }
+        connection.outstanding--;
+        delete job;
+        job_finished.notify_all();
+    }
+
+    // Identidad del cliente para la ronda: el proceso del otro lado, así un
+    // cliente con varias conexiones tiene un solo turno. Sin credenciales,
+    // cada conexión es su propio cliente.
+    static int64_t client_identity(int fd, int connection_number) {
+        ucred credentials;
+        socklen_t length = sizeof(credentials);
+        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) == 0) return credentials.pid;
+        return -(int64_t)connection_number;
+    }
+
+    static string error_response(const string& message) { return "status: error\nmessage: " + message + "\n\n"; }
+
+    void run_job(ServerJob& job) {
+        double t0 = omp_get_wtime();
+        Extractor extractor(job.expression.field(), job.config);
+        extractor.config.control = &job.control;
+        ExtractionStats stats;
+        IndexedMesh mesh;
+        unique_ptr<SpillingSink> spill;
+        if (job.spill) {
+            spill.reset(new SpillingSink(1, job.memory_limit));
+            stats = extractor.extract(*spill);
+            if (!spill->ok()) {
+                job.response = error_response("cannot write the spill file");
+                return;
+            }
+            if (!spill->spilled()) mesh = weld_soup(spill->take_soup(0), vector<string>());
+        } else {
+            LimitedCollector sink(job.memory_limit, job.control);
+            stats = extractor.extract(sink);
+            if (sink.exceeded) {
+                job.response = error_response("memory limit exceeded (" + to_string(job.memory_limit / (1 << 20)) + " MB)");
+                return;
+            }
+            mesh = weld_soup(sink.soup, vector<string>());
+        }
+        bool spilled = spill && spill->spilled();
+
+        string path = job.output;
+        if (job.output == "-") {
+            string pattern = "/tmp/marching_cubes_job_XXXXXX." + job.format;
+            vector<char> name(pattern.begin(), pattern.end());
+            name.push_back(0);
+            int fd = mkstemps(name.data(), (int)job.format.size() + 1);
+            if (fd < 0) {
+                job.response = error_response("cannot create a temporary file");
+                return;
+            }
+            close(fd);
+            path = name.data();
+        }
+        if (!(spilled ? write_spilled(path, *spill, 0, vector<string>()) : write_mesh(path, mesh))) {
+            job.response = error_response("cannot write " + path);
+            return;
+        }
+
+        // La sopa derramada sale sin soldar: 3 vértices por triángulo
+        size_t triangles = spilled ? spill->triangle_count(0) : mesh.triangle_count();
+        ostringstream header;
+        header << "status: ok\ntriangles: " << triangles << "\nvertices: " << (spilled ? 3 * triangles : mesh.vertices.size())
+               << "\nseconds: " << omp_get_wtime() - t0 << "\n";
+        if (spilled) header << "spilled: " << spill->spilled_triangles(0) << "\n";
+        if (stats.expired) header << "partial: time limit reached\nprogress: " << stats.progress << "\n";
+        if (job.output == "-") {
+            ifstream file(path, ios::binary);
+            string bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+            unlink(path.c_str());
+            header << "bytes: " << bytes.size() << "\n\n";
+            job.response = header.str() + bytes;
+        } else {
+            header << "output: " << path << "\n\n";
+            job.response = header.str();
+        }
+    }
+
+    // Arma el trabajo a partir de las claves del pedido; false con el mensaje de error
+    bool parse_job(const map<string, string>& request, ServerJob& job, string& error) {
+        auto value = [&](const string& key, const string& fallback) {
+            auto it = request.find(key);
+            return it == request.end() ? fallback : it->second;
+        };
+        if (!job.expression.compile(value("field", ""), error)) {
+            error = "field: " + error;
+            return false;
+        }
+        istringstream bounds(value("bounds", "-1 -1 -1 1 1 1"));
+        double b[6];
+        for (double& v : b) {
+            if (!(bounds >> v)) {
+                error = "bounds needs 6 numbers";
+                return false;
+            }
+        }
+        if (b[0] >= b[3] || b[1] >= b[4] || b[2] >= b[5]) {
+            error = "empty bounds";
+            return false;
+        }
+        job.config.start = Point3D(b[0], b[1], b[2]);
+        job.config.end = Point3D(b[3], b[4], b[5]);
+        job.config.precision = atof(value("precision", "0.05").c_str());
+        job.config.isovalues = vector<double>(1, atof(value("isovalue", "0").c_str()));
+        job.config.snap = atof(value("snap", "0").c_str());
+        job.config.time_limit = atof(value("time", "0").c_str());
+        if (job.config.precision <= 0 || job.config.snap < 0 || job.config.snap >= 0.5 || job.config.time_limit < 0) {
+            error = "precision must be > 0, snap in [0, 0.5) and time >= 0";
+            return false;
+        }
+        if (!parse_engine(value("engine", "mc"), job.config.engine)) {
+            error = "unknown engine";
+            return false;
+        }
+        if (!job.config.check(error)) return false;
+        job.format = value("format", "obj");
+        job.output = value("output", "-");
+        if (job.output == "-" && mesh_format("mesh." + job.format) == MeshFormat::Obj && job.format != "obj") {
+            error = "unknown format (obj, ply, gltf, glb)";
+            return false;
+        }
+        job.spill = value("spill", "no") == "yes";
+        if (job.spill && !spill_format_supported(job.output == "-" ? "mesh." + job.format : job.output)) {
+            error = "spill needs obj or ply output";
+            return false;
+        }
+        job.memory_limit = options.job_memory;
+        if (request.count("memory")) job.memory_limit = min(job.memory_limit, (size_t)(atof(value("memory", "0").c_str()) * (1 << 20)));
+        return true;
+    }
+
+    static bool send_all(int fd, const string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    // Lector de una conexión: encola cada pedido sin esperar su respuesta
+    void serve_client(int fd, int connection_number) {
+        ServerConnection connection;
+        connection.fd = fd;
+        connection.client = client_identity(fd, connection_number);
+        string buffer;
+        map<string, string> request;
+        size_t requests = 0;
+        char chunk[4096];
+        bool open = true;
+        while (open && !stopping) {
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) break;
+            buffer.append(chunk, n);
+            size_t end;
+            while (open && (end = buffer.find('\n')) != string::npos) {
+                string line = buffer.substr(0, end);
+                buffer.erase(0, end + 1);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (!line.empty()) {
+                    size_t colon = line.find(':');
+                    if (colon == string::npos) continue;
+                    size_t start = line.find_first_not_of(' ', colon + 1);
+                    request[line.substr(0, colon)] = start == string::npos ? "" : line.substr(start);
+                    continue;
+                }
+                if (request.empty()) continue;
+                requests++;
+                string id = request.count("id") ? request["id"] : to_string(requests);
+                string response = handle_request(request, connection, id);
+                if (!response.empty()) {
+                    lock_guard<mutex> guard(connection.send_lock);
+                    open = send_all(fd, "id: " + id + "\n" + response);
+                }
+                request.clear();
+            }
+        }
+        // Los trabajos encolados escriben en connection: esperar a que respondan
+        unique_lock<mutex> guard(lock);
+        job_finished.wait(guard, [&]() { return connection.outstanding == 0; });
+        clients.erase(fd);
+        close(fd);
+        closed_connections.push_back(connection_number);
+    }
+
+    // Respuesta de un comando o de un pedido rechazado; vacía si el trabajo quedó encolado
+    string handle_request(const map<string, string>& request, ServerConnection& connection, const string& id) {
+        auto command = request.find("command");
+        if (command != request.end() && command->second == "shutdown") {
+            vector<ServerJob*> dropped;
+            {
+                lock_guard<mutex> guard(lock);
+                stopping = true;
+                for (ServerJob* job : active) job->control.cancel();
+                for (auto& entry : pending) dropped.insert(dropped.end(), entry.second.begin(), entry.second.end());
+                pending.clear();
+                queue_changed.notify_all();
+            }
+            // Los encolados no llegan a empezar
+            for (ServerJob* job : dropped) {
+                job->response = error_response("server shutting down");
+                finish_job(job);
+            }
+            return "status: ok\n\n";
+        }
+        if (command != request.end()) {
+            lock_guard<mutex> guard(lock);
+            if (command->second == "status") {
+                size_t queued = 0;
+                for (const auto& entry : pending) queued += entry.second.size();
+                // Memoria de todo el proceso por subsistema: memory_<categoría> y memory_<categoría>_peak, en bytes
+                string status = "status: ok\nqueued: " + to_string(queued) + "\nrunning: " + to_string(running) + "\ncompleted: " +
+                                to_string(completed) + "\n";
+                for (int c = 0; c <= MemoryAccounting::categories; c++) {
+                    MemoryUsage usage = memory_accounting().usage((MemoryCategory)c);
+                    string name = memory_category_name((MemoryCategory)c);
+                    status += "memory_" + name + ": " + to_string(usage.current) + "\nmemory_" + name + "_peak: " + to_string(usage.peak) + "\n";
+                }
+                return status + "\n";
+            }
+            return error_response("unknown command");
+        }
+
+        unique_ptr<ServerJob> job(new ServerJob());
+        job->client = connection.client;
+        job->connection = &connection;
+        job->id = id;
+        string error;
+        if (!parse_job(request, *job, error)) return error_response(error);
+
+        lock_guard<mutex> guard(lock);
+        if (stopping) return error_response("server shutting down");
+        pending[connection.client].push_back(job.release());
+        connection.outstanding++;
+        queue_changed.notify_one();
+        return "";
+    }
+};
+
+#endif // SERVER_H
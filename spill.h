@@ -0,0 +1,228 @@
+#ifndef SPILL_H
+#define SPILL_H
+
+#include "mesh_io.h"
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <unistd.h>
+
+// Extracción con presupuesto de memoria. Los lotes que entrega el recorrido
+// se guardan en memoria mientras quepan en el presupuesto, contando lo que
+// costará soldarlos (weld_bytes_per_triangle); desde el primer lote que no
+// entra, éste y los siguientes van a un archivo temporal por isovalor. Al
+// final, si nada fue a disco la sopa se suelda como siempre; si no, los
+// escritores recorren los trozos en memoria y después los del disco y
+// escriben la sopa sin soldar (3 vértices por triángulo) en OBJ o PLY, sin
+// volver a juntarla entera.
+
+class SpillingSink : public TriangleSink {
+public:
+    size_t budget;     // bytes para los triángulos en memoria, con su soldadura
+    string directory;  // de los temporales; vacío = $TMPDIR o /tmp
+
+    SpillingSink(size_t isovalues, size_t budget, const string& directory = "")
+        : budget(budget), directory(directory), parts(isovalues) {}
+
+    ~SpillingSink() {
+        for (auto& part : parts) {
+            if (part.file) fclose(part.file);
+        }
+    }
+
+    void deliver(size_t k, const TriangleSoup& batch) override {
+        if (batch.triangles.empty()) return;
+        size_t bytes = batch.triangles.size() * weld_bytes_per_triangle + batch.attributes.size() * sizeof(float);
+        lock_guard<mutex> guard(lock);
+        Part& part = parts[k];
+        part.triangles += batch.triangles.size();
+        if (!spilling && resident + bytes <= budget) {
+            part.chunks.push_back(batch);
+            resident += bytes;
+            return;
+        }
+        spilling = true;
+        if (!write_chunk(part, batch)) failed = true;
+        part.spilled += batch.triangles.size();
+        spilled_bytes += batch.triangles.size() * sizeof(Triangle) + batch.attributes.size() * sizeof(float);
+    }
+
+    bool ok() const { return !failed; }
+    bool spilled() const { return spilling; }
+    size_t triangle_count(size_t k) const { return parts[k].triangles; }
+    size_t spilled_triangles(size_t k) const { return parts[k].spilled; }
+    size_t spilled_triangles() const {
+        size_t total = 0;
+        for (const auto& part : parts) total += part.spilled;
+        return total;
+    }
+    size_t disk_bytes() const { return spilled_bytes; }
+
+    // Los trozos en memoria del isovalor k en una sola sopa (sin derrame).
+    // Cada trozo se libera al copiarlo, así el pico es la sopa más un trozo.
+    TriangleSoup take_soup(size_t k) {
+        Part& part = parts[k];
+        TriangleSoup soup;
+        size_t triangles = 0, attributes = 0;
+        for (const auto& chunk : part.chunks) {
+            triangles += chunk.triangles.size();
+            attributes += chunk.attributes.size();
+        }
+        soup.triangles.reserve(triangles);
+        soup.attributes.reserve(attributes);
+        for (auto& chunk : part.chunks) {
+            soup.attribute_count = chunk.attribute_count;
+            soup.triangles.insert(soup.triangles.end(), chunk.triangles.begin(), chunk.triangles.end());
+            soup.attributes.insert(soup.attributes.end(), chunk.attributes.begin(), chunk.attributes.end());
+            chunk = TriangleSoup();
+        }
+        part.chunks.clear();
+        return soup;
+    }
+
+    // Recorre en orden los trozos del isovalor k: primero los de memoria y
+    // después los del disco, leídos de a uno en un lote que se reutiliza.
+    bool for_each_chunk(size_t k, const function<void(const TriangleSoup&)>& visit) {
+        Part& part = parts[k];
+        for (const auto& chunk : part.chunks) visit(chunk);
+        if (!part.file) return true;
+        if (fflush(part.file) != 0 || fseeko(part.file, 0, SEEK_SET) != 0) return false;
+        TriangleSoup chunk;
+        WriterBuffer<Point3D> points;  // Triangle no tiene constructor por defecto: se lee por vértices
+        uint64_t header[2];
+        while (fread(header, sizeof(header), 1, part.file) == 1) {
+            chunk.attribute_count = header[1];
+            points.resize(3 * header[0]);
+            chunk.attributes.resize(header[0] * 3 * header[1]);
+            if (fread(points.data(), sizeof(Point3D), points.size(), part.file) != points.size() ||
+                fread(chunk.attributes.data(), sizeof(float), chunk.attributes.size(), part.file) != chunk.attributes.size()) {
+                return false;
+            }
+            chunk.triangles.clear();
+            for (size_t t = 0; t < header[0]; t++) chunk.triangles.push_back(Triangle(points[3 * t], points[3 * t + 1], points[3 * t + 2]));
+            visit(chunk);
+        }
+        bool complete = feof(part.file) != 0;
+        fseeko(part.file, 0, SEEK_END);
+        return complete;
+    }
+
+private:
+    class Part {
+    public:
+        vector<TriangleSoup> chunks;  // en memoria, en orden de llegada
+        FILE* file = nullptr;         // derrame: cabecera {triángulos, atributos}, vértices y atributos por lote
+        size_t triangles = 0;
+        size_t spilled = 0;
+    };
+
+    vector<Part> parts;
+    mutex lock;
+    size_t resident = 0;
+    size_t spilled_bytes = 0;
+    bool spilling = false;
+    bool failed = false;
+
+    bool open_file(Part& part) {
+        const char* tmpdir = getenv("TMPDIR");
+        string dir = !directory.empty() ? directory : (tmpdir && *tmpdir ? tmpdir : "/tmp");
+        string pattern = dir + "/marching_cubes_spill_XXXXXX";
+        vector<char> name(pattern.begin(), pattern.end());
+        name.push_back(0);
+        int fd = mkstemp(name.data());
+        if (fd < 0) {
+            cerr << "Cannot create a spill file in " << dir << endl;
+            return false;
+        }
+        unlink(name.data());  // se borra solo al cerrarse
+        part.file = fdopen(fd, "w+b");
+        if (!part.file) close(fd);
+        return part.file != nullptr;
+    }
+
+    bool write_chunk(Part& part, const TriangleSoup& batch) {
+        if (!part.file && !open_file(part)) return false;
+        uint64_t header[2] = {batch.triangles.size(), batch.attribute_count};
+        return fwrite(header, sizeof(header), 1, part.file) == 1 &&
+               fwrite(batch.triangles.data(), sizeof(Triangle), batch.triangles.size(), part.file) == batch.triangles.size() &&
+               fwrite(batch.attributes.data(), sizeof(float), batch.attributes.size(), part.file) == batch.attributes.size();
+    }
+};
+
+// La sopa derramada sólo se escribe en formatos que se pueden armar de a trozos
+inline bool spill_format_supported(const string& filename) {
+    MeshFormat format = mesh_format(filename);
+    return format == MeshFormat::Obj || format == MeshFormat::Ply;
+}
+
+// OBJ sin soldar, como ObjStreamSink: los 3 vértices y la cara de cada triángulo
+inline bool write_spilled_obj(const string& filename, SpillingSink& sink, size_t k) {
+    ofstream file(filename);
+    if (!file.is_open()) return false;
+    file << "# Marching Cubes Output\n\n";
+    size_t vertex_count = 0;
+    bool read = sink.for_each_chunk(k, [&](const TriangleSoup& chunk) {
+        WriterText text;
+        for (const auto& triangle : chunk.triangles) {
+            text << "v " << triangle.p1.x << " " << triangle.p1.y << " " << triangle.p1.z << "\n";
+            text << "v " << triangle.p2.x << " " << triangle.p2.y << " " << triangle.p2.z << "\n";
+            text << "v " << triangle.p3.x << " " << triangle.p3.y << " " << triangle.p3.z << "\n";
+        }
+        for (size_t t = 0; t < chunk.triangles.size(); t++) {
+            size_t base = vertex_count + 3 * t + 1;
+            text << "f " << base << " " << (base + 1) << " " << (base + 2) << "\n";
+        }
+        vertex_count += 3 * chunk.triangles.size();
+        file << text.str();
+    });
+    return read && (bool)file;
+}
+
+// PLY binario sin soldar, con los atributos por esquina. Los vértices salen
+// trozo a trozo; las caras son (3t, 3t + 1, 3t + 2) y no hace falta leerlas.
+inline bool write_spilled_ply(const string& filename, SpillingSink& sink, size_t k, const vector<string>& attribute_names) {
+    ofstream file(filename, ios::binary);
+    if (!file.is_open()) return false;
+    size_t triangles = sink.triangle_count(k), count = attribute_names.size(), stride = 3 + count;
+    write_ply_header(file, 3 * triangles, triangles, false, attribute_names);
+
+    bool read = sink.for_each_chunk(k, [&](const TriangleSoup& chunk) {
+        WriterBuffer<float> record(3 * chunk.triangles.size() * stride, 0.0f);
+        bool has_attributes = chunk.attribute_count == count && chunk.attributes.size() == 3 * chunk.triangles.size() * count;
+        for (size_t v = 0; v < 3 * chunk.triangles.size(); v++) {
+            const Triangle& triangle = chunk.triangles[v / 3];
+            const Point3D& p = (v % 3 == 0) ? triangle.p1 : (v % 3 == 1) ? triangle.p2 : triangle.p3;
+            float* r = &record[v * stride];
+            r[0] = (float)p.x; r[1] = (float)p.y; r[2] = (float)p.z;
+            if (has_attributes) {
+                for (size_t a = 0; a < count; a++) r[3 + a] = chunk.attributes[v * count + a];
+            }
+        }
+        file.write((const char*)record.data(), record.size() * sizeof(float));
+    });
+
+    const size_t face_bytes = 1 + 3 * sizeof(int32_t), block = 4096;
+    WriterBuffer<char> faces(block * face_bytes);
+    for (size_t first = 0; first < triangles; first += block) {
+        size_t n = min(block, triangles - first);
+        for (size_t t = 0; t < n; t++) {
+            char* f = &faces[t * face_bytes];
+            f[0] = 3;
+            int32_t index[3] = {int32_t(3 * (first + t)), int32_t(3 * (first + t) + 1), int32_t(3 * (first + t) + 2)};
+            memcpy(f + 1, index, sizeof(index));
+        }
+        file.write(faces.data(), n * face_bytes);
+    }
+    return read && (bool)file;
+}
+
+inline bool write_spilled(const string& filename, SpillingSink& sink, size_t k, const vector<string>& attribute_names) {
+    switch (mesh_format(filename)) {
+        case MeshFormat::Ply: return write_spilled_ply(filename, sink, k, attribute_names);
+        case MeshFormat::Obj: return write_spilled_obj(filename, sink, k);
+        default: return false;
+    }
+}
+
+#endif // SPILL_H
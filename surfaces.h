@@ -0,0 +1,184 @@
+#ifndef SURFACES_H
+#define SURFACES_H
+
+#include "marching_cubes.h"
+
+// Superficies analíticas incluidas, con el dominio en que se extraen por
+// defecto. Las usan la línea de comandos (--surface), el arnés de
+// escalabilidad y el corpus de referencia (corpus.h). Cubren perfiles
+// distintos: superficies chicas en un dominio casi vacío (esfera, toro), una
+// que llena el dominio (giroide), polinomios (Barth), campos caros de evaluar
+// (Mandelbulb, ruido) y una escena CSG con muchas primitivas por evaluación.
+// Todas son simétricas en cada eje, periódicas con su dominio o no tocan el
+// borde, así que se pueden repetir en copias contiguas (modo débil).
+
+class BuiltinSurface {
+public:
+    string name;
+    ScalarField field;
+    Point3D start, end;
+};
+
+// Esfera de version1.cpp (radio 25 en [-30, 30]) llevada a radio 2.5 en [-3, 3]
+inline double sphere_surface(double x, double y, double z) {
+    double radius = 2.5;
+    return x * x + y * y + z * z - radius * radius;
+}
+
+inline double barth_sextic_surface(double x, double y, double z) {
+    double phi = (1 + sqrt(5)) / 2;  // Golden ratio
+    double x2 = x * x, y2 = y * y, z2 = z * z;
+    return 4 * (phi * phi * x2 - y2) * (phi * phi * y2 - z2) * (phi * phi * z2 - x2) -
+           (1 + 2 * phi) * (x2 + y2 + z2 - 1) * (x2 + y2 + z2 - 1);
+}
+
+// Toro alrededor del eje z: radio mayor 2, radio del tubo 0.8
+inline double torus_surface(double x, double y, double z) {
+    double ring = sqrt(x * x + y * y) - 2.0;
+    return ring * ring + z * z - 0.8 * 0.8;
+}
+
+// Superficie mínima triplemente periódica, con un período por eje en su
+// dominio. El dominio está corrido 0.1 para que las esquinas de las celdas no
+// caigan en los ceros exactos de sin y cos (triángulos degenerados).
+inline double gyroid_surface(double x, double y, double z) {
+    return sin(x) * cos(y) + sin(y) * cos(z) + sin(z) * cos(x);
+}
+
+// Se ve bien pero necesita mucha resolución
+inline double mandelbulb_surface(double x, double y, double z) {
+    double power = 8.0;
+    double cx = x, cy = y, cz = z;
+    double zx = x, zy = y, zz = z;
+
+    for (int i = 0; i < 10; i++) {
+        double r = sqrt(zx * zx + zy * zy + zz * zz);
+        if (r > 2.0) return r - 2.0;
+
+        double theta = atan2(sqrt(zx * zx + zy * zy), zz);
+        double phi = atan2(zy, zx);
+
+        double rp = pow(r, power);
+        theta *= power;
+        phi *= power;
+
+        zx = rp * sin(theta) * cos(phi) + cx;
+        zy = rp * sin(theta) * sin(phi) + cy;
+        zz = rp * cos(theta) + cz;
+    }
+
+    return sqrt(zx * zx + zy * zy + zz * zz) - 2.0;
+}
+
+// Entero de 32 bits mezclado, para el ruido y la escena CSG
+inline uint32_t surface_hash(uint32_t a, uint32_t b, uint32_t c = 0) {
+    uint32_t h = a * 0x8da6b343u ^ b * 0xd8163841u ^ c * 0xcb1ab31fu;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    return h ^ (h >> 16);
+}
+
+// Ruido de valor en [-1, 1] sobre una grilla de period × period celdas que se
+// repite, interpolado con smoothstep
+inline double value_noise(double u, double v, int period, int octave) {
+    double fu = floor(u), fv = floor(v);
+    int i = (int)fu, j = (int)fv;
+    double tu = u - fu, tv = v - fv;
+    tu = tu * tu * (3 - 2 * tu);
+    tv = tv * tv * (3 - 2 * tv);
+    auto lattice = [&](int a, int b) {
+        a = ((a % period) + period) % period;
+        b = ((b % period) + period) % period;
+        return surface_hash((uint32_t)a, (uint32_t)b, (uint32_t)octave) * (2.0 / 4294967295.0) - 1.0;
+    };
+    double bottom = lattice(i, j) + (lattice(i + 1, j) - lattice(i, j)) * tu;
+    double top = lattice(i, j + 1) + (lattice(i + 1, j + 1) - lattice(i, j + 1)) * tu;
+    return bottom + (top - bottom) * tv;
+}
+
+// Terreno de ruido fractal (5 octavas) sobre una losa con base en z = -3. El
+// ruido se repite con el dominio [-4, 4] en x e y, y la losa no toca z = ±4.
+inline double terrain_surface(double x, double y, double z) {
+    double u = (x + 4) / 8 * 4, v = (y + 4) / 8 * 4;  // 4 celdas de ruido por lado en la primera octava
+    double height = 0, amplitude = 1.2;
+    int period = 4;
+    for (int octave = 0; octave < 5; octave++) {
+        height += amplitude * value_noise(u, v, period, octave);
+        u *= 2;
+        v *= 2;
+        period *= 2;
+        amplitude *= 0.5;
+    }
+    return max(z - height, -3 - z);
+}
+
+class CsgPrimitive {
+public:
+    Point3D center;
+    double size;  // radio de la esfera o media arista de la caja
+    bool box;
+};
+
+// 64 esferas y cajas en una grilla 4×4×4 con desplazamientos fijos
+inline const vector<CsgPrimitive>& csg_primitives() {
+    static const vector<CsgPrimitive> primitives = [] {
+        vector<CsgPrimitive> list;
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < 4; j++) {
+                for (int k = 0; k < 4; k++) {
+                    uint32_t h = surface_hash(i, j, k);
+                    auto jitter = [&](int shift) { return ((h >> shift) & 0xff) / 255.0 * 0.5 - 0.25; };
+                    CsgPrimitive p;
+                    p.center = Point3D(-2.25 + 1.5 * i + jitter(0), -2.25 + 1.5 * j + jitter(8), -2.25 + 1.5 * k + jitter(16));
+                    p.box = (i + j + k) % 2 == 1;
+                    p.size = (p.box ? 0.4 : 0.5) + (h >> 24) / 255.0 * 0.2;
+                    list.push_back(p);
+                }
+            }
+        }
+        return list;
+    }();
+    return primitives;
+}
+
+// Unión de las 64 primitivas menos tres cilindros por los ejes (radio 0.5)
+inline double csg_surface(double x, double y, double z) {
+    double shape = INFINITY;
+    for (const auto& p : csg_primitives()) {
+        double dx = x - p.center.x, dy = y - p.center.y, dz = z - p.center.z;
+        double d = p.box ? max(fabs(dx), max(fabs(dy), fabs(dz))) - p.size : sqrt(dx * dx + dy * dy + dz * dz) - p.size;
+        shape = min(shape, d);
+    }
+    double cylinders = min(sqrt(y * y + z * z), min(sqrt(x * x + z * z), sqrt(x * x + y * y))) - 0.5;
+    return max(shape, -cylinders);
+}
+
+inline const vector<BuiltinSurface>& builtin_surfaces() {
+    static const vector<BuiltinSurface> surfaces = {
+        {"barth", barth_sextic_surface, Point3D(-6, -6, -6), Point3D(6, 6, 6)},
+        {"sphere", sphere_surface, Point3D(-3, -3, -3), Point3D(3, 3, 3)},
+        {"torus", torus_surface, Point3D(-3, -3, -3), Point3D(3, 3, 3)},
+        {"gyroid", gyroid_surface, Point3D(0.1 - M_PI, 0.1 - M_PI, 0.1 - M_PI), Point3D(0.1 + M_PI, 0.1 + M_PI, 0.1 + M_PI)},
+        {"mandelbulb", mandelbulb_surface, Point3D(-1.5, -1.5, -1.5), Point3D(1.5, 1.5, 1.5)},
+        {"terrain", terrain_surface, Point3D(-4, -4, -4), Point3D(4, 4, 4)},
+        {"csg", csg_surface, Point3D(-3.5, -3.5, -3.5), Point3D(3.5, 3.5, 3.5)},
+    };
+    return surfaces;
+}
+
+inline const BuiltinSurface* find_surface(const string& name) {
+    for (const auto& surface : builtin_surfaces()) {
+        if (surface.name == name) return &surface;
+    }
+    return nullptr;
+}
+
+inline string surface_names() {
+    string names;
+    for (const auto& surface : builtin_surfaces()) names += (names.empty() ? "" : ", ") + surface.name;
+    return names;
+}
+
+#endif // SURFACES_H
@@ -0,0 +1,58 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "marching_cubes.h"
+#include <cstdio>
+
+// Exporta lo registrado por TaskTracer en formato Chrome trace (JSON), que
+// se abre en Perfetto (ui.perfetto.dev) o en chrome://tracing. Cada tarea
+// es un evento completo ("ph": "X") en la fila de su hilo, con la
+// profundidad, los extremos del nodo y los triángulos producidos. Las tareas
+// que un hilo ejecuta dentro del taskwait de otra quedan anidadas debajo.
+
+inline const char* trace_kind_name(TraceKind kind) {
+    switch (kind) {
+        case TraceKind::Leaf: return "leaf";
+        case TraceKind::Culled: return "culled";
+        case TraceKind::Span: return "span";
+        default: return "node";
+    }
+}
+
+inline bool write_chrome_trace(const string& filename, const TaskTracer& tracer) {
+    ofstream file(filename);
+    if (!file.is_open()) return false;
+
+    uint64_t dropped = 0;
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"marching cubes\"}}";
+    char line[512];
+    for (int t = 0; t < TaskTracer::max_threads; t++) {
+        const TaskTracer::Ring* ring = tracer.rings[t].get();
+        if (!ring) continue;
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t << ",\"args\":{\"name\":\"thread " << t << "\"}}";
+
+        // Del más viejo al más nuevo que quedan en el anillo
+        uint64_t kept = min<uint64_t>(ring->written, tracer.capacity);
+        dropped += ring->written - kept;
+        for (uint64_t n = ring->written - kept; n < ring->written; n++) {
+            const TraceEvent& e = ring->events[n % tracer.capacity];
+            double ts = (e.begin - tracer.origin) * 1e6, dur = (e.end - e.begin) * 1e6;
+            if (e.kind == TraceKind::Span) {
+                snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         e.name, t, ts, dur);
+            } else {
+                snprintf(line, sizeof(line),
+                         ",\n{\"name\":\"%s\",\"cat\":\"octree\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+                         "\"args\":{\"depth\":%d,\"triangles\":%u,\"start\":[%g,%g,%g],\"end\":[%g,%g,%g]}}",
+                         trace_kind_name(e.kind), t, ts, dur, e.depth, e.triangles, e.start.x, e.start.y, e.start.z, e.stop.x,
+                         e.stop.y, e.stop.z);
+            }
+            file << line;
+        }
+    }
+    file << "\n],\"otherData\":{\"events_per_thread\":" << tracer.capacity << ",\"dropped_events\":" << dropped << "}}\n";
+    return (bool)file;
+}
+
+#endif // TRACE_H
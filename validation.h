@@ -0,0 +1,217 @@
+#ifndef VALIDATION_H
+#define VALIDATION_H
+
+#include "mesh.h"
+#include "components.h"
+#include <array>
+#include <sstream>
+
+// Validación y métricas de calidad de una malla indexada. Todo es O(caras):
+// la adyacencia se arma en CSR por vértice y cada vértice revisa sólo las
+// aristas y caras donde es el índice menor, sin escrituras compartidas.
+
+class ValidationReport {
+public:
+    size_t triangles = 0;
+    size_t vertices = 0;
+    size_t invalid_indices = 0;       // índices fuera de rango
+    size_t degenerate_triangles = 0;  // índices repetidos o área ~0
+    size_t duplicate_triangles = 0;   // mismos tres vértices que otra cara
+    size_t edges = 0;
+    size_t boundary_edges = 0;
+    size_t non_manifold_edges = 0;    // más de dos caras
+    size_t boundary_loops = 0;
+    size_t inconsistent_edges = 0;    // dos caras recorren la arista en el mismo sentido
+    size_t distance_samples = 0;
+    double max_distance = 0;          // |f - isovalor| / |grad f| en puntos muestreados sobre la malla
+    double mean_distance = 0;
+
+    bool manifold() const { return non_manifold_edges == 0 && degenerate_triangles == 0 && duplicate_triangles == 0; }
+    bool oriented() const { return inconsistent_edges == 0; }
+    bool closed() const { return boundary_edges == 0; }
+    bool ok() const { return invalid_indices == 0 && manifold() && oriented(); }
+};
+
+inline ValidationReport validate_mesh(const IndexedMesh& mesh, const ScalarField& f = ScalarField(),
+                                      size_t distance_samples = 10000, double gradient_step = 1e-6, double isovalue = 0) {
+    ValidationReport report;
+    int nv = (int)mesh.vertices.size();
+    size_t nf = mesh.triangle_count();
+    report.triangles = nf;
+    report.vertices = nv;
+
+    // Caras inválidas quedan fuera del resto del análisis
+    vector<char> valid(nf, 1);
+    size_t invalid = 0, degenerate = 0;
+    #pragma omp parallel for schedule(static) reduction(+:invalid, degenerate)
+    for (long t = 0; t < (long)nf; t++) {
+        int a = mesh.indices[3 * t], b = mesh.indices[3 * t + 1], c = mesh.indices[3 * t + 2];
+        if (a < 0 || b < 0 || c < 0 || a >= nv || b >= nv || c >= nv) {
+            invalid++;
+            valid[t] = 0;
+            continue;
+        }
+        if (a == b || b == c || a == c) {
+            degenerate++;
+            valid[t] = 0;
+            continue;
+        }
+        const Point3D& pa = mesh.vertices[a];
+        const Point3D& pb = mesh.vertices[b];
+        const Point3D& pc = mesh.vertices[c];
+        Point3D n = face_normal(pa, pb, pc);
+        double area2 = n.x * n.x + n.y * n.y + n.z * n.z;
+        double longest = max(squared_distance(pa, pb), max(squared_distance(pb, pc), squared_distance(pc, pa)));
+        if (area2 <= 1e-24 * longest * longest) degenerate++;
+    }
+    report.invalid_indices = invalid;
+    report.degenerate_triangles = degenerate;
+
+    // CSR vértice -> caras
+    vector<int> offsets(nv + 1, 0), incident;
+    for (size_t t = 0; t < nf; t++) {
+        if (!valid[t]) continue;
+        for (int k = 0; k < 3; k++) offsets[mesh.indices[3 * t + k] + 1]++;
+    }
+    for (int v = 0; v < nv; v++) offsets[v + 1] += offsets[v];
+    incident.resize(offsets[nv]);
+    {
+        vector<int> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < nf; t++) {
+            if (!valid[t]) continue;
+            for (int k = 0; k < 3; k++) incident[cursor[mesh.indices[3 * t + k]]++] = (int)t;
+        }
+    }
+
+    vector<atomic<int>> boundary_parent(nv);
+    #pragma omp parallel for schedule(static)
+    for (long v = 0; v < (long)nv; v++) boundary_parent[v].store((int)v, memory_order_relaxed);
+    vector<char> on_boundary(nv, 0);
+
+    size_t edges = 0, boundary = 0, non_manifold = 0, inconsistent = 0, duplicates = 0;
+    #pragma omp parallel for schedule(dynamic, 512) reduction(+:edges, boundary, non_manifold, inconsistent, duplicates)
+    for (long u = 0; u < (long)nv; u++) {
+        // (vecino, +1 si la cara va u->w, -1 si w->u) para aristas con w > u
+        vector<pair<int, int>> half_edges;
+        vector<array<int, 3>> owned_faces;
+        for (int i = offsets[u]; i < offsets[u + 1]; i++) {
+            const int* tri = &mesh.indices[3 * incident[i]];
+            for (int k = 0; k < 3; k++) {
+                if (tri[k] != u) continue;
+                int next = tri[(k + 1) % 3], prev = tri[(k + 2) % 3];
+                if (next > u) half_edges.push_back({next, +1});
+                if (prev > u) half_edges.push_back({prev, -1});
+            }
+            array<int, 3> sorted_tri = {tri[0], tri[1], tri[2]};
+            sort(sorted_tri.begin(), sorted_tri.end());
+            if (sorted_tri[0] == u) owned_faces.push_back(sorted_tri);
+        }
+
+        sort(owned_faces.begin(), owned_faces.end());
+        for (size_t i = 1; i < owned_faces.size(); i++) {
+            if (owned_faces[i] == owned_faces[i - 1]) duplicates++;
+        }
+
+        sort(half_edges.begin(), half_edges.end());
+        for (size_t i = 0; i < half_edges.size();) {
+            size_t j = i;
+            int direction = 0;
+            while (j < half_edges.size() && half_edges[j].first == half_edges[i].first) direction += half_edges[j++].second;
+            size_t count = j - i;
+            edges++;
+            if (count == 1) {
+                boundary++;
+                on_boundary[u] = 1;
+                union_find_link(boundary_parent, u, half_edges[i].first);
+            } else if (count > 2) {
+                non_manifold++;
+            } else if (direction != 0) {
+                inconsistent++;
+            }
+            i = j;
+        }
+    }
+    report.edges = edges;
+    report.boundary_edges = boundary;
+    report.non_manifold_edges = non_manifold;
+    report.inconsistent_edges = inconsistent;
+    report.duplicate_triangles = duplicates;
+
+    // Lazos de borde: componentes del grafo de aristas de borde. La raíz es el
+    // vértice mínimo del lazo, que siempre es el extremo menor de una arista.
+    size_t loops = 0;
+    #pragma omp parallel for schedule(static) reduction(+:loops)
+    for (long v = 0; v < (long)nv; v++) {
+        if (on_boundary[v] && union_find_root(boundary_parent, (int)v) == (int)v) loops++;
+    }
+    report.boundary_loops = loops;
+
+    // Distancia a la isosuperficie: |f - isovalor| / |grad f| en puntos aleatorios sobre caras válidas
+    if (f && nf > 0 && distance_samples > 0) {
+        double max_d = 0, sum_d = 0;
+        size_t taken = 0;
+        #pragma omp parallel reduction(max:max_d) reduction(+:sum_d, taken)
+        {
+            mt19937 rng(12345u + 7919u * omp_get_thread_num());
+            uniform_int_distribution<size_t> pick(0, nf - 1);
+            uniform_real_distribution<double> unit(0.0, 1.0);
+            #pragma omp for schedule(static)
+            for (long s = 0; s < (long)distance_samples; s++) {
+                size_t t = pick(rng);
+                if (!valid[t]) continue;
+                double r1 = unit(rng), r2 = unit(rng);
+                if (r1 + r2 > 1) { r1 = 1 - r1; r2 = 1 - r2; }
+                const Point3D& a = mesh.vertices[mesh.indices[3 * t]];
+                const Point3D& b = mesh.vertices[mesh.indices[3 * t + 1]];
+                const Point3D& c = mesh.vertices[mesh.indices[3 * t + 2]];
+                Point3D p(a.x + r1 * (b.x - a.x) + r2 * (c.x - a.x),
+                          a.y + r1 * (b.y - a.y) + r2 * (c.y - a.y),
+                          a.z + r1 * (b.z - a.z) + r2 * (c.z - a.z));
+                double h = gradient_step;
+                double gx = (f(p.x + h, p.y, p.z) - f(p.x - h, p.y, p.z)) / (2 * h);
+                double gy = (f(p.x, p.y + h, p.z) - f(p.x, p.y - h, p.z)) / (2 * h);
+                double gz = (f(p.x, p.y, p.z + h) - f(p.x, p.y, p.z - h)) / (2 * h);
+                double g = sqrt(gx * gx + gy * gy + gz * gz);
+                if (g < 1e-12) continue;
+                double d = abs(f(p.x, p.y, p.z) - isovalue) / g;
+                max_d = max(max_d, d);
+                sum_d += d;
+                taken++;
+            }
+        }
+        report.distance_samples = taken;
+        report.max_distance = max_d;
+        report.mean_distance = taken ? sum_d / taken : 0;
+    }
+
+    return report;
+}
+
+// Lee un OBJ (v y f; en f sólo se usa el índice de posición). Los índices se
+// guardan tal cual, aunque estén fuera de rango, para que el validador los cuente.
+inline bool load_obj(const string& filename, IndexedMesh& mesh) {
+    ifstream file(filename);
+    if (!file.is_open()) return false;
+    mesh = IndexedMesh();
+    string line;
+    while (getline(file, line)) {
+        if (line.size() < 2) continue;
+        if (line[0] == 'v' && line[1] == ' ') {
+            istringstream in(line.substr(2));
+            Point3D p;
+            in >> p.x >> p.y >> p.z;
+            mesh.vertices.push_back(p);
+        } else if (line[0] == 'f' && line[1] == ' ') {
+            istringstream in(line.substr(2));
+            string token;
+            vector<int> polygon;
+            while (in >> token) polygon.push_back(atoi(token.c_str()) - 1);
+            for (size_t i = 1; i + 1 < polygon.size(); i++) {
+                mesh.indices.insert(mesh.indices.end(), {polygon[0], polygon[i], polygon[i + 1]});
+            }
+        }
+    }
+    return true;
+}
+
+#endif // VALIDATION_H
@@ -0,0 +1,351 @@
+#ifndef VOLUME_FIELD_H
+#define VOLUME_FIELD_H
+
+#include "marching_cubes.h"
+#include <cstdint>
+#include <cstring>
+
+// Campo a partir de datos muestreados (salida de simulaciones, tomografías):
+// una grilla de nx * ny * nz vóxeles de 8/16 bits sin signo o float, con
+// reconstrucción trilineal o tricúbica (Catmull-Rom) entre muestras.
+// El descarte del octree se responde con una pirámide de mínimos/máximos
+// (MinMaxPyramid) en O(1) por nodo, sin las 10000 muestras aleatorias de
+// cube_contains_surface.
+
+enum class VoxelType { UInt8, UInt16, Float32 };
+enum class Reconstruction { Trilinear, Tricubic };
+
+inline size_t voxel_bytes(VoxelType type) {
+    switch (type) {
+        case VoxelType::UInt8: return 1;
+        case VoxelType::UInt16: return 2;
+        default: return 4;
+    }
+}
+
+class Volume {
+public:
+    int nx = 0, ny = 0, nz = 0;
+    VoxelType type = VoxelType::Float32;
+    vector<unsigned char> data;     // x más rápido, luego y, luego z
+    Point3D origin;                 // posición del vóxel (0, 0, 0)
+    Point3D spacing = Point3D(1, 1, 1);
+
+    Volume() {}
+    Volume(int nx, int ny, int nz, VoxelType type)
+        : nx(nx), ny(ny), nz(nz), type(type), data((size_t)nx * ny * nz * voxel_bytes(type)) {}
+
+    Point3D end() const {
+        return Point3D(origin.x + (nx - 1) * spacing.x, origin.y + (ny - 1) * spacing.y, origin.z + (nz - 1) * spacing.z);
+    }
+
+    size_t index(int i, int j, int k) const { return ((size_t)k * ny + j) * nx + i; }
+
+    // Índices fuera de la grilla se pegan al borde
+    float voxel(int i, int j, int k) const {
+        i = max(0, min(nx - 1, i));
+        j = max(0, min(ny - 1, j));
+        k = max(0, min(nz - 1, k));
+        size_t n = index(i, j, k);
+        switch (type) {
+            case VoxelType::UInt8: return data[n];
+            case VoxelType::UInt16: { uint16_t v; memcpy(&v, &data[2 * n], 2); return v; }
+            default: { float v; memcpy(&v, &data[4 * n], 4); return v; }
+        }
+    }
+
+    void set_voxel(int i, int j, int k, float value) {
+        size_t n = index(i, j, k);
+        switch (type) {
+            case VoxelType::UInt8: data[n] = (unsigned char)max(0.0f, min(255.0f, value)); break;
+            case VoxelType::UInt16: { uint16_t v = (uint16_t)max(0.0f, min(65535.0f, value)); memcpy(&data[2 * n], &v, 2); break; }
+            default: memcpy(&data[4 * n], &value, 4); break;
+        }
+    }
+};
+
+// Archivo crudo sin cabecera, en el orden de Volume::data
+inline bool load_raw_volume(const string& filename, int nx, int ny, int nz, VoxelType type, Volume& volume) {
+    ifstream file(filename, ios::binary);
+    if (!file.is_open() || nx < 2 || ny < 2 || nz < 2) return false;
+    volume = Volume(nx, ny, nz, type);
+    file.read((char*)volume.data.data(), volume.data.size());
+    return file.gcount() == (streamsize)volume.data.size();
+}
+
+// Pesos de Catmull-Rom para las muestras -1, 0, 1, 2
+inline void catmull_rom_weights(double t, double w[4]) {
+    double t2 = t * t, t3 = t2 * t;
+    w[0] = 0.5 * (-t3 + 2 * t2 - t);
+    w[1] = 0.5 * (3 * t3 - 5 * t2 + 2);
+    w[2] = 0.5 * (-3 * t3 + 4 * t2 + t);
+    w[3] = 0.5 * (t3 - t2);
+}
+
+// Interpolación trilineal en coordenadas de grilla (g = (p - origen) / paso)
+inline double trilinear_sample(const Volume& volume, const double g[3]) {
+    int n[3] = {volume.nx, volume.ny, volume.nz};
+    int base[3];
+    double t[3];
+    for (int a = 0; a < 3; a++) {
+        base[a] = max(0, min(n[a] - 2, (int)floor(g[a])));
+        t[a] = max(0.0, min(1.0, g[a] - base[a]));
+    }
+    double result = 0;
+    for (int c = 0; c < 8; c++) {
+        int dx = c & 1, dy = (c >> 1) & 1, dz = (c >> 2) & 1;
+        double w = (dx ? t[0] : 1 - t[0]) * (dy ? t[1] : 1 - t[1]) * (dz ? t[2] : 1 - t[2]);
+        result += w * volume.voxel(base[0] + dx, base[1] + dy, base[2] + dz);
+    }
+    return result;
+}
+
+// Rango exacto de la interpolación trilineal sobre la caja [lo, hi] (en
+// coordenadas de grilla). En cada celda la función es multilineal y sus
+// extremos están en las esquinas del trozo de caja dentro de la celda, así que
+// basta evaluar los bordes de la caja y los planos de la grilla interiores.
+inline void trilinear_range(const Volume& volume, const double lo[3], const double hi[3], float& out_min, float& out_max) {
+    vector<double> coords[3];
+    for (int a = 0; a < 3; a++) {
+        coords[a].push_back(lo[a]);
+        for (int g = (int)floor(lo[a]) + 1; g < hi[a]; g++) coords[a].push_back(g);
+        coords[a].push_back(hi[a]);
+    }
+    double low = 1e300, high = -1e300;
+    for (double z : coords[2]) {
+        for (double y : coords[1]) {
+            for (double x : coords[0]) {
+                double g[3] = {x, y, z};
+                double v = trilinear_sample(volume, g);
+                low = min(low, v);
+                high = max(high, v);
+            }
+        }
+    }
+    out_min = (float)low;
+    out_max = (float)high;
+    // Redondeo a float hacia afuera para que la cota siga siendo conservadora
+    if (out_min > low) out_min = nextafterf(out_min, -INFINITY);
+    if (out_max < high) out_max = nextafterf(out_max, INFINITY);
+}
+
+// Rango de los vóxeles de la caja ensanchada en margin muestras por lado
+inline void lattice_range(const Volume& volume, const double lo[3], const double hi[3], int margin, float& out_min, float& out_max) {
+    int n[3] = {volume.nx, volume.ny, volume.nz};
+    int first[3], last[3];
+    for (int a = 0; a < 3; a++) {
+        first[a] = max(0, (int)floor(lo[a]) - margin);
+        last[a] = min(n[a] - 1, (int)ceil(hi[a]) + margin);
+    }
+    out_min = 1e30f;
+    out_max = -1e30f;
+    for (int k = first[2]; k <= last[2]; k++) {
+        for (int j = first[1]; j <= last[1]; j++) {
+            for (int i = first[0]; i <= last[0]; i++) {
+                float v = volume.voxel(i, j, k);
+                out_min = min(out_min, v);
+                out_max = max(out_max, v);
+            }
+        }
+    }
+}
+
+// Pirámide de mínimos/máximos alineada con la subdivisión del octree sobre el
+// dominio del volumen: el nodo de profundidad d e índice (i, j, k) que visita
+// surface_to_triangles es la entrada (i, j, k) del nivel d, así que la pregunta
+// "¿puede este nodo contener el isovalor?" es una sola lectura y vale para
+// cualquier isovalor sin reconstruir.
+//
+// Con reconstrucción trilineal cada entrada es el rango exacto del campo sobre
+// el nodo (la unión de rangos de los hijos es el rango del padre). Con
+// Catmull-Rom es el rango de los vóxeles de su soporte, que luego se ensancha.
+//
+// Se arma en una sola pasada en profundidad: cada hoja de la pirámide lee sus
+// vóxeles y los niveles de arriba se reducen al volver de la recursión, con
+// tareas en los primeros niveles.
+class MinMaxPyramid {
+public:
+    int depth = -1;                    // nivel más fino guardado
+    typedef tracked_vector<float, MemoryCategory::Caches> Level;
+    vector<Level> mins, maxs;          // nivel d: (2^d)^3 entradas
+
+    static size_t entry(int d, int i, int j, int k) {
+        size_t n = size_t(1) << d;
+        return ((size_t)k * n + j) * n + i;
+    }
+
+    // Nivel más fino: nodos de a lo sumo 2 celdas por eje, sin pasar de max_depth
+    // (8^8 entradas) para que la memoria no crezca con volúmenes enormes.
+    void build(const Volume& volume, Reconstruction reconstruction, int max_depth = 8) {
+        int cells = max(volume.nx, max(volume.ny, volume.nz)) - 1;
+        depth = 0;
+        while (depth < max_depth && (cells >> depth) > 2) depth++;
+        mins.assign(depth + 1, Level());
+        maxs.assign(depth + 1, Level());
+        for (int d = 0; d <= depth; d++) {
+            mins[d].resize(size_t(1) << (3 * d));
+            maxs[d].resize(size_t(1) << (3 * d));
+        }
+
+        #pragma omp parallel
+        {
+            #pragma omp single nowait
+            build_node(volume, reconstruction, 0, 0, 0, 0);
+        }
+    }
+
+    void lookup(int d, int i, int j, int k, float& lo, float& hi) const {
+        size_t n = entry(d, i, j, k);
+        lo = mins[d][n];
+        hi = maxs[d][n];
+    }
+
+    // Caja del nodo en coordenadas de grilla
+    static void node_box(const Volume& volume, int d, const int index[3], double lo[3], double hi[3]) {
+        int cells[3] = {volume.nx - 1, volume.ny - 1, volume.nz - 1};
+        for (int a = 0; a < 3; a++) {
+            double size = ldexp((double)cells[a], -d);
+            lo[a] = index[a] * size;
+            hi[a] = (index[a] + 1) * size;
+        }
+    }
+
+private:
+    void build_node(const Volume& volume, Reconstruction reconstruction, int d, int i, int j, int k) {
+        float lo = 1e30f, hi = -1e30f;
+        if (d == depth) {
+            int index[3] = {i, j, k};
+            double box_lo[3], box_hi[3];
+            node_box(volume, d, index, box_lo, box_hi);
+            if (reconstruction == Reconstruction::Trilinear) trilinear_range(volume, box_lo, box_hi, lo, hi);
+            else lattice_range(volume, box_lo, box_hi, 1, lo, hi);
+        } else {
+            for (int c = 0; c < 8; c++) {
+                int ci = 2 * i + (c & 1), cj = 2 * j + ((c >> 1) & 1), ck = 2 * k + ((c >> 2) & 1);
+                #pragma omp task if(d < 3) firstprivate(ci, cj, ck) shared(volume)
+                build_node(volume, reconstruction, d + 1, ci, cj, ck);
+            }
+            #pragma omp taskwait
+            for (int c = 0; c < 8; c++) {
+                size_t n = entry(d + 1, 2 * i + (c & 1), 2 * j + ((c >> 1) & 1), 2 * k + ((c >> 2) & 1));
+                lo = min(lo, mins[d + 1][n]);
+                hi = max(hi, maxs[d + 1][n]);
+            }
+        }
+        mins[d][entry(d, i, j, k)] = lo;
+        maxs[d][entry(d, i, j, k)] = hi;
+    }
+};
+
+// Lectura trilineal del volumen sin umbral ni descarte, para usarlo como
+// campo auxiliar (temperatura, material...) en los vértices de otra superficie.
+inline ScalarField volume_sampler(const Volume& volume) {
+    return ScalarField(
+        [](const void* data, double x, double y, double z) {
+            const Volume& v = *(const Volume*)data;
+            double g[3] = {(x - v.origin.x) / v.spacing.x, (y - v.origin.y) / v.spacing.y, (z - v.origin.z) / v.spacing.z};
+            return (double)trilinear_sample(v, g);
+        },
+        &volume);
+}
+
+// El campo es voxel - threshold, así la superficie sigue siendo f = 0.
+class VolumeField {
+public:
+    const Volume& volume;
+    Reconstruction reconstruction;
+    double threshold;
+    MinMaxPyramid pyramid;
+
+    VolumeField(const Volume& volume, Reconstruction reconstruction = Reconstruction::Trilinear, double threshold = 0)
+        : volume(volume), reconstruction(reconstruction), threshold(threshold) {
+        pyramid.build(volume, reconstruction);
+    }
+
+    double value(double x, double y, double z) const {
+        double g[3] = {(x - volume.origin.x) / volume.spacing.x, (y - volume.origin.y) / volume.spacing.y,
+                       (z - volume.origin.z) / volume.spacing.z};
+        if (reconstruction == Reconstruction::Trilinear) return trilinear_sample(volume, g) - threshold;
+
+        int n[3] = {volume.nx, volume.ny, volume.nz};
+        int base[3];
+        double t[3];
+        for (int a = 0; a < 3; a++) {
+            base[a] = max(0, min(n[a] - 2, (int)floor(g[a])));
+            t[a] = max(0.0, min(1.0, g[a] - base[a]));
+        }
+        double wx[4], wy[4], wz[4];
+        catmull_rom_weights(t[0], wx);
+        catmull_rom_weights(t[1], wy);
+        catmull_rom_weights(t[2], wz);
+        double result = 0;
+        for (int dz = 0; dz < 4; dz++) {
+            for (int dy = 0; dy < 4; dy++) {
+                double row = 0;
+                for (int dx = 0; dx < 4; dx++) row += wx[dx] * volume.voxel(base[0] + dx - 1, base[1] + dy - 1, base[2] + dz - 1);
+                result += wz[dz] * wy[dy] * row;
+            }
+        }
+        return result - threshold;
+    }
+
+    // Profundidad e índice del nodo del octree sobre el dominio del volumen;
+    // false si la caja no es un nodo de esa subdivisión.
+    bool node_index(Point3D start, Point3D end, int& d, int index[3]) const {
+        double s[3] = {start.x, start.y, start.z}, e[3] = {end.x, end.y, end.z};
+        double o[3] = {volume.origin.x, volume.origin.y, volume.origin.z};
+        Point3D far = volume.end();
+        double size[3] = {far.x - o[0], far.y - o[1], far.z - o[2]};
+        d = (int)lround(log2(size[0] / (e[0] - s[0])));
+        if (d < 0 || d > 21) return false;
+        for (int a = 0; a < 3; a++) {
+            double node = ldexp(size[a], -d);
+            if (abs(e[a] - s[a] - node) > 1e-9 * size[a]) return false;
+            index[a] = (int)lround((s[a] - o[a]) / node);
+            if (index[a] < 0 || index[a] >= (1 << d) || abs(o[a] + index[a] * node - s[a]) > 1e-9 * size[a]) return false;
+        }
+        return true;
+    }
+
+    // Misma respuesta que cube_contains_surface (hay f >= isovalor y f < isovalor).
+    // Con trilineal es exacta; con Catmull-Rom, conservadora.
+    bool contains_surface(Point3D start, Point3D end, double isovalue = 0) const {
+        float range_min, range_max;
+        int d, index[3];
+        bool aligned = node_index(start, end, d, index);
+        if (aligned && d <= pyramid.depth) {
+            pyramid.lookup(d, index[0], index[1], index[2], range_min, range_max);
+        } else if (aligned && reconstruction == Reconstruction::Tricubic) {
+            int shift = d - pyramid.depth;
+            pyramid.lookup(pyramid.depth, index[0] >> shift, index[1] >> shift, index[2] >> shift, range_min, range_max);
+        } else {
+            // Nodo más chico que la pirámide (o fuera de la subdivisión): a lo sumo unas decenas de evaluaciones
+            double lo[3] = {(start.x - volume.origin.x) / volume.spacing.x, (start.y - volume.origin.y) / volume.spacing.y,
+                            (start.z - volume.origin.z) / volume.spacing.z};
+            double hi[3] = {(end.x - volume.origin.x) / volume.spacing.x, (end.y - volume.origin.y) / volume.spacing.y,
+                            (end.z - volume.origin.z) / volume.spacing.z};
+            if (reconstruction == Reconstruction::Trilinear) trilinear_range(volume, lo, hi, range_min, range_max);
+            else lattice_range(volume, lo, hi, 1, range_min, range_max);
+        }
+        double low = range_min, high = range_max;
+        if (reconstruction == Reconstruction::Tricubic) {
+            // Los lóbulos negativos de Catmull-Rom suman a lo sumo 1/8 por eje:
+            // el valor reconstruido puede salirse del rango hasta ((1.25^3 - 1) / 2) * (max - min).
+            double overshoot = 0.4765625 * (high - low);
+            low -= overshoot;
+            high += overshoot;
+        }
+        return low - threshold < isovalue && high - threshold >= isovalue;
+    }
+
+    ScalarField field() const {
+        return ScalarField(
+            [](const void* data, double x, double y, double z) { return ((const VolumeField*)data)->value(x, y, z); },
+            this,
+            [](const void* data, Point3D start, Point3D end, double isovalue) {
+                return ((const VolumeField*)data)->contains_surface(start, end, isovalue);
+            });
+    }
+};
+
+#endif // VOLUME_FIELD_H